@@ -21,6 +21,8 @@
  *      Author: ubaid
  */
 
+#include <sstream>
+
 #include "ns3/object.h"
 #include "ns3/node-container.h"
 #include "ns3/ptr.h"
@@ -50,6 +52,7 @@ AccessNetwork::GetTypeId()
 }
 
 AccessNetwork::AccessNetwork()
+	: m_systemId(0)
 {
 }
 
@@ -58,11 +61,12 @@ AccessNetwork::AccessNetwork(NodeContainer &nodes,
 								InternetStackHelper &stack,
 								std::string networkAdd,
 								std::string subnet)
+	: m_systemId(0)
 {
 	NS_LOG_FUNCTION(this);
 	m_nodes = nodes;
-	m_networkAddress = networkAdd;
-	m_subnetMask = subnet;
+	m_networkAddress = Ipv4Address(networkAdd.c_str());
+	m_subnetMask = Ipv4Mask(subnet.c_str());
 	m_p2p = p2p;
 	m_istack = stack;
 	ConnectNodesToSwitch();
@@ -91,8 +95,15 @@ void
 AccessNetwork::SetNetwork(std::string networkAdd, std::string subnet)
 {
 	NS_LOG_FUNCTION(this);
-	m_networkAddress = networkAdd;
-	m_subnetMask = subnet;
+	m_networkAddress = Ipv4Address(networkAdd.c_str());
+	m_subnetMask = Ipv4Mask(subnet.c_str());
+}
+void
+AccessNetwork::SetNetwork(Ipv4Address network, Ipv4Mask mask)
+{
+	NS_LOG_FUNCTION(this << network << mask);
+	m_networkAddress = network;
+	m_subnetMask = mask;
 }
 
 void
@@ -112,13 +123,17 @@ std::string
 AccessNetwork::GetNetworkAddress() const
 {
 	NS_LOG_FUNCTION(this);
-	return m_networkAddress;
+	std::ostringstream oss;
+	oss << m_networkAddress;
+	return oss.str();
 }
 std::string
 AccessNetwork::GetSubnet() const
 {
 	NS_LOG_FUNCTION(this);
-	return m_subnetMask;
+	std::ostringstream oss;
+	oss << m_subnetMask;
+	return oss.str();
 }
 
 Ipv4InterfaceContainer
@@ -134,6 +149,13 @@ AccessNetwork::GetAllInterfaces() const
 	return m_connectedDevices;
 }
 
+void
+AccessNetwork::SetSystemId(uint32_t systemId)
+{
+	NS_LOG_FUNCTION(this << systemId);
+	m_systemId = systemId;
+}
+
 AccessNetwork::~AccessNetwork()
 {
 }
@@ -143,7 +165,7 @@ AccessNetwork::ConnectNodesToSwitch()
 {
 	NS_LOG_FUNCTION(this);
 	NodeContainer sw;
-	sw.Create(1);
+	sw.Create(1, m_systemId);
 	m_accessSwitch = sw.Get(0);
 	m_istack.Install(m_accessSwitch);
 	ConnectionHelper ch;
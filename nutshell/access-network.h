@@ -30,6 +30,7 @@
 #include "ns3/node.h"
 #include "ns3/point-to-point-helper.h"
 #include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address.h"
 #include "ns3/ipv4-interface-container.h"
 
 #include "connection-helper.h"
@@ -93,6 +94,17 @@ public:
 	 * \param subnet, the network mask of subnet
 	 */
 	void SetNetwork(std::string networkAdd, std::string subnet);
+	/**
+	 * \brief Setter for network, which is used to assign IPs to NetDevices
+	 * \param network, the subnet network address
+	 * \param mask, the network mask of subnet
+	 */
+	void SetNetwork(Ipv4Address network, Ipv4Mask mask);
+	/**
+	 * \brief Set the system id of the access switch, for distributed simulations
+	 * \param systemId The system id or rank owning the switch
+	 */
+	void SetSystemId(uint32_t systemId);
 	/**
 	 * \brief Getter for the access network switch/router
 	 * \return node pointer
@@ -131,8 +143,9 @@ private:
 	InternetStackHelper m_istack; //!< Internet stack for nodes
 	Ipv4InterfaceContainer m_connectedDevices; //!< List of all connected devices interfaces
 	Ipv4InterfaceContainer m_terminalDevices; //!< List of end node interfaces except the access router/switch
-	std::string m_networkAddress; //!< Network subnet's network address
-	std::string m_subnetMask; //!< Network subnet mask
+	Ipv4Address m_networkAddress; //!< Network subnet's network address
+	Ipv4Mask m_subnetMask; //!< Network subnet mask
+	uint32_t m_systemId; //!< System id of the access switch
 };
 
 } /* namespace ns3 */
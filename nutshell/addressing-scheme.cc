@@ -25,13 +25,21 @@
 #include <math.h>
 
 #include "ns3/log.h"
+#include "ns3/assert.h"
 
 #include "addressing-scheme.h"
 
 namespace ns3 {
 
 AddressingScheme::AddressingScheme()
+	: m_numNet(0),
+	  m_hosts(1),
+	  m_base(0),
+	  m_prefixLength(32),
+	  m_jumpShift(0)
 {
+	m_oct[0] = m_oct[1] = m_oct[2] = m_oct[3] = 0;
+	m_snetP[0] = m_snetP[1] = m_snetP[2] = m_snetP[3] = 0;
 }
 
 void
@@ -53,21 +61,59 @@ AddressingScheme::SetJumpValues(std::vector<uint16_t> &jumpValues)
 	m_jumpValues = jumpValues;
 }
 
+Ipv4Address
+AddressingScheme::GetNetworkAddress(uint32_t id) const
+{
+	NS_ASSERT_MSG(id < m_numNet, "Network " << id << " out of " << m_numNet);
+	uint32_t network = m_base + (id << (32 - m_prefixLength));
+	if(id < m_jumpSums.size())
+	{
+		network += m_jumpSums[id] << m_jumpShift;
+	}
+	else if(!m_jumpSums.empty())
+	{
+		network += (m_jumpSums.back() + m_jumpValues.back()) << m_jumpShift;
+	}
+	return Ipv4Address(network);
+}
+uint32_t
+AddressingScheme::GetPrefixLength(uint32_t id) const
+{
+	return m_prefixLength;
+}
+Ipv4Mask
+AddressingScheme::GetNetworkMask(uint32_t id) const
+{
+	uint32_t prefix = GetPrefixLength(id);
+	return Ipv4Mask(prefix == 0 ? 0 : 0xffffffff << (32 - prefix));
+}
+uint32_t
+AddressingScheme::GetNumberOfNetworks() const
+{
+	return m_numNet;
+}
+
 std::string
 AddressingScheme::GetNetwork(uint32_t id)
 {
-	return m_networks[id][0];
+	return ConvertToString(GetNetworkAddress(id).Get());
 }
 std::string
 AddressingScheme::GetSubnet(uint32_t id)
 {
-	return m_networks[id][1];
+	return ConvertToString(GetNetworkMask(id).Get());
 }
 
 std::vector< std::vector< std::string > >
 AddressingScheme::GetNetworkList() const
 {
-	return m_networks;
+	std::vector< std::vector< std::string > > networks(m_numNet);
+	for(uint32_t i = 0; i < m_numNet; i++)
+	{
+		networks[i].push_back(ConvertToString(GetNetworkAddress(i).Get()));
+		networks[i].push_back(ConvertToString(GetNetworkMask(i).Get()));
+	}
+	return networks;
 }
 
 AddressingScheme::~AddressingScheme()
@@ -119,96 +165,38 @@ AddressingScheme::ConvertToString(uint16_t fo, uint16_t so, uint16_t to, uint16_
 	return oss.str();
 }
 
-void
-AddressingScheme::ResizeNetworksVector(uint32_t numNet)
+std::string
+AddressingScheme::ConvertToString(uint32_t address) const
 {
-	m_networks.resize(numNet);
-	for(uint32_t i = 0; i < numNet; i++)
-	{
-		m_networks[i].resize(2);
-	}
+	std::ostringstream oss;
+	oss << ((address >> 24) & 0xff) << "." << ((address >> 16) & 0xff) << "."
+		<< ((address >> 8) & 0xff) << "." << (address & 0xff);
+	return oss.str();
+}
+
+uint32_t
+AddressingScheme::GetBaseAddress() const
+{
+	return ((uint32_t) m_oct[0] << 24) | ((uint32_t) m_oct[1] << 16) | ((uint32_t) m_oct[2] << 8) | m_oct[3];
 }
 
 void
 AddressingScheme::CreateNetworkAddresses()
 {
-//	NS_LOG_UNCOND("This is parent");
-	ResizeNetworksVector(m_numNet);
 	uint16_t bitsReq = ceil(log2(m_hosts));
 
-	uint16_t over = bitsReq % 8;
-
-	uint16_t covered = floor( bitsReq / 8);
-
-	uint16_t baseVal = pow(2, over) - 1;
-	uint16_t snetPart = 255 - baseVal;
-	uint16_t ipCounter[4];
-	uint16_t jumpCounter = 0;
+	// the networks follow each other by the size of a subnet, the jumps
+	// are added to the octet where the host part begins
+	m_base = GetBaseAddress();
+	m_prefixLength = 32 - bitsReq;
+	m_jumpShift = 8 * (bitsReq / 8);
 
-	for(int i = 0; i < 4; i++)
+	// the jump after network i moves every network after it,
+	// so network i is moved by the sum of the jumps before it
+	m_jumpSums.assign(m_jumpValues.size(), 0);
+	for(uint32_t i = 1; i < m_jumpValues.size(); i++)
 	{
-		ipCounter[i] = m_oct[i];
-	}
-
-	uint16_t workingOct = 3 - covered;
-
-	for(uint32_t i = 0; i < m_numNet; i++)
-	{
-		if(covered == 0)
-		{
-			m_networks[i][0] = ConvertToString(ipCounter[0], ipCounter[1], ipCounter[2], ipCounter[3]);
-			m_networks[i][1] = ConvertToString(255, 255, 255, snetPart);
-		}
-		else if(covered == 1)
-		{
-			m_networks[i][0] = ConvertToString(ipCounter[0], ipCounter[1], ipCounter[2], ipCounter[3]);
-			m_networks[i][1] = ConvertToString(255, 255, snetPart, 0);
-		}
-		else if(covered == 2)
-		{
-			m_networks[i][0] = ConvertToString(ipCounter[0], ipCounter[1], ipCounter[2], ipCounter[3]);
-			m_networks[i][1] = ConvertToString(255, snetPart, 0, 0);
-		}
-		else if(covered == 3)
-		{
-			m_networks[i][0] = ConvertToString(ipCounter[0], ipCounter[1], ipCounter[2], ipCounter[3]);
-			m_networks[i][1] = ConvertToString(snetPart, 0, 0, 0);
-		}
-
-//		NS_LOG_UNCOND("Network: " << m_networks[i][0] <<"\nSubnet:" << m_networks[i][1] << "\n");
-
-		ipCounter[workingOct] += (baseVal+1);
-//		NS_LOG_UNCOND("ip counter at working oct: " << ipCounter[workingOct]);
-		if(m_jumpValues.size() > 0)
-		{
-			if(jumpCounter < m_jumpValues.size())
-			{
-				ipCounter[workingOct] += m_jumpValues[jumpCounter];
-				jumpCounter++;
-			}
-		}
-		ProcessAddress(ipCounter, workingOct);
-	}
-}
-
-void
-AddressingScheme::ProcessAddress(uint16_t *array, uint16_t workingOct)
-{
-	for(int i = (int) workingOct; i > 0; i--)
-	{
-//		NS_LOG_UNCOND("i : " << i <<" workingOct: " << workingOct);
-		uint16_t temp = array[i] % 256;
-		//NS_LOG_UNCOND("temp: " << temp);
-		if(array[i] > 255 && temp == 0)
-		{
-			array[i] = 0;
-			array[i-1]++;
-		}
-		else if (array[i] > 255 && temp > 0)
-		{
-			array[i] = temp;
-			array[i-1]++;
-		}
+		m_jumpSums[i] = m_jumpSums[i - 1] + m_jumpValues[i - 1];
 	}
 }
 
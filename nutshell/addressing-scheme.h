@@ -27,12 +27,17 @@
 #include <vector>
 #include <sstream>
 
+#include "ns3/ipv4-address.h"
+
 namespace ns3 {
 /**
  * \brief The class is used to create an addressing scheme for Data center architecture
  *
  * The class convert a class full address to number of class less subnets, the subnet
  * formed are according to the number of networks requested by the user.
+ *
+ * The networks are not stored, the i-th network is computed from the base
+ * address, the network size and the jumps when it is requested.
  */
 class AddressingScheme {
 public:
@@ -62,6 +67,29 @@ public:
 	 *
 	 */
 	virtual void CreateNetworkAddresses();
+	/**
+	 * \brief Get a network address by index
+	 * \param id the index
+	 * \return network address
+	 */
+	virtual Ipv4Address GetNetworkAddress(uint32_t id) const;
+	/**
+	 * \brief Get the prefix length of a network
+	 * \param id the index
+	 * \return the number of network bits of the mask
+	 */
+	uint32_t GetPrefixLength(uint32_t id) const;
+	/**
+	 * \brief Get the network subnet mask
+	 * \param id the index
+	 * \return subnet mask
+	 */
+	Ipv4Mask GetNetworkMask(uint32_t id) const;
+	/**
+	 * \brief Get the number of networks created
+	 * \return the number of networks
+	 */
+	uint32_t GetNumberOfNetworks() const;
 	/**
 	 * \brief Get a network address by index
 	 * \param id the index
@@ -88,11 +116,6 @@ protected:
 	 * \param subnet the subnet mask of the subnet
 	 */
 	void ConvertAndSplit(std::string networkAddress, std::string subnet);
-	/**
-	 * \brief Resizes the network vector to the number of networks required
-	 * \param numNet the number of networks
-	 */
-	void ResizeNetworksVector(uint32_t numNet);
 	/**
 	 * \brief Converts a string to integer value
 	 * \param s the string to convert
@@ -109,15 +132,16 @@ protected:
 	 */
 	std::string ConvertToString(uint16_t fo, uint16_t so, uint16_t to, uint16_t foo);
 	/**
-	 * \brief Processes the IP address octet array
-	 *
-	 * The function checks for current working octet, if reaches 256, then making current
-	 * octet to 0 and increments the previous octet by 1
-	 *
-	 * \param array the array of IP octets
-	 * \param workingOct the working octet
+	 * \brief Converts an address to dot notation
+	 * \param address the address as an integer
+	 * \return the address string
 	 */
-	void ProcessAddress(uint16_t *array, uint16_t workingOct);
+	std::string ConvertToString(uint32_t address) const;
+	/**
+	 * \brief Gets the base address from the octets
+	 * \return the base address as an integer
+	 */
+	uint32_t GetBaseAddress() const;
 
 	uint16_t m_oct[4]; //!< holds the IP octets as a list
 	uint16_t m_snetP[4]; //!< holds the subnet mask octets
@@ -126,9 +150,13 @@ protected:
 	uint32_t m_hosts; //!< number of hosts required in a single subnet
 
 
-	std::vector< std::vector< std::string > > m_networks; //!< list of network addresses
 	std::vector<uint16_t> m_jumpValues; //!< list of jumps after a network
 
+	uint32_t m_base; //!< the address of first network
+	uint32_t m_prefixLength; //!< the network bits of each subnet mask
+	uint32_t m_jumpShift; //!< the bit position the jumps are added at
+	std::vector<uint32_t> m_jumpSums; //!< sum of the jumps before each jumped network
+
 //private:
 //	virtual void CreateNetworkAddresses();
 
@@ -0,0 +1,408 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *
+ * batch-runner.cc
+ *
+ *  Created on: Apr 10, 2017
+ *      Author: ubaid
+ *       Email: u.ur.rahman@gmail.com
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <map>
+
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/time.h>
+
+#include "ns3/log.h"
+#include "ns3/fatal-error.h"
+
+#include "batch-runner.h"
+#include "columnar-writer.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("BatchRunner");
+
+BatchRunner::BatchRunner()
+	: m_scenario(0),
+	  m_outputDir("nutshell-batch"),
+	  m_jobs(0),
+	  m_stopTime(Seconds(10))
+{
+	m_topologies.push_back("fattree");
+	m_pods.push_back(4);
+	m_vms.push_back(100);
+	m_splits.push_back("3:2:1");
+	m_schedulers.push_back("sjf");
+	m_seeds.push_back(1);
+}
+
+BatchRunner::~BatchRunner()
+{
+}
+
+void
+BatchRunner::SetScenario(Scenario scenario)
+{
+	m_scenario = scenario;
+}
+
+void
+BatchRunner::SetOutputDirectory(std::string dir)
+{
+	m_outputDir = dir;
+}
+
+void
+BatchRunner::SetJobs(uint32_t jobs)
+{
+	m_jobs = jobs;
+}
+
+void
+BatchRunner::SetStopTime(Time stop)
+{
+	m_stopTime = stop;
+}
+
+void
+BatchRunner::SetSpec(std::string key, std::string list)
+{
+	if(list.empty())
+	{
+		return;
+	}
+	if(key == "topologies")
+	{
+		m_topologies = Split(list);
+	}
+	else if(key == "pods")
+	{
+		m_pods = SplitNumbers(list);
+	}
+	else if(key == "vms")
+	{
+		m_vms = SplitNumbers(list);
+	}
+	else if(key == "splits")
+	{
+		m_splits = Split(list);
+	}
+	else if(key == "schedulers")
+	{
+		m_schedulers = Split(list);
+	}
+	else if(key == "seeds")
+	{
+		m_seeds = SplitNumbers(list);
+	}
+	else
+	{
+		NS_FATAL_ERROR("Unknown batch parameter " << key);
+	}
+}
+
+uint32_t
+BatchRunner::Run()
+{
+	NS_ASSERT_MSG(m_scenario != 0, "The batch has no scenario");
+	std::vector<BatchRun_s> runs = MakeRuns();
+	uint32_t jobs = m_jobs;
+	if(jobs == 0)
+	{
+		long cores = sysconf(_SC_NPROCESSORS_ONLN);
+		jobs = cores > 0 ? cores : 1;
+	}
+	if(mkdir(m_outputDir.c_str(), 0755) != 0 && errno != EEXIST)
+	{
+		NS_FATAL_ERROR("Unable to create " << m_outputDir << ": " << strerror(errno));
+	}
+	NS_LOG_UNCOND("Batch of " << runs.size() << " runs, " << jobs << " at a time");
+
+	std::vector<int> status(runs.size(), -1);
+	std::vector<double> seconds(runs.size(), 0);
+	std::map<pid_t, uint32_t> active;
+	uint32_t next = 0;
+	while(next < runs.size() || !active.empty())
+	{
+		if(next < runs.size() && active.size() < jobs)
+		{
+			std::string dir = RunDirectory(runs[next]);
+			PrepareDirectory(dir);
+			// buffered output would be written by both processes
+			std::cout.flush();
+			std::cerr.flush();
+			pid_t pid = fork();
+			if(pid < 0)
+			{
+				NS_FATAL_ERROR("Unable to fork run " << next << ": " << strerror(errno));
+			}
+			if(pid == 0)
+			{
+				int code = m_scenario(runs[next], dir + "/");
+				std::cout.flush();
+				_exit(code);
+			}
+			active[pid] = next;
+			seconds[next] = WallClock();
+			next++;
+			continue;
+		}
+
+		int st = 0;
+		pid_t pid = waitpid(-1, &st, 0);
+		if(pid < 0)
+		{
+			if(errno == EINTR)
+			{
+				continue;
+			}
+			NS_FATAL_ERROR("Waiting for runs failed: " << strerror(errno));
+		}
+		std::map<pid_t, uint32_t>::iterator it = active.find(pid);
+		if(it == active.end())
+		{
+			continue;
+		}
+		uint32_t r = it->second;
+		active.erase(it);
+		status[r] = WIFEXITED(st) ? WEXITSTATUS(st) : 128 + WTERMSIG(st);
+		seconds[r] = WallClock() - seconds[r];
+		NS_LOG_UNCOND("Run " << r << " finished with status " << status[r] << " in " << seconds[r] << "s");
+	}
+
+	Merge(runs, status, seconds);
+
+	uint32_t failed = 0;
+	for(uint32_t i = 0; i < status.size(); i++)
+	{
+		failed += status[i] != 0 ? 1 : 0;
+	}
+	return failed;
+}
+
+/*
+ * ------------- private methods -------------
+ */
+
+std::vector<BatchRun_s>
+BatchRunner::MakeRuns() const
+{
+	std::vector<BatchRun_s> runs;
+	for(uint32_t t = 0; t < m_topologies.size(); t++)
+	for(uint32_t p = 0; p < m_pods.size(); p++)
+	for(uint32_t v = 0; v < m_vms.size(); v++)
+	for(uint32_t s = 0; s < m_splits.size(); s++)
+	for(uint32_t c = 0; c < m_schedulers.size(); c++)
+	for(uint32_t r = 0; r < m_seeds.size(); r++)
+	{
+		BatchRun_s run;
+		run.id = runs.size();
+		run.topology = m_topologies[t];
+		run.pods = m_pods[p];
+		run.vms = m_vms[v];
+		run.splits = m_splits[s];
+		run.scheduler = m_schedulers[c];
+		run.seed = m_seeds[r];
+		run.stopTime = m_stopTime;
+		runs.push_back(run);
+	}
+	return runs;
+}
+
+std::string
+BatchRunner::RunDirectory(const BatchRun_s & run) const
+{
+	std::stringstream ss;
+	ss << m_outputDir << "/run_" << run.id;
+	return ss.str();
+}
+
+void
+BatchRunner::PrepareDirectory(std::string dir)
+{
+	if(mkdir(dir.c_str(), 0755) == 0)
+	{
+		return;
+	}
+	if(errno != EEXIST)
+	{
+		NS_FATAL_ERROR("Unable to create " << dir << ": " << strerror(errno));
+	}
+	// the exports are named by time, a reused directory holds the files of
+	// an earlier batch which would be merged with this run
+	DIR * d = opendir(dir.c_str());
+	if(d == 0)
+	{
+		NS_FATAL_ERROR("Unable to open " << dir << ": " << strerror(errno));
+	}
+	struct dirent * entry;
+	while((entry = readdir(d)) != 0)
+	{
+		std::string name = entry->d_name;
+		if(name == "." || name == "..")
+		{
+			continue;
+		}
+		std::string path = dir + "/" + name;
+		if(unlink(path.c_str()) != 0)
+		{
+			NS_FATAL_ERROR("Unable to remove " << path << ": " << strerror(errno));
+		}
+	}
+	closedir(d);
+}
+
+void
+BatchRunner::Merge(const std::vector<BatchRun_s> & runs, std::vector<int> & status,
+		const std::vector<double> & seconds) const
+{
+	std::string runsFile = m_outputDir + "/runs.csv";
+	std::fstream index(runsFile.c_str(), std::fstream::out);
+	index << "run,topology,pods,vms,splits,scheduler,seed,stop,status,seconds\n";
+
+	std::map<std::string, std::fstream *> merged;
+	for(uint32_t i = 0; i < runs.size(); i++)
+	{
+		const BatchRun_s & run = runs[i];
+		std::stringstream meta;
+		meta << run.id << "," << run.topology << "," << run.pods << "," << run.vms << ","
+				<< run.splits << "," << run.scheduler << "," << run.seed;
+
+		std::string dir = RunDirectory(run);
+		std::vector<std::string> tables;
+		DIR * d = status[i] == 0 ? opendir(dir.c_str()) : 0;
+		if(d != 0)
+		{
+			struct dirent * entry;
+			while((entry = readdir(d)) != 0)
+			{
+				std::string name = entry->d_name;
+				std::string error;
+				if(name.size() > 5 && name.compare(name.size() - 5, 5, ".nscd") == 0
+						&& !ColumnarWriter::TryConvertToCsv(dir + "/" + name, dir + "/", tables, error))
+				{
+					// the other runs are still merged
+					NS_LOG_UNCOND("Run " << run.id << " not merged: " << error);
+					status[i] = MERGE_FAILED;
+					break;
+				}
+			}
+			closedir(d);
+		}
+		index << meta.str() << "," << run.stopTime.GetSeconds() << "," << status[i]
+				<< "," << seconds[i] << "\n";
+		if(status[i] != 0)
+		{
+			continue;
+		}
+
+		for(uint32_t t = 0; t < tables.size(); t++)
+		{
+			std::string fileName = dir + "/" + tables[t] + ".csv";
+			std::ifstream in(fileName.c_str());
+			std::string line;
+			if(!std::getline(in, line))
+			{
+				continue;
+			}
+			std::fstream *& out = merged[tables[t]];
+			if(out == 0)
+			{
+				std::string mergedName = m_outputDir + "/" + tables[t] + ".csv";
+				out = new std::fstream(mergedName.c_str(), std::fstream::out);
+				*out << "run,topology,pods,vms,splits,scheduler,seed," << line << "\n";
+			}
+			while(std::getline(in, line))
+			{
+				*out << meta.str() << "," << line << "\n";
+			}
+		}
+	}
+	index.close();
+
+	for(std::map<std::string, std::fstream *>::iterator it = merged.begin(); it != merged.end(); it++)
+	{
+		it->second->close();
+		delete it->second;
+	}
+}
+
+std::vector<std::string>
+BatchRunner::Split(std::string list)
+{
+	std::vector<std::string> values;
+	std::stringstream ss(list);
+	std::string v;
+	while(std::getline(ss, v, ','))
+	{
+		if(!v.empty())
+		{
+			values.push_back(v);
+		}
+	}
+	return values;
+}
+
+std::vector<uint32_t>
+BatchRunner::SplitNumbers(std::string list)
+{
+	std::vector<uint32_t> values;
+	std::vector<std::string> items = Split(list);
+	for(uint32_t i = 0; i < items.size(); i++)
+	{
+		uint32_t first = 0;
+		uint32_t last = 0;
+		char dash = 0;
+		std::stringstream ss(items[i]);
+		ss >> first;
+		if(ss.fail())
+		{
+			NS_FATAL_ERROR("Invalid number " << items[i] << " in " << list);
+		}
+		last = first;
+		if(ss >> dash && (dash != '-' || !(ss >> last) || last < first))
+		{
+			NS_FATAL_ERROR("Invalid range " << items[i] << " in " << list);
+		}
+		for(uint32_t v = first; v <= last; v++)
+		{
+			values.push_back(v);
+		}
+	}
+	return values;
+}
+
+double
+BatchRunner::WallClock()
+{
+	struct timeval tv;
+	gettimeofday(&tv, 0);
+	return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+} /* namespace ns3 */
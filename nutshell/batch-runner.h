@@ -0,0 +1,158 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *
+ * batch-runner.h
+ *
+ *  Created on: Apr 10, 2017
+ *      Author: ubaid
+ *       Email: u.ur.rahman@gmail.com
+ */
+
+#ifndef NUTSHELL_BATCH_RUNNER_H
+#define NUTSHELL_BATCH_RUNNER_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * \brief The parameters of a single run of a batch
+ */
+struct BatchRun_s {
+	uint32_t id; //!< The index of run in the batch
+	std::string topology; //!< fattree or threetier
+	uint32_t pods; //!< The number of pods
+	uint32_t vms; //!< The number of VMs
+	std::string splits; //!< The split ratio of VMs, e.g 3:2:1
+	std::string scheduler; //!< fcfs or sjf
+	uint32_t seed; //!< The run number of random streams
+	Time stopTime; //!< The simulation stop time
+};
+
+/**
+ * \brief Runs a sweep of scenarios in parallel processes and merges their data
+ *
+ * The runs are the cross product of the topologies, pods, VM counts, split
+ * ratios, schedulers and seeds of the spec. Each run is forked into its own
+ * process, so every ns-3 instance is independent, with as many processes at
+ * a time as jobs (all cores by default).
+ *
+ * A run gets the directory <output>/run_<id>/ as its file prefix and is expected
+ * to export its collectors in the binary format there. The directory is
+ * emptied before the run starts, so the files of an earlier batch are not
+ * merged again. Once all runs finished, the binary files are converted and
+ * each table is merged into <output>/<table>.csv, every row prefixed by the
+ * parameters of its run. A run with a corrupted binary file is left out of
+ * the merge and gets the status MERGE_FAILED. The parameters and exit status
+ * of all runs are written to <output>/runs.csv.
+ *
+ * The spec is set before any simulation object is created, the parent
+ * process only forks and merges.
+ */
+class BatchRunner {
+public:
+	/**
+	 * \brief A scenario, runs one simulation and returns its exit status
+	 */
+	typedef int (*Scenario)(const BatchRun_s & run, std::string prefix);
+
+	static const int MERGE_FAILED = -2; //!< The status of a run whose output could not be merged, no exit status is negative
+
+	BatchRunner();
+	virtual ~BatchRunner();
+
+	/**
+	 * \brief Set the scenario executed by each run
+	 */
+	void SetScenario(Scenario scenario);
+	/**
+	 * \brief Set the directory of run and merged outputs
+	 */
+	void SetOutputDirectory(std::string dir);
+	/**
+	 * \brief Set the number of parallel processes
+	 * \param jobs The number of processes, 0 for all cores
+	 */
+	void SetJobs(uint32_t jobs);
+	/**
+	 * \brief Set the simulation stop time of every run
+	 */
+	void SetStopTime(Time stop);
+	/**
+	 * \brief Set a parameter of the spec from a comma separated list
+	 *
+	 * The keys are topologies, pods, vms, splits, schedulers and seeds.
+	 * Numeric lists accept ranges, e.g seeds "1-20" or pods "4,8".
+	 *
+	 * \param key The parameter
+	 * \param list The values
+	 */
+	void SetSpec(std::string key, std::string list);
+
+	/**
+	 * \brief Runs the batch and merges the outputs
+	 * \return The number of failed runs
+	 */
+	uint32_t Run();
+
+private:
+	/**
+	 * \brief Creates the runs of the spec
+	 */
+	std::vector<BatchRun_s> MakeRuns() const;
+	/**
+	 * \brief Get the directory of a run
+	 */
+	std::string RunDirectory(const BatchRun_s & run) const;
+	/**
+	 * \brief Creates the directory of a run, removing the files left in it
+	 * \param dir The directory
+	 */
+	static void PrepareDirectory(std::string dir);
+	/**
+	 * \brief Merges the outputs of the runs
+	 * \param runs The runs
+	 * \param status The exit status of each run, set to MERGE_FAILED if its output is corrupted
+	 * \param seconds The wall clock time of each run
+	 */
+	void Merge(const std::vector<BatchRun_s> & runs, std::vector<int> & status,
+			const std::vector<double> & seconds) const;
+
+	static std::vector<std::string> Split(std::string list);
+	static std::vector<uint32_t> SplitNumbers(std::string list);
+	static double WallClock();
+
+	Scenario m_scenario; //!< The scenario of runs
+	std::string m_outputDir; //!< The output directory
+	uint32_t m_jobs; //!< Parallel processes, 0 for all cores
+	Time m_stopTime; //!< The stop time of runs
+
+	std::vector<std::string> m_topologies; //!< Topologies of spec
+	std::vector<uint32_t> m_pods; //!< Pods of spec
+	std::vector<uint32_t> m_vms; //!< VM counts of spec
+	std::vector<std::string> m_splits; //!< Split ratios of spec
+	std::vector<std::string> m_schedulers; //!< Schedulers of spec
+	std::vector<uint32_t> m_seeds; //!< Seeds of spec
+};
+
+} /* namespace ns3 */
+
+#endif /* NUTSHELL_BATCH_RUNNER_H */
@@ -0,0 +1,445 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *
+ * columnar-writer.cc
+ *
+ *  Created on: Apr 3, 2017
+ *      Author: ubaid
+ *       Email: u.ur.rahman@gmail.com
+ */
+
+#include <string.h>
+#include <fstream>
+#include <sstream>
+#include <map>
+
+#include "ns3/log.h"
+#include "ns3/fatal-error.h"
+
+#include "columnar-writer.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ColumnarWriter");
+
+static const char COLUMNAR_MAGIC[4] = {'N', 'S', 'C', 'D'};
+static const uint32_t COLUMNAR_VERSION = 1;
+static const uint8_t RECORD_SCHEMA = 'T';
+static const uint8_t RECORD_CHUNK = 'C';
+
+ColumnarWriter::ColumnarWriter()
+	: m_file(0),
+	  m_chunkRows(4096)
+{
+}
+
+ColumnarWriter::~ColumnarWriter()
+{
+	Close();
+}
+
+void
+ColumnarWriter::Open(std::string fileName)
+{
+	NS_LOG_FUNCTION(this << fileName);
+	Close();
+	m_file = std::fopen(fileName.c_str(), "wb");
+	if(m_file == 0)
+	{
+		NS_FATAL_ERROR("Unable to create export file " << fileName);
+	}
+	std::setvbuf(m_file, 0, _IOFBF, 1 << 20);
+	std::fwrite(COLUMNAR_MAGIC, 1, 4, m_file);
+	std::fwrite(&COLUMNAR_VERSION, sizeof(COLUMNAR_VERSION), 1, m_file);
+}
+
+void
+ColumnarWriter::Close()
+{
+	if(m_file == 0)
+	{
+		return;
+	}
+	for(uint32_t t = 0; t < m_tables.size(); t++)
+	{
+		Flush(t);
+	}
+	std::fclose(m_file);
+	m_file = 0;
+	m_tables.clear();
+}
+
+bool
+ColumnarWriter::IsOpen() const
+{
+	return m_file != 0;
+}
+
+void
+ColumnarWriter::SetChunkRows(uint32_t rows)
+{
+	m_chunkRows = rows > 0 ? rows : 1;
+}
+
+uint32_t
+ColumnarWriter::AddTable(std::string name)
+{
+	Table_s t;
+	t.name = name;
+	t.rows = 0;
+	t.schemaWritten = false;
+	m_tables.push_back(t);
+	return m_tables.size() - 1;
+}
+
+uint32_t
+ColumnarWriter::AddColumn(uint32_t table, std::string name, Type_e type)
+{
+	NS_ASSERT(table < m_tables.size());
+	Table_s & t = m_tables[table];
+	if(t.schemaWritten || t.rows > 0)
+	{
+		NS_FATAL_ERROR("Column " << name << " added to table " << t.name << " after its rows");
+	}
+	Column_s c;
+	c.name = name;
+	c.type = type;
+	t.columns.push_back(c);
+	return t.columns.size() - 1;
+}
+
+void
+ColumnarWriter::PutUint(uint32_t table, uint32_t column, uint64_t value)
+{
+	NS_ASSERT(table < m_tables.size() && column < m_tables[table].columns.size());
+	switch(m_tables[table].columns[column].type)
+	{
+	case TYPE_U8:
+	{
+		uint8_t v = value;
+		Put(table, column, &v);
+		break;
+	}
+	case TYPE_U32:
+	{
+		uint32_t v = value;
+		Put(table, column, &v);
+		break;
+	}
+	case TYPE_U64:
+		Put(table, column, &value);
+		break;
+	case TYPE_I64:
+		PutInt(table, column, value);
+		break;
+	case TYPE_F64:
+		PutDouble(table, column, value);
+		break;
+	}
+}
+
+void
+ColumnarWriter::PutInt(uint32_t table, uint32_t column, int64_t value)
+{
+	NS_ASSERT(table < m_tables.size() && column < m_tables[table].columns.size());
+	Type_e type = m_tables[table].columns[column].type;
+	if(type == TYPE_I64)
+	{
+		Put(table, column, &value);
+	}
+	else if(type == TYPE_F64)
+	{
+		PutDouble(table, column, value);
+	}
+	else
+	{
+		PutUint(table, column, value);
+	}
+}
+
+void
+ColumnarWriter::PutDouble(uint32_t table, uint32_t column, double value)
+{
+	NS_ASSERT(table < m_tables.size() && column < m_tables[table].columns.size());
+	Type_e type = m_tables[table].columns[column].type;
+	if(type == TYPE_F64)
+	{
+		Put(table, column, &value);
+	}
+	else if(type == TYPE_I64)
+	{
+		PutInt(table, column, static_cast<int64_t>(value));
+	}
+	else
+	{
+		PutUint(table, column, static_cast<uint64_t>(value));
+	}
+}
+
+void
+ColumnarWriter::EndRow(uint32_t table)
+{
+	NS_ASSERT(table < m_tables.size());
+	Table_s & t = m_tables[table];
+	t.rows++;
+	for(uint32_t c = 0; c < t.columns.size(); c++)
+	{
+		if(t.columns[c].values.size() != t.rows * TypeWidth(t.columns[c].type))
+		{
+			NS_FATAL_ERROR("Column " << t.columns[c].name << " of table " << t.name << " not set in the row");
+		}
+	}
+	if(t.rows >= m_chunkRows)
+	{
+		Flush(table);
+	}
+}
+
+uint32_t
+ColumnarWriter::ConvertToCsv(std::string binaryFile, std::string prefix,
+		std::vector<std::string> * tables)
+{
+	std::vector<std::string> written;
+	std::string error;
+	if(!TryConvertToCsv(binaryFile, prefix, written, error))
+	{
+		NS_FATAL_ERROR(error);
+	}
+	if(tables != 0)
+	{
+		tables->insert(tables->end(), written.begin(), written.end());
+	}
+	return written.size();
+}
+
+bool
+ColumnarWriter::TryConvertToCsv(std::string binaryFile, std::string prefix,
+		std::vector<std::string> & tables, std::string & error)
+{
+	std::FILE * in = std::fopen(binaryFile.c_str(), "rb");
+	if(in == 0)
+	{
+		error = "Unable to open export file " + binaryFile;
+		return false;
+	}
+	char magic[4];
+	uint32_t version = 0;
+	if(std::fread(magic, 1, 4, in) != 4 || memcmp(magic, COLUMNAR_MAGIC, 4) != 0
+			|| std::fread(&version, sizeof(version), 1, in) != 1)
+	{
+		std::fclose(in);
+		error = binaryFile + " is not an export file";
+		return false;
+	}
+	if(version != COLUMNAR_VERSION)
+	{
+		std::fclose(in);
+		std::stringstream ss;
+		ss << "Unsupported export file version " << version << " in " << binaryFile;
+		error = ss.str();
+		return false;
+	}
+
+	std::map<uint32_t, std::vector<Type_e> > schemas;
+	std::map<uint32_t, std::ofstream *> files;
+	uint8_t kind;
+	bool ok = true;
+	while(ok && std::fread(&kind, 1, 1, in) == 1)
+	{
+		uint32_t table = 0;
+		ok = std::fread(&table, sizeof(table), 1, in) == 1;
+		if(ok && kind == RECORD_SCHEMA)
+		{
+			uint16_t len = 0;
+			uint32_t nColumns = 0;
+			ok = std::fread(&len, sizeof(len), 1, in) == 1;
+			std::string tableName(len, ' ');
+			ok = ok && (len == 0 || std::fread(&tableName[0], 1, len, in) == len);
+			ok = ok && std::fread(&nColumns, sizeof(nColumns), 1, in) == 1;
+
+			tables.push_back(tableName);
+			std::string fileName = prefix + tableName + ".csv";
+			std::ofstream * out = new std::ofstream(fileName.c_str());
+			out->precision(12);
+			files[table] = out;
+			std::vector<Type_e> & types = schemas[table];
+			for(uint32_t c = 0; ok && c < nColumns; c++)
+			{
+				uint8_t type = 0;
+				ok = std::fread(&len, sizeof(len), 1, in) == 1;
+				std::string columnName(len, ' ');
+				ok = ok && (len == 0 || std::fread(&columnName[0], 1, len, in) == len);
+				ok = ok && std::fread(&type, 1, 1, in) == 1;
+				types.push_back(static_cast<Type_e>(type));
+				*out << (c > 0 ? "," : "") << columnName;
+			}
+			*out << "\n";
+		}
+		else if(ok && kind == RECORD_CHUNK)
+		{
+			uint32_t rows = 0;
+			ok = std::fread(&rows, sizeof(rows), 1, in) == 1 && schemas.count(table) > 0;
+			if(ok)
+			{
+				const std::vector<Type_e> & types = schemas[table];
+				std::vector<std::vector<uint8_t> > columns(types.size());
+				for(uint32_t c = 0; ok && c < types.size(); c++)
+				{
+					columns[c].resize(static_cast<size_t>(rows) * TypeWidth(types[c]));
+					ok = rows == 0 || std::fread(&columns[c][0], 1, columns[c].size(), in) == columns[c].size();
+				}
+				std::ofstream & out = *files[table];
+				for(uint32_t r = 0; ok && r < rows; r++)
+				{
+					for(uint32_t c = 0; c < types.size(); c++)
+					{
+						const uint8_t * v = &columns[c][static_cast<size_t>(r) * TypeWidth(types[c])];
+						if(c > 0)
+						{
+							out << ",";
+						}
+						switch(types[c])
+						{
+						case TYPE_U8:
+							out << static_cast<uint32_t>(*v);
+							break;
+						case TYPE_U32:
+						{
+							uint32_t x;
+							memcpy(&x, v, sizeof(x));
+							out << x;
+							break;
+						}
+						case TYPE_U64:
+						{
+							uint64_t x;
+							memcpy(&x, v, sizeof(x));
+							out << x;
+							break;
+						}
+						case TYPE_I64:
+						{
+							int64_t x;
+							memcpy(&x, v, sizeof(x));
+							out << x;
+							break;
+						}
+						case TYPE_F64:
+						{
+							double x;
+							memcpy(&x, v, sizeof(x));
+							out << x;
+							break;
+						}
+						}
+					}
+					out << "\n";
+				}
+			}
+		}
+		else
+		{
+			ok = false;
+		}
+	}
+	std::fclose(in);
+
+	for(std::map<uint32_t, std::ofstream *>::iterator it = files.begin(); it != files.end(); it++)
+	{
+		it->second->close();
+		delete it->second;
+	}
+	if(!ok)
+	{
+		error = "Corrupted export file " + binaryFile;
+	}
+	return ok;
+}
+
+/*
+ * ------------- private methods -------------
+ */
+
+uint32_t
+ColumnarWriter::TypeWidth(Type_e type)
+{
+	switch(type)
+	{
+	case TYPE_U8:
+		return 1;
+	case TYPE_U32:
+		return 4;
+	default:
+		return 8;
+	}
+}
+
+void
+ColumnarWriter::Put(uint32_t table, uint32_t column, const void * value)
+{
+	Column_s & c = m_tables[table].columns[column];
+	const uint8_t * bytes = static_cast<const uint8_t *>(value);
+	c.values.insert(c.values.end(), bytes, bytes + TypeWidth(c.type));
+}
+
+void
+ColumnarWriter::Flush(uint32_t table)
+{
+	Table_s & t = m_tables[table];
+	if(m_file == 0)
+	{
+		NS_FATAL_ERROR("Export file of table " << t.name << " is not open");
+	}
+	if(!t.schemaWritten)
+	{
+		std::fwrite(&RECORD_SCHEMA, 1, 1, m_file);
+		std::fwrite(&table, sizeof(table), 1, m_file);
+		WriteName(t.name);
+		uint32_t nColumns = t.columns.size();
+		std::fwrite(&nColumns, sizeof(nColumns), 1, m_file);
+		for(uint32_t c = 0; c < t.columns.size(); c++)
+		{
+			WriteName(t.columns[c].name);
+			uint8_t type = t.columns[c].type;
+			std::fwrite(&type, 1, 1, m_file);
+		}
+		t.schemaWritten = true;
+	}
+	if(t.rows == 0)
+	{
+		return;
+	}
+	std::fwrite(&RECORD_CHUNK, 1, 1, m_file);
+	std::fwrite(&table, sizeof(table), 1, m_file);
+	std::fwrite(&t.rows, sizeof(t.rows), 1, m_file);
+	for(uint32_t c = 0; c < t.columns.size(); c++)
+	{
+		std::fwrite(&t.columns[c].values[0], 1, t.columns[c].values.size(), m_file);
+		t.columns[c].values.clear();
+	}
+	t.rows = 0;
+}
+
+void
+ColumnarWriter::WriteName(const std::string & name)
+{
+	uint16_t len = name.size();
+	std::fwrite(&len, sizeof(len), 1, m_file);
+	std::fwrite(name.data(), 1, len, m_file);
+}
+
+} /* namespace ns3 */
@@ -0,0 +1,186 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *
+ * columnar-writer.h
+ *
+ *  Created on: Apr 3, 2017
+ *      Author: ubaid
+ *       Email: u.ur.rahman@gmail.com
+ */
+
+#ifndef NUTSHELL_COLUMNAR_WRITER_H
+#define NUTSHELL_COLUMNAR_WRITER_H
+
+#include <stdint.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief Writes tables of typed columns into a single binary file
+ *
+ * The rows of a table are buffered per column and written as a chunk,
+ * one array per column, every chunk size rows, so the export is a
+ * sequential bulk write. The file, in host byte order, is:
+ *
+ *   header: magic "NSCD", version (uint32)
+ *   followed by records, each starting with its kind (uint8):
+ *   'T' schema: table (uint32), name, number of columns (uint32),
+ *       and the name and type (uint8) of each column
+ *   'C' chunk: table (uint32), number of rows (uint32),
+ *       followed by one array of values for each column
+ *
+ * Names are a length (uint16) followed by the characters. The schema of
+ * a table precedes its first chunk. ConvertToCsv writes a CSV file per table.
+ */
+class ColumnarWriter {
+public:
+	/**
+	 * \brief Types of column
+	 */
+	enum Type_e {
+		TYPE_U8 = 0,
+		TYPE_U32,
+		TYPE_U64,
+		TYPE_I64,
+		TYPE_F64
+	};
+
+	ColumnarWriter();
+	virtual ~ColumnarWriter();
+
+	/**
+	 * \brief Creates the file and writes the header
+	 * \param fileName The path of file
+	 */
+	void Open(std::string fileName);
+	/**
+	 * \brief Writes the buffered rows of all tables and closes the file
+	 */
+	void Close();
+	/**
+	 * \return true if a file is open
+	 */
+	bool IsOpen() const;
+	/**
+	 * \brief Set the number of rows buffered per table before a chunk is written
+	 * \param rows The rows per chunk
+	 */
+	void SetChunkRows(uint32_t rows);
+
+	/**
+	 * \brief Adds a table, its columns are added with AddColumn
+	 * \param name The name of table
+	 * \return The index of table
+	 */
+	uint32_t AddTable(std::string name);
+	/**
+	 * \brief Adds a column to a table without rows
+	 * \param table The index of table
+	 * \param name The name of column
+	 * \param type The type of values
+	 * \return The index of column
+	 */
+	uint32_t AddColumn(uint32_t table, std::string name, Type_e type);
+
+	/**
+	 * \brief Sets the value of an integer column in the current row
+	 */
+	void PutUint(uint32_t table, uint32_t column, uint64_t value);
+	/**
+	 * \brief Sets the value of a signed integer column in the current row
+	 */
+	void PutInt(uint32_t table, uint32_t column, int64_t value);
+	/**
+	 * \brief Sets the value of a floating point column in the current row
+	 */
+	void PutDouble(uint32_t table, uint32_t column, double value);
+	/**
+	 * \brief Ends the current row, all columns must have been set
+	 * \param table The index of table
+	 */
+	void EndRow(uint32_t table);
+
+	/**
+	 * \brief Converts a binary file to CSV files, one per table
+	 * \param binaryFile The path of binary file
+	 * \param prefix The prefix of CSV files, followed by the table name
+	 * \param tables If not 0, receives the names of tables written
+	 * \return The number of tables written
+	 */
+	static uint32_t ConvertToCsv(std::string binaryFile, std::string prefix,
+			std::vector<std::string> * tables = 0);
+	/**
+	 * \brief Converts a binary file to CSV files, reporting a bad file instead of aborting
+	 *
+	 * The CSV files of a corrupted file may be partially written.
+	 *
+	 * \param binaryFile The path of binary file
+	 * \param prefix The prefix of CSV files, followed by the table name
+	 * \param tables Receives the names of tables written
+	 * \param error Receives the reason of failure
+	 * \return false if the file can not be read or is corrupted
+	 */
+	static bool TryConvertToCsv(std::string binaryFile, std::string prefix,
+			std::vector<std::string> & tables, std::string & error);
+
+private:
+	/**
+	 * \brief A column and its buffered values
+	 */
+	struct Column_s {
+		std::string name;
+		Type_e type;
+		std::vector<uint8_t> values; //!< The values of buffered rows
+	};
+	/**
+	 * \brief A table and its buffered rows
+	 */
+	struct Table_s {
+		std::string name;
+		std::vector<Column_s> columns;
+		uint32_t rows; //!< The buffered rows
+		bool schemaWritten; //!< true once the schema record is written
+	};
+
+	/**
+	 * \brief Get the size of a value of type
+	 */
+	static uint32_t TypeWidth(Type_e type);
+	/**
+	 * \brief Appends the bytes of a value to a column of current row
+	 */
+	void Put(uint32_t table, uint32_t column, const void * value);
+	/**
+	 * \brief Writes the buffered rows of a table as a chunk
+	 */
+	void Flush(uint32_t table);
+	/**
+	 * \brief Writes a length prefixed name
+	 */
+	void WriteName(const std::string & name);
+
+	std::FILE * m_file; //!< The open file, 0 if none
+	std::vector<Table_s> m_tables; //!< The tables
+	uint32_t m_chunkRows; //!< Rows buffered per table
+};
+
+} /* namespace ns3 */
+
+#endif /* NUTSHELL_COLUMNAR_WRITER_H */
@@ -209,7 +209,7 @@ void
 ComputationalLocalDataVm::ScheduleStop(double time)
 {
 	NS_LOG_FUNCTION(this);
-	Simulator::Schedule(Seconds(time), &ComputationalLocalDataVm::StopApplication, this);
+	m_finishEvent = Simulator::Schedule(Seconds(time), &ComputationalLocalDataVm::StopApplication, this);
 }
 
 
@@ -232,13 +232,11 @@ ComputationalLocalDataVm::StartApplication()
 		if(m_requireData)
 		{
 			double dataFetch = CalculateDataFetchTime();
-			double processingTime = CalculateProcessingTime();
-			ScheduleStop((dataFetch+processingTime));
+			ScheduleProcessing(dataFetch);
 		}
 		else
 		{
-			double processingTime = CalculateProcessingTime();
-			ScheduleStop(processingTime);
+			ScheduleProcessing(0.0);
 		}
 	}
 	else
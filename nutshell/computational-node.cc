@@ -13,6 +13,7 @@
 #include "ns3/simulator.h"
 #include "ns3/traced-value.h"
 #include "ns3/trace-source-accessor.h"
+#include "ns3/boolean.h"
 #include "node-utilization.h"
 
 namespace ns3 {
@@ -41,6 +42,15 @@ namespace ns3 {
                             StorageValue(Storage("2TB")),
                             MakeStorageAccessor(&ComputationalNode::m_secondaryStorage),
                             MakeStorageChecker())
+            .AddAttribute ("ProcessorSharing",
+                            "Share the processing power of node among the running VMs instead of"
+                            " running each VM at its reserved processing power",
+                            BooleanValue(false),
+                            MakeBooleanAccessor(&ComputationalNode::m_processorSharing),
+                            MakeBooleanChecker())
+            .AddTraceSource ("ResourcesChanged",
+                            "The remaining resources of the node have changed",
+                            MakeTraceSourceAccessor (&ComputationalNode::m_resourcesChangedTrace))
         ;
         return tid;
             
@@ -57,38 +67,45 @@ namespace ns3 {
     }
 
     ComputationalNode::ComputationalNode ( )
-        : Node()
+        : Node(),
+          m_processorSharing (false)
     {
         NS_LOG_FUNCTION(this);
         InitializeUtilization();
     }
     ComputationalNode::ComputationalNode ( uint32_t systemId )
-        : Node (systemId)
+        : Node (systemId),
+          m_processorSharing (false)
     {
         NS_LOG_FUNCTION(this);
         InitializeUtilization();
     }
     ComputationalNode::ComputationalNode ( uint32_t systemId, ProcessingPower processingPower, Storage primaryStorage, Storage secondaryStorage )
-        : Node (systemId)
+        : Node (systemId),
+          m_processorSharing (false)
     {
         NS_LOG_FUNCTION(this);
          m_processingPower = processingPower;
+         m_baseProcessingPower = processingPower;
          m_primaryStorage = primaryStorage;
          m_secondaryStorage = secondaryStorage;
          InitializeUtilization();
     }
     
     ComputationalNode::ComputationalNode(ProcessingPower processingPower, Storage primaryStorage, Storage secondaryStorage)
-    	: Node()
+    	: Node(),
+    	  m_processorSharing (false)
     {
     	NS_LOG_FUNCTION (this);
 		m_processingPower = processingPower;
+		m_baseProcessingPower = processingPower;
 		m_primaryStorage = primaryStorage;
 		m_secondaryStorage = secondaryStorage;
 		InitializeUtilization();
     }
 
     ComputationalNode::ComputationalNode (const ComputationalNode& orig) 
+        : m_processorSharing (false)
     {
         NS_LOG_FUNCTION(this);
         InitializeUtilization();
@@ -102,11 +119,16 @@ namespace ns3 {
     	NS_LOG_FUNCTION(this);
 //    	NS_LOG_UNCOND("Node New: " << processingPower <<" | " << primaryStorage << " | " << secondaryStorage);
     	m_processingPower = processingPower;
+		m_baseProcessingPower = processingPower;
 		m_primaryStorage = primaryStorage;
 		m_secondaryStorage = secondaryStorage;
 
+		if(m_cpu)
+		{
+			m_cpu->SetCapacity(m_baseProcessingPower.GetProcessingPower());
+		}
 		m_utilization->SetBaseResources(m_processingPower, m_primaryStorage, m_secondaryStorage);
-
+		m_resourcesChangedTrace(GetId());
     }
 
     ComputationalNode::~ComputationalNode ( )
@@ -135,6 +157,7 @@ namespace ns3 {
 	ComputationalNode::SetNicDataRate(DataRate rate)
     {
     	m_nicDataRate = rate;
+    	m_resourcesChangedTrace(GetId());
     }
     DataRate
 	ComputationalNode::GetNicDataRate()
@@ -155,6 +178,7 @@ namespace ns3 {
         	m_secondaryStorage = m_secondaryStorage - secondaryStorage;
 
         	m_utilization->ReserveResources(processingPower, primaryStorage, secondaryStorage);
+        	m_resourcesChangedTrace(GetId());
 
         	return true;
         }
@@ -176,6 +200,7 @@ namespace ns3 {
 
 
 		m_utilization->ReleaseResources(processingPower, primaryStorage, secondaryStorage);
+		m_resourcesChangedTrace(GetId());
 		return true;
     }
 
@@ -209,6 +234,38 @@ namespace ns3 {
 			return false;
 		}
     }
+
+    bool
+	ComputationalNode::IsProcessorSharing() const
+    {
+    	return m_processorSharing;
+    }
+
+    uint64_t
+	ComputationalNode::SubmitWork(double work, double weight, Callback<void> done)
+    {
+    	NS_LOG_FUNCTION(this << work << weight);
+    	if(!m_processorSharing)
+    	{
+    		NS_FATAL_ERROR("Processor sharing is not enabled on node " << GetId());
+    	}
+    	if(!m_cpu)
+    	{
+    		m_cpu = CreateObject<ProcessorSharingCpu>();
+    		m_cpu->SetCapacity(m_baseProcessingPower.GetProcessingPower());
+    	}
+    	return m_cpu->Submit(work, weight, done);
+    }
+
+    void
+	ComputationalNode::CancelWork(uint64_t id)
+    {
+    	NS_LOG_FUNCTION(this << id);
+    	if(m_cpu)
+    	{
+    		m_cpu->Cancel(id);
+    	}
+    }
     
     /*
         ----------------
@@ -221,6 +278,11 @@ namespace ns3 {
     ComputationalNode::DoDispose ( )
     {
         NS_LOG_FUNCTION(this);
+        if(m_cpu)
+        {
+        	m_cpu->Dispose();
+        	m_cpu = 0;
+        }
         Node::DoDispose ();
     }
 
@@ -228,6 +290,11 @@ namespace ns3 {
     ComputationalNode::DoInitialize ( )
     {
         NS_LOG_FUNCTION(this);
+        if(m_baseProcessingPower.GetProcessingPower() == 0)
+        {
+        	// Resources were set through attributes only
+        	m_baseProcessingPower = m_processingPower;
+        }
         Node::DoInitialize ();
     }
     
@@ -291,12 +358,14 @@ namespace ns3 {
 	ComputationalNode::ReserveNicRate(DataRate rate)
     {
     	m_nicDataRate = DataRate((m_nicDataRate.GetBitRate() - rate.GetBitRate()));
+    	m_resourcesChangedTrace(GetId());
     	return true;
     }
     bool
 	ComputationalNode::ReleaseNicRate(DataRate rate)
     {
     	m_nicDataRate = DataRate((m_nicDataRate.GetBitRate() + rate.GetBitRate()));
+    	m_resourcesChangedTrace(GetId());
     	return true;
     }
 
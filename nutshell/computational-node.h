@@ -14,7 +14,10 @@
 #include "ns3/traced-value.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/data-rate.h"
+#include "ns3/traced-callback.h"
+#include "ns3/callback.h"
 #include "node-utilization.h"
+#include "processor-sharing-cpu.h"
 
 namespace ns3 {
     
@@ -201,6 +204,34 @@ public:
      */
     bool CheckAvailability(ProcessingPower p, Storage ps, Storage ss,
     		DataRate r);
+
+    /**
+     * \brief Checks if the node runs VMs on a processor sharing CPU
+     *
+     * With processor sharing the work of co-located VMs is processed
+     * concurrently and the processing power of node is shared among the
+     * running VMs in proportion to their processing power, otherwise every
+     * VM runs at its reserved processing power.
+     *
+     * \return boolean true if processor sharing is enabled, false otherwise.
+     */
+    bool IsProcessorSharing(void) const;
+
+    /**
+     * \brief Submits work to the processor sharing CPU of node
+     *
+     * \param work the amount of work, in FLOP or instructions as per the node processing power
+     * \param weight the share of work relative to other work on the node
+     * \param done the callback invoked when the work is complete
+     * \return the ID of work, used to cancel it
+     */
+    uint64_t SubmitWork(double work, double weight, Callback<void> done);
+
+    /**
+     * \brief Cancels the work submitted to the processor sharing CPU
+     * \param id the ID of work returned by SubmitWork
+     */
+    void CancelWork(uint64_t id);
     
 
 protected:
@@ -258,12 +289,22 @@ private:
     bool IsNicRateAvailable(DataRate r);
      
     ProcessingPower m_processingPower; //!< Computational node's processing power in flops or mips
+    ProcessingPower m_baseProcessingPower; //!< Processing power of node before any reservation
     Storage m_secondaryStorage; //!< Secondary storage capacity of node.
     Storage m_primaryStorage; //!< Primary memory of node i.e. RAM
     DataRate m_nicDataRate; //!< NIC DataRate
 
 
     Ptr<NodeUtilization> m_utilization; //!< Node Utilization
+
+    bool m_processorSharing; //!< Run VMs on a processor sharing CPU
+    Ptr<ProcessorSharingCpu> m_cpu; //!< The processor sharing CPU, created on first use
+
+    /**
+     * Fired whenever the remaining processing power, storage or NIC rate
+     * of the node changes, with the ID of the node.
+     */
+    TracedCallback<uint32_t> m_resourcesChangedTrace;
     
 };
 
@@ -48,7 +48,7 @@ ConnectionHelper::ConnectDevicesLayer2(Ptr<Node>& l2switch,
 	NetDeviceContainer terminalDevices;
 	Ipv4InterfaceContainer interfaces;
 	CreateL2Connections(l2switch, connectingDevices, csma, bridge, bridgeNetDevices, terminalDevices,
-						interfaces, networkAddress, subnet);
+						interfaces, Ipv4Address(networkAddress.c_str()), Ipv4Mask(subnet.c_str()));
 }
 
 void
@@ -62,7 +62,7 @@ ConnectionHelper::ConnectDevicesLayer2(Ptr<Node>& l2switch,
 	NetDeviceContainer bridgeNetDevices;
 	NetDeviceContainer terminalDevices;
 	CreateL2Connections(l2switch, connectingDevices, csma, bridge, bridgeNetDevices, terminalDevices,
-							terminalInterfaces, networkAddress, subnet);
+							terminalInterfaces, Ipv4Address(networkAddress.c_str()), Ipv4Mask(subnet.c_str()));
 }
 
 void
@@ -76,7 +76,7 @@ ConnectionHelper::ConnectDevicesLayer2(Ptr<Node>& l2switch,
 										std::string networkAddress, std::string subnet)
 {
 	CreateL2Connections(l2switch, connectingDevices, csma, bridge, bridgeDevices, terminalDevices,
-								terminalInterfaces, networkAddress, subnet);
+								terminalInterfaces, Ipv4Address(networkAddress.c_str()), Ipv4Mask(subnet.c_str()));
 }
 /*
 void
@@ -120,7 +120,8 @@ ConnectionHelper::ConnectDevicesLayer3(Ptr<Node>& l3device,
 										std::string networkAddress, std::string subnet)
 {
 	Ipv4InterfaceContainer allInterfaces, terminalInterfaces;
-	CreateL3Connections(l3device, connectingDevices, p2p, allInterfaces, terminalInterfaces, networkAddress, subnet);
+	CreateL3Connections(l3device, connectingDevices, p2p, allInterfaces, terminalInterfaces,
+						Ipv4Address(networkAddress.c_str()), Ipv4Mask(subnet.c_str()));
 //	int c = 0;
 //	for(Ipv4InterfaceContainer::Iterator i = terminalInterfaces.Begin(); i != terminalInterfaces.End(); i++)
 //	{
@@ -138,7 +139,8 @@ ConnectionHelper::ConnectDevicesLayer3(Ptr<Node>& firstL3device,
 	NodeContainer connectingDevices;
 	connectingDevices.Add(secL3device);
 	Ipv4InterfaceContainer allInterfaces, terminalInterfaces;
-	CreateL3Connections(firstL3device, connectingDevices, p2p, allInterfaces, terminalInterfaces, networkAddress, subnet);
+	CreateL3Connections(firstL3device, connectingDevices, p2p, allInterfaces, terminalInterfaces,
+						Ipv4Address(networkAddress.c_str()), Ipv4Mask(subnet.c_str()));
 //	int c = 0;
 //	for(Ipv4InterfaceContainer::Iterator i = terminalInterfaces.Begin(); i != terminalInterfaces.End(); i++)
 //	{
@@ -155,7 +157,8 @@ ConnectionHelper::ConnectDevicesLayer3(Ptr<Node>& l3device,
 										std::string networkAddress, std::string subnet)
 {
 	Ipv4InterfaceContainer allInterfaces;
-	CreateL3Connections(l3device, connectingDevices, p2p, allInterfaces, terminalInterfaces, networkAddress, subnet);
+	CreateL3Connections(l3device, connectingDevices, p2p, allInterfaces, terminalInterfaces,
+						Ipv4Address(networkAddress.c_str()), Ipv4Mask(subnet.c_str()));
 }
 
 
@@ -167,7 +170,41 @@ ConnectionHelper::ConnectDevicesLayer3(Ptr<Node>& l3device,
 										Ipv4InterfaceContainer& terminalInterfaces,
 										std::string networkAddress, std::string subnet)
 {
-	CreateL3Connections(l3device, connectingDevices, p2p, allInterfaces, terminalInterfaces, networkAddress, subnet);
+	CreateL3Connections(l3device, connectingDevices, p2p, allInterfaces, terminalInterfaces,
+						Ipv4Address(networkAddress.c_str()), Ipv4Mask(subnet.c_str()));
+}
+
+void
+ConnectionHelper::ConnectDevicesLayer3(Ptr<Node>& l3device,
+										NodeContainer& connectingDevices,
+										PointToPointHelper& p2p,
+										Ipv4Address network, Ipv4Mask mask)
+{
+	Ipv4InterfaceContainer allInterfaces, terminalInterfaces;
+	CreateL3Connections(l3device, connectingDevices, p2p, allInterfaces, terminalInterfaces, network, mask);
+}
+
+void
+ConnectionHelper::ConnectDevicesLayer3(Ptr<Node>& firstL3device,
+										Ptr<Node> & secL3device,
+										PointToPointHelper& p2p,
+										Ipv4Address network, Ipv4Mask mask)
+{
+	NodeContainer connectingDevices;
+	connectingDevices.Add(secL3device);
+	Ipv4InterfaceContainer allInterfaces, terminalInterfaces;
+	CreateL3Connections(firstL3device, connectingDevices, p2p, allInterfaces, terminalInterfaces, network, mask);
+}
+
+void
+ConnectionHelper::ConnectDevicesLayer3(Ptr<Node>& l3device,
+										NodeContainer& connectingDevices,
+										PointToPointHelper& p2p,
+										Ipv4InterfaceContainer& allInterfaces,
+										Ipv4InterfaceContainer& terminalInterfaces,
+										Ipv4Address network, Ipv4Mask mask)
+{
+	CreateL3Connections(l3device, connectingDevices, p2p, allInterfaces, terminalInterfaces, network, mask);
 }
 
 void
@@ -178,7 +215,7 @@ ConnectionHelper::CreateL2Connections(Ptr<Node>& l2switch,
 										NetDeviceContainer& bridgeDevices,
 										NetDeviceContainer& terminalDevices,
 										Ipv4InterfaceContainer& terminalInterfaces,
-										std::string networkAddress, std::string subnet)
+										Ipv4Address network, Ipv4Mask mask)
 {
 	for(NodeContainer::Iterator i = connectingDevices.Begin(); i != connectingDevices.End(); i++)
 	{
@@ -189,7 +226,7 @@ ConnectionHelper::CreateL2Connections(Ptr<Node>& l2switch,
 	}
 	bridge.Install(l2switch, bridgeDevices);
 	Ipv4AddressHelper ipv4;
-	ipv4.SetBase(networkAddress.c_str(), subnet.c_str());
+	ipv4.SetBase(network, mask);
 	terminalInterfaces = ipv4.Assign(terminalDevices);
 }
 
@@ -199,10 +236,10 @@ ConnectionHelper::CreateL3Connections(Ptr<Node>& l3device,
 										PointToPointHelper& p2p,
 										Ipv4InterfaceContainer& allInterfaces,
 										Ipv4InterfaceContainer& terminalInterfaces,
-										std::string networkAddress, std::string subnet)
+										Ipv4Address network, Ipv4Mask mask)
 {
 	Ipv4AddressHelper ipv4;
-	ipv4.SetBase(networkAddress.c_str(), subnet.c_str());
+	ipv4.SetBase(network, mask);
 	for(NodeContainer::Iterator i = connectingDevices.Begin(); i != connectingDevices.End(); i++)
 	{
 		NodeContainer sub = NodeContainer(*i, l3device);
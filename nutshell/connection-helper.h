@@ -31,6 +31,7 @@
 #include "ns3/node-container.h"
 #include "ns3/csma-helper.h"
 #include "ns3/point-to-point-helper.h"
+#include "ns3/ipv4-address.h"
 #include "ns3/ipv4-interface-container.h"
 #include "ns3/bridge-helper.h"
 
@@ -159,6 +160,44 @@ public:
 								Ipv4InterfaceContainer& allInterfaces,
 								Ipv4InterfaceContainer& terminalInterfaces,
 								std::string networkAddress, std::string subnet);
+	/**
+	 * \brief Connects devices with layer 3 connection, with a numeric network
+	 * \param l3device The switch/router to which the nodes will connect
+	 * \param connectingDevices The nodes to be connected to the switch
+	 * \param p2p The configured point-to-point link
+	 * \param network Network Subnet network address
+	 * \param mask Netowrk Subnet's subnet mask.
+	 */
+	void ConnectDevicesLayer3(Ptr<Node>& l3device,
+								NodeContainer& connectingDevices,
+								PointToPointHelper& p2p,
+								Ipv4Address network, Ipv4Mask mask);
+	/**
+	 * \brief Connects two Layer 3 Devices together, with a numeric network
+	 * \param firstL3device The first switch/router in the connection
+	 * \param secL3device The second switch/router in the connection
+	 */
+	void ConnectDevicesLayer3(Ptr<Node>& firstL3device,
+								Ptr<Node> & secL3device,
+								PointToPointHelper& p2p,
+								Ipv4Address network, Ipv4Mask mask);
+	/**
+	 * \brief Connects devices with layer 3 connection, with a numeric network, and also send out
+	 * all interfaces and the node interface container
+	 * \param l3device The switch/router to which the nodes will connect
+	 * \param connectingDevices The nodes to be connected to the switch
+	 * \param p2p The configured point-to-point link
+	 * \param allInterfaces All IP interface container includes, all interfaces of router/switch and all node's interfaces
+	 * \param terminalInterfaces The Node's IP interface container
+	 * \param network Network Subnet network address
+	 * \param mask Netowrk Subnet's subnet mask.
+	 */
+	void ConnectDevicesLayer3(Ptr<Node>& l3device,
+								NodeContainer& connectingDevices,
+								PointToPointHelper& p2p,
+								Ipv4InterfaceContainer& allInterfaces,
+								Ipv4InterfaceContainer& terminalInterfaces,
+								Ipv4Address network, Ipv4Mask mask);
 
 
 private:
@@ -172,8 +211,8 @@ private:
 	 * \param bridgeDevices The bridge NetDevice container
 	 * \param terminalDevices The Nodes NetDevice container
 	 * \param terminalInterfaces The Node's IP interface container
-	 * \param networkAddress Network Subnet network address
-	 * \param subnet Netowrk Subnet's subnet mask.
+	 * \param network Network Subnet network address
+	 * \param mask Netowrk Subnet's subnet mask.
 	 */
 	void CreateL2Connections(Ptr<Node>& l2switch,
 								NodeContainer& connectingDevices,
@@ -182,7 +221,7 @@ private:
 								NetDeviceContainer& bridgeDevices,
 								NetDeviceContainer& terminalDevices,
 								Ipv4InterfaceContainer& terminalInterfaces,
-								std::string networkAddress, std::string subnet);
+								Ipv4Address network, Ipv4Mask mask);
 
 	/**
 	 * \brief Connects devices with layer 3 connection and also send out the node interface container as well as
@@ -192,15 +231,15 @@ private:
 	 * \param p2p The configured point-to-point link
 	 * \param allInterfaces All IP interface container includes, all interfaces of router/switch and all node's interfaces
 	 * \param terminalInterfaces The Node's IP interface container
-	 * \param networkAddress Network Subnet network address
-	 * \param subnet Netowrk Subnet's subnet mask.
+	 * \param network Network Subnet network address
+	 * \param mask Netowrk Subnet's subnet mask.
 	 */
 	void CreateL3Connections(Ptr<Node>& l3device,
 								NodeContainer& connectingDevices,
 								PointToPointHelper& p2p,
 								Ipv4InterfaceContainer& allInterfaces,
 								Ipv4InterfaceContainer& terminalInterfaces,
-								std::string networkAddress, std::string subnet);
+								Ipv4Address network, Ipv4Mask mask);
 };
 
 } /* namespace ns3 */
@@ -105,14 +105,20 @@ void
 ConsumerProducerVm::ScheduleStop(double delay)
 {
 	NS_LOG_FUNCTION(this);
-	Simulator::Schedule(Seconds(delay), &ConsumerProducerVm::StopApplication, this);
+	m_finishEvent = Simulator::Schedule(Seconds(delay), &ConsumerProducerVm::StopApplication, this);
 }
 
 void
 ConsumerProducerVm::ScheduleTransmit(double delay)
 {
 	NS_LOG_FUNCTION(this);
-	Simulator::Schedule(Seconds(delay), &ConsumerProducerVm::BeginTransmission, this);
+	m_sendEvent = Simulator::Schedule(Seconds(delay), &ConsumerProducerVm::BeginTransmission, this);
+}
+void
+ConsumerProducerVm::ProcessingCompleted()
+{
+	NS_LOG_FUNCTION(this);
+	ScheduleTransmit(0.0);
 }
 void
 ConsumerProducerVm::BeginTransmission()
@@ -173,14 +179,18 @@ ConsumerProducerVm::HandleRead(Ptr<Socket> socket)
 
 			}
 			m_rxTrace(packet, from);
-			std::string s = GetPacketString(packet);
-			if(s == "Done" || s == "done" || s == "don")
-			{
-				ScheduleStop(0.0);
-			}
-			else
+			m_controlStream.Receive(socket, packet);
+			VmControlHeader control;
+			while(ReadControl(socket, control))
 			{
-				RetransmitRequest(s, socket);
+				if(control.GetType() == VmControlHeader::DONE)
+				{
+					ScheduleStop(0.0);
+				}
+				else if(control.GetType() == VmControlHeader::RETRANSMIT)
+				{
+					RetransmitRequest(control, socket);
+				}
 			}
 
 		}
@@ -189,6 +199,21 @@ ConsumerProducerVm::HandleRead(Ptr<Socket> socket)
 
 }
 
+void
+ConsumerProducerVm::HandleFlow(uint64_t bytes)
+{
+	NS_LOG_FUNCTION(this << bytes);
+	if(!m_producing && m_receivedBytes < GetDataSize())
+	{
+		m_receivedBytes = m_receivedBytes + Storage(bytes);
+		if(!(m_receivedBytes < GetDataSize()))
+		{
+			m_done = true;
+			ExecuteOperation();
+		}
+	}
+}
+
 void
 ConsumerProducerVm::CreateTransmittingSocket()
 {
@@ -255,13 +280,20 @@ ConsumerProducerVm::StartApplication()
 
 	if(ReserveResources() && GetCompNode()->ReserveNicRate(GetVmTransmissionRate()))
 	{
+		if(IsFlowLevel())
+		{
+			BindFlowReceiver(MakeCallback(&ConsumerProducerVm::HandleFlow, this));
+			if(m_consumerType == ConsumerProducerVm::CONSUMER_CLIENT)
+			{
+				RequestFlow(GetDataSize().GetStorage());
+			}
+			return;
+		}
 		CreateSocket();
 		if(m_consumerType == ConsumerProducerVm::CONSUMER_CLIENT)
 		{
 			SetSocketRecvCallBack(MakeCallback(&ConsumerProducerVm::HandleRead, this));
-			std::string fill;
-			PrepareRequestString(fill, GetDataSize().GetStorage());
-			Ptr<Packet> p = CreatePacket(fill);
+			Ptr<Packet> p = CreateRequestPacket(GetDataSize().GetStorage());
 			Send(p);
 		}
 		else if(m_consumerType == ConsumerProducerVm::CONSUMER_CONSUMER)
@@ -295,21 +327,15 @@ ConsumerProducerVm::StopApplication()
 
 }
 
-void
-ConsumerProducerVm::PrepareRequestString(std::string& fill, uint64_t dataSize)
+Ptr<Packet>
+ConsumerProducerVm::CreateRequestPacket(uint64_t dataSize)
 {
-//	std::string fill =  "Required Data: " << this->GetDataSize().GetStorage() << " Rate: " << this->GetVmTransmissionRate().GetBitRate();
-	fill = "RD: ";
-	std::ostringstream o;
-	o << dataSize;
-	fill += o.str();
+	NS_LOG_FUNCTION(this << dataSize);
 	if(m_consumerType == ConsumerProducerVm::CONSUMER_CLIENT)
 	{
-		o.str("");
-		fill += "| R: ";
-		o << this->GetVmTransmissionRate().GetBitRate();
-		fill += o.str();
+		return CreateControlPacket(VmControlHeader::REQUEST, dataSize);
 	}
+	return CreateControlPacket(VmControlHeader::RETRANSMIT, dataSize);
 }
 
 void
@@ -319,7 +345,6 @@ ConsumerProducerVm::ExecuteOperation()
 	Storage rd = this->GetDataSize();
 	NS_LOG_INFO("RD: " << rd);
 	double dataFetch = CalculateDataFetchTime();
-	double executionTime = this->CalculateProcessingTime();
 	/*
 	 * Close socket, reset socket to 0 so that another socket
 	 * can be created, setting m_producing to true will prevent
@@ -337,8 +362,11 @@ ConsumerProducerVm::ExecuteOperation()
 	m_remoteAddress = m_producerForRemoteAddress;
 	m_peerPort = m_producerForRemotePort;
 
-	CreateTransmittingSocket();
-	ScheduleTransmit((dataFetch+executionTime));
+	if(!IsFlowLevel())
+	{
+		CreateTransmittingSocket();
+	}
+	ScheduleProcessing(dataFetch);
 }
 
 void
@@ -355,9 +383,7 @@ ConsumerProducerVm::HandleServerClose(Ptr<Socket> socket)
 			CreateTransmittingSocket();
 			Storage remaining = GetDataSize() - m_receivedBytes;
 			NS_LOG_INFO("Server closed Remaining: " << remaining);
-			std::string fill;
-			PrepareRequestString(fill, remaining.GetStorage());
-			Ptr<Packet> p = CreatePacket(fill);
+			Ptr<Packet> p = CreateRequestPacket(remaining.GetStorage());
 			Send(p);
 		}
 	}
@@ -388,9 +414,7 @@ ConsumerProducerVm::HandleServerCloseError(Ptr<Socket> socket)
 
 			Storage remaining = GetDataSize() - m_receivedBytes;
 			NS_LOG_INFO("Producer close Remaining: " << remaining);
-			std::string fill;
-			PrepareRequestString(fill, remaining.GetStorage());
-			Ptr<Packet> p = CreatePacket(fill);
+			Ptr<Packet> p = CreateRequestPacket(remaining.GetStorage());
 			Send(p);
 		}
 		else
@@ -398,8 +422,7 @@ ConsumerProducerVm::HandleServerCloseError(Ptr<Socket> socket)
 			m_done = true;
 			CloseTransmittingSocket();
 			CreateTransmittingSocket();
-			std::string fill = "Done";
-			Ptr<Packet> p = CreatePacket(fill);
+			Ptr<Packet> p = CreateControlPacket(VmControlHeader::DONE, 0);
 			Send(p);
 //			CloseTransmittingSocket();
 		}
@@ -433,9 +456,7 @@ ConsumerProducerVm::HandleProducerClose(Ptr<Socket> socket)
 
 			Storage remaining = GetDataSize() - m_receivedBytes;
 			NS_LOG_INFO("Producer close Remaining: " << remaining);
-			std::string fill;
-			PrepareRequestString(fill, remaining.GetStorage());
-			Ptr<Packet> p = CreatePacket(fill);
+			Ptr<Packet> p = CreateRequestPacket(remaining.GetStorage());
 			Send(p);
 		}
 		else
@@ -443,8 +464,7 @@ ConsumerProducerVm::HandleProducerClose(Ptr<Socket> socket)
 			m_done = true;
 			CloseTransmittingSocket();
 			CreateTransmittingSocket();
-			std::string fill = "Done";
-			Ptr<Packet> p = CreatePacket(fill);
+			Ptr<Packet> p = CreateControlPacket(VmControlHeader::DONE, 0);
 			Send(p);
 //			CloseTransmittingSocket();
 		}
@@ -482,9 +502,7 @@ ConsumerProducerVm::HandlePeerClose (Ptr<Socket> socket)
 	  			CreateTransmittingSocket();
 	  			Storage remaining = GetDataSize() - m_receivedBytes;
 	  			NS_LOG_INFO("Peer close Remaining: " << remaining);
-	  			std::string fill;
-	  			PrepareRequestString(fill, remaining.GetStorage());
-	  			Ptr<Packet> p = CreatePacket(fill);
+	  			Ptr<Packet> p = CreateRequestPacket(remaining.GetStorage());
 	  			Send(p);
 	  		}
 	  		else
@@ -492,8 +510,7 @@ ConsumerProducerVm::HandlePeerClose (Ptr<Socket> socket)
 	  			m_done = true;
 	  			CloseTransmittingSocket();
 	  			CreateTransmittingSocket();
-	  			std::string fill = "Done";
-	  			Ptr<Packet> p = CreatePacket(fill);
+	  			Ptr<Packet> p = CreateControlPacket(VmControlHeader::DONE, 0);
 	  			Send(p);
 	  		}
 	  	}
@@ -85,6 +85,10 @@ protected:
 	 *
 	 */
 	virtual void BeginTransmission();
+	/**
+	 * \brief Begins transmission of results once the data is processed
+	 */
+	virtual void ProcessingCompleted();
 	/**
 	 * \brief Create the sockets required for successful data exchange
 	 *
@@ -111,15 +115,14 @@ private:
 	virtual void StartApplication (void);
 	virtual void StopApplication (void);
 	/**
-	 * \brief Prepares the request string
+	 * \brief Creates the packet requesting data
 	 *
-	 * The request string is of a specific format
-	 * RD: xx | R: xx
-	 * * RD is Required Data
-	 * * R is transmission rate at which the VM can receive data
+	 * A client requests the data from server along with the rate at
+	 * which the VM can receive data, a consumer requests it from producer.
 	 *
+	 * \param dataSize The required data in bytes
 	 */
-	void PrepareRequestString(std::string& fill, uint64_t dataSize);
+	Ptr<Packet> CreateRequestPacket(uint64_t dataSize);
 	/**
 	 * \brief Executes the application of VM
 	 */
@@ -158,6 +161,11 @@ private:
 	 * \param socket the socket on which packet is received
 	 */
 	void HandleRead(Ptr<Socket> socket);
+	/**
+	 * \brief Callback to handle data delivered as a flow
+	 * \param bytes the amount of data delivered
+	 */
+	void HandleFlow(uint64_t bytes);
 	/**
 	* \brief Handle an incoming connection
 	* \param socket the incoming connection socket
@@ -88,7 +88,7 @@ void
 ConsumerVm::ScheduleStop(double delay)
 {
 	NS_LOG_FUNCTION(this);
-	Simulator::Schedule(Seconds(delay), &ConsumerVm::StopApplication, this);
+	m_finishEvent = Simulator::Schedule(Seconds(delay), &ConsumerVm::StopApplication, this);
 }
 
 void
@@ -119,6 +119,23 @@ ConsumerVm::HandleRead(Ptr<Socket> socket)
 
 }
 
+void
+ConsumerVm::HandleFlow(uint64_t bytes)
+{
+	NS_LOG_FUNCTION(this << bytes);
+	if(m_receivedBytes < GetDataSize())
+	{
+		m_receivedBytes = m_receivedBytes + Storage(bytes);
+		NS_LOG_INFO("At time "<< Simulator::Now().GetSeconds() << "s Consumer VM Received flow of : " << bytes
+						<< "Bytes, total received " << m_receivedBytes);
+		if(!(m_receivedBytes < GetDataSize()))
+		{
+			m_done = true;
+			ExecuteOperation();
+		}
+	}
+}
+
 void
 ConsumerVm::CreateListeningSocket()
 {
@@ -183,13 +200,20 @@ ConsumerVm::StartApplication()
 
 	if(ReserveResources() && GetCompNode()->ReserveNicRate(GetVmTransmissionRate()))
 	{
+		if(IsFlowLevel())
+		{
+			BindFlowReceiver(MakeCallback(&ConsumerVm::HandleFlow, this));
+			if(m_consumerType == ConsumerVm::CONSUMER_CLIENT)
+			{
+				RequestFlow(GetDataSize().GetStorage());
+			}
+			return;
+		}
 		CreateSocket();
 		if(m_consumerType == ConsumerVm::CONSUMER_CLIENT)
 		{
 			SetSocketRecvCallBack(MakeCallback(&ConsumerVm::HandleRead, this));
-			std::string fill;
-			PrepareRequestString(fill, GetDataSize().GetStorage());
-			Ptr<Packet> p = CreatePacket(fill);
+			Ptr<Packet> p = CreateRequestPacket(GetDataSize().GetStorage());
 			Send(p);
 		}
 		else if(m_consumerType == ConsumerVm::CONSUMER_CONSUMER)
@@ -222,21 +246,15 @@ ConsumerVm::StopApplication()
 
 }
 
-void
-ConsumerVm::PrepareRequestString(std::string& fill, uint64_t dataSize)
+Ptr<Packet>
+ConsumerVm::CreateRequestPacket(uint64_t dataSize)
 {
-//	std::string fill =  "Required Data: " << this->GetDataSize().GetStorage() << " Rate: " << this->GetVmTransmissionRate().GetBitRate();
-	fill = "RD: ";
-	std::ostringstream o;
-	o << dataSize;
-	fill += o.str();
+	NS_LOG_FUNCTION(this << dataSize);
 	if(m_consumerType == ConsumerVm::CONSUMER_CLIENT)
 	{
-		o.str("");
-		fill += "| R: ";
-		o << this->GetVmTransmissionRate().GetBitRate();
-		fill += o.str();
+		return CreateControlPacket(VmControlHeader::REQUEST, dataSize);
 	}
+	return CreateControlPacket(VmControlHeader::RETRANSMIT, dataSize);
 }
 
 
@@ -247,8 +265,7 @@ ConsumerVm::ExecuteOperation()
 	NS_LOG_FUNCTION(this);
 	CloseSocket();
 	double dataFetch = CalculateDataFetchTime();
-	double executionTime = this->CalculateProcessingTime();
-	ScheduleStop((dataFetch + executionTime));
+	ScheduleProcessing(dataFetch);
 }
 
 void
@@ -269,9 +286,7 @@ ConsumerVm::HandleServerClose(Ptr<Socket> socket)
 
 			Storage remaining = GetDataSize() - m_receivedBytes;
 			NS_LOG_INFO("Server close Remaining: " << remaining);
-			std::string fill;
-			PrepareRequestString(fill, remaining.GetStorage());
-			Ptr<Packet> p = CreatePacket(fill);
+			Ptr<Packet> p = CreateRequestPacket(remaining.GetStorage());
 			Send(p);
 		}
 	}
@@ -307,9 +322,7 @@ ConsumerVm::HandleProducerClose(Ptr<Socket> socket)
 
 			Storage remaining = GetDataSize() - m_receivedBytes;
 			NS_LOG_WARN("Producer close Remaining: " << remaining);
-			std::string fill;
-			PrepareRequestString(fill, remaining.GetStorage());
-			Ptr<Packet> p = CreatePacket(fill);
+			Ptr<Packet> p = CreateRequestPacket(remaining.GetStorage());
 			Send(p);
 		}
 		else
@@ -317,8 +330,7 @@ ConsumerVm::HandleProducerClose(Ptr<Socket> socket)
 			m_done = true;
 			CloseTransmittingSocket();
 			CreateTransmittingSocket();
-			std::string fill = "Done";
-			Ptr<Packet> p = CreatePacket(fill);
+			Ptr<Packet> p = CreateControlPacket(VmControlHeader::DONE, 0);
 			Send(p);
 		}
 	}
@@ -352,9 +364,7 @@ ConsumerVm::HandlePeerClose (Ptr<Socket> socket)
 			CreateTransmittingSocket();
 			Storage remaining = GetDataSize() - m_receivedBytes;
 			NS_LOG_INFO("ConsumerVM Peer close Remaining: " << remaining);
-			std::string fill;
-			PrepareRequestString(fill, remaining.GetStorage());
-			Ptr<Packet> p = CreatePacket(fill);
+			Ptr<Packet> p = CreateRequestPacket(remaining.GetStorage());
 			Send(p);
 		}
 		else
@@ -362,8 +372,7 @@ ConsumerVm::HandlePeerClose (Ptr<Socket> socket)
 			m_done = true;
 			CloseTransmittingSocket();
 			CreateTransmittingSocket();
-			std::string fill = "Done";
-			Ptr<Packet> p = CreatePacket(fill);
+			Ptr<Packet> p = CreateControlPacket(VmControlHeader::DONE, 0);
 			Send(p);
 		}
 	}
@@ -394,9 +403,7 @@ ConsumerVm::HandlePeerError (Ptr<Socket> socket)
 
   			Storage remaining = GetDataSize() - m_receivedBytes;
   			NS_LOG_INFO("Producer close Remaining: " << remaining);
-  			std::string fill;
-  			PrepareRequestString(fill, remaining.GetStorage());
-  			Ptr<Packet> p = CreatePacket(fill);
+  			Ptr<Packet> p = CreateRequestPacket(remaining.GetStorage());
   			Send(p);
   		}
   		else
@@ -404,8 +411,7 @@ ConsumerVm::HandlePeerError (Ptr<Socket> socket)
   			m_done = true;
   			CloseTransmittingSocket();
   			CreateTransmittingSocket();
-  			std::string fill = "Done";
-  			Ptr<Packet> p = CreatePacket(fill);
+  			Ptr<Packet> p = CreateControlPacket(VmControlHeader::DONE, 0);
   			Send(p);
   		}
   	}
@@ -38,6 +38,7 @@ DatacenterConfig::DatacenterConfig()
 	m_storageServer.numOfServers = 0;
 	m_enableTracing = false;
 	m_vmConfiguration.requireData = false;
+	m_vmConfiguration.transferMode = TRANSFER_PACKET;
 //	m_dataCollector = new NutshellDataCollector();
 }
 
@@ -196,6 +197,18 @@ DatacenterConfig::ConfigureVmNetwork (uint32_t mtu, std::string protocolType,
 }
 
 
+void
+DatacenterConfig::ConfigureVmWorkloadTrace(std::string fileName)
+{
+	m_vmConfiguration.workloadTrace = fileName;
+}
+
+void
+DatacenterConfig::ConfigureTransferMode(TransferMode_e mode)
+{
+	m_vmConfiguration.transferMode = mode;
+}
+
 void
 DatacenterConfig::ConfigureStorageServer(uint32_t numOfServ)
 {
@@ -429,6 +442,18 @@ DatacenterConfig::GetVmProtocolType() const
 	return m_vmConfiguration.tid;
 }
 
+std::string
+DatacenterConfig::GetVmWorkloadTrace() const
+{
+	return m_vmConfiguration.workloadTrace;
+}
+
+DatacenterConfig::TransferMode_e
+DatacenterConfig::GetTransferMode() const
+{
+	return m_vmConfiguration.transferMode;
+}
+
 uint32_t
 DatacenterConfig::GetNumOfStorageServer() const
 {
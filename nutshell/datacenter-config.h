@@ -57,6 +57,13 @@ public:
 	enum Procedure_e {
 		RANDOM
 	};
+	/**
+	 * \brief ENUM to define how VMs and storage servers transfer data
+	 */
+	enum TransferMode_e {
+		TRANSFER_PACKET, //!< Data is sent over sockets, one packet at a time
+		TRANSFER_FLOW //!< Data is sent as flows sharing the links, see FlowNetwork
+	};
 	/**
 	 * \brief Class constructor
 	 */
@@ -212,6 +219,21 @@ public:
 	 */
 	void ConfigureVmNetwork (uint32_t mtu, std::string protocolType,
 								std::string vmTransRate);
+	/**
+	 * \brief Configure VMs to be replayed from a workload trace
+	 *
+	 * When set, the VMs and their arrivals are read from the trace instead
+	 * of being generated from the VM configuration, see VmWorkloadReader
+	 * for the trace formats.
+	 *
+	 * \param fileName The path of trace file, CSV or binary
+	 */
+	void ConfigureVmWorkloadTrace(std::string fileName);
+	/**
+	 * \brief Configure how VMs and storage servers transfer data
+	 * \param mode TRANSFER_PACKET (default) or TRANSFER_FLOW
+	 */
+	void ConfigureTransferMode(TransferMode_e mode);
 	/**
 	 * \brief Configure the number of Storage server
 	 * \param numOfServ Then number of storage server to create.
@@ -425,6 +447,15 @@ public:
 	 */
 	std::string GetVmProtocolType() const;
 
+	/**
+	 * \brief Get the workload trace to replay
+	 * \return The path of trace file, empty if VMs are generated
+	 */
+	std::string GetVmWorkloadTrace() const;
+	/**
+	 * \return The data transfer mode of VMs and storage servers
+	 */
+	TransferMode_e GetTransferMode() const;
 	/**
 	 * \brief Get the number of storage servers
 	 * \return the number of storage server.
@@ -486,6 +517,9 @@ protected:
 		uint32_t			mtu;
 		std::string			vmTransmissionRateMin, vmTransmissionRateMax;
 		std::string			tid;
+		TransferMode_e		transferMode;
+		/* ----------- Trace --------- */
+		std::string			workloadTrace;
 	};
 	/**
 	 * \brief Structure for Storage Server Configuration
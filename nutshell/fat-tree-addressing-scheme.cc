@@ -21,9 +21,9 @@
  *      Author: ubaid
  */
 
-#include <math.h>
-
 #include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/fatal-error.h"
 
 #include "addressing-scheme.h"
 
@@ -32,6 +32,7 @@
 namespace ns3 {
 
 FatTreeAddressingScheme::FatTreeAddressingScheme()
+	: m_pods(0)
 {
 }
 
@@ -44,50 +45,33 @@ FatTreeAddressingScheme::SetPods(uint32_t pods)
 void
 FatTreeAddressingScheme::CreateNetworkAddresses()
 {
-//	uint32_t podsBy2 = m_pods/2;
-
-	for(uint32_t i = 0; i < (m_pods + 1); i++)
+	// k networks in each pod and (k/2)^2 core networks,
+	// every network is a single /30 link
+	uint32_t pb2 = m_pods/2;
+	if(pb2 * pb2 > 256)
 	{
-		uint32_t jrange;
-		if(i < m_pods)
-		{
-			jrange = m_pods;
-		}
-		else
-		{
-			uint32_t pb2 = m_pods/2;
-			jrange = pow(pb2, 2);
-		}
-		for(uint32_t j = 0; j < jrange; j++)
-		{
-			m_oct[1] = i;
-			m_oct[2] = j;
-			m_oct[3] = 0;
-			m_numNet = 1;
-			m_hosts = 4;
-			AddressingScheme::CreateNetworkAddresses();
-			MoveToHolder();
-		}
+		// the core networks are numbered in the third octet, as the routing decodes them
+		NS_FATAL_ERROR("Fat-tree addressing supports at most 32 pods, not " << m_pods);
 	}
-	// assigning generated holder values to
-	// m_networks variable
-	m_networks = m_gIpHolder;
-
+	m_numNet = m_pods * m_pods + pb2 * pb2;
+	m_hosts = 4;
+	m_oct[1] = 0;
+	m_oct[2] = 0;
+	m_oct[3] = 0;
+	m_jumpValues.clear();
+	AddressingScheme::CreateNetworkAddresses();
 }
 
-void
-FatTreeAddressingScheme::MoveToHolder()
+Ipv4Address
+FatTreeAddressingScheme::GetNetworkAddress(uint32_t id) const
 {
-	std::vector< std::string > row;
-	for(uint32_t i = 0; i < m_networks.size(); i++)
-	{
-		row.push_back(m_networks[i][0]);
-		row.push_back(m_networks[i][1]);
-
-		m_gIpHolder.push_back(row);
-		row.clear();
-	}
-
+	NS_ASSERT_MSG(id < m_numNet, "Network " << id << " out of " << m_numNet);
+	// unused.PodNumber.switchnumber.0, the core is pod k
+	uint32_t podNets = m_pods * m_pods;
+	uint32_t pod = id < podNets ? id / m_pods : m_pods;
+	uint32_t sw = id < podNets ? id % m_pods : id - podNets;
+	NS_ASSERT_MSG(pod < 256 && sw < 256, "Network " << id << " does not fit the address octets");
+	return Ipv4Address(m_base | (pod << 16) | (sw << 8));
 }
 
 FatTreeAddressingScheme::~FatTreeAddressingScheme()
@@ -51,6 +51,12 @@ public:
 	 * \brief Creates the network addresses
 	 */
 	virtual void CreateNetworkAddresses();
+	/**
+	 * \brief Computes the network of a pod or core switch
+	 * \param id the index, k per pod in pod order, then the core networks
+	 * \return network address
+	 */
+	virtual Ipv4Address GetNetworkAddress(uint32_t id) const;
 	/**
 	 * \brief Sets the number of pods
 	 * \param pods The number of pods
@@ -59,13 +65,7 @@ public:
 	virtual ~FatTreeAddressingScheme();
 
 private:
-	/**
-	 * \brief Moves generated subnet to list
-	 */
-	void MoveToHolder();
-
 	uint32_t m_pods; //!< The number of pods
-	std::vector< std::vector< std::string > > m_gIpHolder; //!< The list to hold subnets.
 };
 
 } /* namespace ns3 */
@@ -43,6 +43,7 @@ namespace ns3 {
 FatTreeConfig::FatTreeConfig()
 {
 	m_addressing = NULL;
+	m_partitions = 1;
 	m_customRouting = new FatTreeIpv4RoutingProtocolHelper();
 //	m_customRouting = NULL;
 	m_customVmScheduler = new FcfsFirstFitVmScheduler();
@@ -60,6 +61,16 @@ FatTreeConfig::SetPods(uint32_t pods)
 	m_defaultAddressing.SetPods(pods);
 }
 void
+FatTreeConfig::SetPartitions(uint32_t partitions)
+{
+	m_partitions = partitions > 0 ? partitions : 1;
+}
+uint32_t
+FatTreeConfig::GetPartitions() const
+{
+	return m_partitions;
+}
+void
 FatTreeConfig::SetBaseNetwork(std::string netAddr, std::string subnet)
 {
 	m_baseNetowrkAddress = netAddr;
@@ -86,6 +86,17 @@ public:
 	 * \param sch The VM scheduler reference
 	 */
 	void SetVmScheuler(VmScheduler & sch);
+	/**
+	 * \brief Set the number of logical processes the topology is partitioned onto
+	 *
+	 * With more than one partition the pods are split in contiguous blocks,
+	 * one per logical process of ns-3 distributed simulator, and the core
+	 * links are the partition boundary. Each process schedules its share of
+	 * VMs on its own nodes. Requires ns-3 built with MPI.
+	 *
+	 * \param partitions The number of partitions, the MPI size, 1 by default
+	 */
+	void SetPartitions(uint32_t partitions);
 
 	/**
 	 * \brief Get the number of Pods
@@ -117,6 +128,11 @@ public:
 	 * \return The Internet Stack
 	 */
 	InternetStackHelper GetStack() const;
+	/**
+	 * \brief Get the number of partitions
+	 * \return The number of logical processes
+	 */
+	uint32_t GetPartitions() const;
 	/**
 	 * \brief Get the Network Address
 	 * \return The main network IP string
@@ -133,6 +149,7 @@ public:
 private:
 
 	uint32_t m_pods; //!< The number of Pods to create
+	uint32_t m_partitions; //!< The number of logical processes
 
 	std::string m_baseNetowrkAddress; //!< The base network IP address
 	std::string m_baseSubnet; //!< The base network Subnet Mask
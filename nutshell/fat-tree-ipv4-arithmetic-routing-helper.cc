@@ -0,0 +1,62 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * fat-tree-ipv4-arithmetic-routing-helper.cc
+ *
+ *  Created on: Apr 12, 2017
+ *      Author: ubaid
+ *       Email: u.ur.rahman@gmail.com
+ */
+
+#include "ns3/log.h"
+
+#include "fat-tree-ipv4-arithmetic-routing.h"
+
+#include "fat-tree-ipv4-arithmetic-routing-helper.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FatTreeIpv4ArithmeticRoutingHelper");
+
+FatTreeIpv4ArithmeticRoutingHelper::FatTreeIpv4ArithmeticRoutingHelper(uint32_t pods)
+	: m_pods(pods)
+{
+}
+
+FatTreeIpv4ArithmeticRoutingHelper::FatTreeIpv4ArithmeticRoutingHelper(const FatTreeIpv4ArithmeticRoutingHelper & o)
+	: m_pods(o.m_pods)
+{
+}
+FatTreeIpv4ArithmeticRoutingHelper*
+FatTreeIpv4ArithmeticRoutingHelper::Copy (void) const
+{
+	return new FatTreeIpv4ArithmeticRoutingHelper (*this);
+}
+
+Ptr<Ipv4RoutingProtocol>
+FatTreeIpv4ArithmeticRoutingHelper::Create (Ptr<Node> node) const
+{
+	Ptr<FatTreeIpv4ArithmeticRouting> agent = CreateObject<FatTreeIpv4ArithmeticRouting>();
+	agent->SetPods(m_pods);
+	node->AggregateObject(agent);
+	return agent;
+}
+
+FatTreeIpv4ArithmeticRoutingHelper::~FatTreeIpv4ArithmeticRoutingHelper()
+{
+}
+
+} /* namespace ns3 */
@@ -0,0 +1,381 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * fat-tree-ipv4-arithmetic-routing.cc
+ *
+ *  Created on: Apr 12, 2017
+ *      Author: ubaid
+ *       Email: u.ur.rahman@gmail.com
+ */
+
+#include <iomanip>
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/uinteger.h"
+#include "ns3/node.h"
+#include "ns3/net-device.h"
+#include "ns3/simulator.h"
+
+#include "fat-tree-ipv4-arithmetic-routing.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FatTreeIpv4ArithmeticRouting");
+
+NS_OBJECT_ENSURE_REGISTERED (FatTreeIpv4ArithmeticRouting);
+
+TypeId
+FatTreeIpv4ArithmeticRouting::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::FatTreeIpv4ArithmeticRouting")
+    .SetParent<Ipv4RoutingProtocol> ()
+    .AddConstructor<FatTreeIpv4ArithmeticRouting> ()
+    .AddAttribute ("Pods",
+                   "The number of pods (k) of the fat-tree, the (k/2)^2 core"
+                   " networks are numbered in a single octet so k is at most 32",
+                   UintegerValue (4),
+                   MakeUintegerAccessor (&FatTreeIpv4ArithmeticRouting::m_pods),
+                   MakeUintegerChecker<uint32_t> (2, 32))
+  ;
+  return tid;
+}
+
+FatTreeIpv4ArithmeticRouting::FatTreeIpv4ArithmeticRouting ()
+  : m_ipv4 (0),
+    m_pods (4),
+    m_role (ROLE_UNKNOWN),
+    m_pod (0),
+    m_index (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+FatTreeIpv4ArithmeticRouting::~FatTreeIpv4ArithmeticRouting ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+FatTreeIpv4ArithmeticRouting::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_ipv4 = 0;
+  m_up.clear ();
+  m_down.clear ();
+  Ipv4RoutingProtocol::DoDispose ();
+}
+
+void
+FatTreeIpv4ArithmeticRouting::SetPods (uint32_t pods)
+{
+  if (pods < 2 || pods > 32)
+    {
+      // the core network index is one octet, (k/2)^2 must fit in 256
+      NS_FATAL_ERROR ("Arithmetic fat-tree routing supports 2 to 32 pods, not " << pods);
+    }
+  m_pods = pods;
+  m_role = ROLE_UNKNOWN;
+}
+
+void
+FatTreeIpv4ArithmeticRouting::Classify (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t half = m_pods / 2;
+  m_up.assign (half, -1);
+  m_down.assign (m_pods, -1);
+  m_role = ROLE_UNKNOWN;
+
+  for (uint32_t i = 0; i < m_ipv4->GetNInterfaces (); i++)
+    {
+      if (m_ipv4->GetNAddresses (i) == 0)
+        {
+          continue;
+        }
+      Ipv4Address local = m_ipv4->GetAddress (i, 0).GetLocal ();
+      if (local.IsLocalhost ())
+        {
+          continue;
+        }
+      uint32_t a = local.Get ();
+      uint32_t pod = (a >> 16) & 0xff;
+      uint32_t net = (a >> 8) & 0xff;
+      uint32_t port = (a & 0xff) / 4;
+      bool lower = (a & 0x3) == 1;
+
+      if (pod == m_pods)
+        {
+          // core link, the aggregate switch is the lower end
+          if (lower)
+            {
+              m_role = ROLE_AGGREGATE;
+              m_index = net / half;
+              m_up[net % half] = i;
+            }
+          else
+            {
+              m_role = ROLE_CORE;
+              m_index = net;
+              m_down[port] = i;
+            }
+        }
+      else if (pod < m_pods && net < half)
+        {
+          // access network, the host is the lower end
+          m_pod = pod;
+          m_index = net;
+          if (lower)
+            {
+              m_role = ROLE_HOST;
+              m_up[0] = i;
+            }
+          else
+            {
+              m_role = ROLE_EDGE;
+              m_down[port] = i;
+            }
+        }
+      else if (pod < m_pods && net < half + half)
+        {
+          // aggregate to edge link, the edge switch is the lower end
+          m_pod = pod;
+          if (lower)
+            {
+              m_role = ROLE_EDGE;
+              m_index = port;
+              m_up[net - half] = i;
+            }
+          else
+            {
+              m_role = ROLE_AGGREGATE;
+              m_index = net - half;
+              m_down[port] = i;
+            }
+        }
+    }
+  NS_LOG_LOGIC ("Role " << m_role << " pod " << m_pod << " index " << m_index);
+}
+
+int32_t
+FatTreeIpv4ArithmeticRouting::Lookup (Ipv4Address dest)
+{
+  if (m_role == ROLE_UNKNOWN)
+    {
+      Classify ();
+    }
+  uint32_t half = m_pods / 2;
+  uint32_t a = dest.Get ();
+  uint32_t pod = (a >> 16) & 0xff;
+  uint32_t net = (a >> 8) & 0xff;
+  uint32_t port = (a & 0xff) / 4;
+  // the same destination always takes the same uplink,
+  // neighbouring destinations take different ones
+  uint32_t spread = net + port;
+
+  if (pod > m_pods || (pod < m_pods && (net >= half + half || port >= half))
+      || (pod == m_pods && (net >= half * half || port >= m_pods)))
+    {
+      NS_LOG_LOGIC (dest << " is not a fat-tree address");
+      return -1;
+    }
+
+  switch (m_role)
+    {
+    case ROLE_HOST:
+      return m_up[0];
+
+    case ROLE_EDGE:
+      if (pod == m_pods)
+        {
+          // core link, go to the aggregate switch connected to that core
+          return m_up[net / half];
+        }
+      if (pod != m_pod)
+        {
+          return m_up[(spread + m_index) % half];
+        }
+      if (net < half)
+        {
+          return net == m_index ? m_down[port] : m_up[(spread + m_index) % half];
+        }
+      return m_up[net - half];
+
+    case ROLE_AGGREGATE:
+      if (pod == m_pods)
+        {
+          if (net / half == m_index)
+            {
+              return m_up[net % half];
+            }
+          // reach the right aggregate switch of the pod through an edge switch
+          return port == m_pod ? m_down[0] : m_up[(spread + m_index) % half];
+        }
+      if (pod != m_pod)
+        {
+          return m_up[(spread + m_index) % half];
+        }
+      return net < half ? m_down[net] : m_down[port];
+
+    case ROLE_CORE:
+      return pod == m_pods ? m_down[port] : m_down[pod];
+
+    default:
+      return -1;
+    }
+}
+
+Ptr<Ipv4Route>
+FatTreeIpv4ArithmeticRouting::MakeRoute (Ipv4Address dest, int32_t interface) const
+{
+  Ipv4Address local = m_ipv4->GetAddress (interface, 0).GetLocal ();
+  // the two ends of a /30 link are .1 and .2
+  uint32_t a = local.Get ();
+  Ipv4Address gateway ((a & 0x3) == 1 ? a + 1 : a - 1);
+
+  Ptr<Ipv4Route> rtentry = Create<Ipv4Route> ();
+  rtentry->SetDestination (dest);
+  rtentry->SetSource (local);
+  rtentry->SetGateway (gateway);
+  rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interface));
+  return rtentry;
+}
+
+Ptr<Ipv4Route>
+FatTreeIpv4ArithmeticRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice> oif, Socket::SocketErrno &sockerr)
+{
+  NS_LOG_FUNCTION (this << p << &header << oif << &sockerr);
+  Ipv4Address dest = header.GetDestination ();
+
+  if (dest.IsMulticast ())
+    {
+      NS_LOG_LOGIC ("Multicast destination-- returning false");
+      sockerr = Socket::ERROR_NOROUTETOHOST;
+      return 0;
+    }
+  int32_t interface = Lookup (dest);
+  if (interface < 0 || (oif != 0 && m_ipv4->GetNetDevice (interface) != oif))
+    {
+      NS_LOG_LOGIC ("No route to " << dest);
+      sockerr = Socket::ERROR_NOROUTETOHOST;
+      return 0;
+    }
+  sockerr = Socket::ERROR_NOTERROR;
+  return MakeRoute (dest, interface);
+}
+
+bool
+FatTreeIpv4ArithmeticRouting::RouteInput  (Ptr<const Packet> p, const Ipv4Header &header, Ptr<const NetDevice> idev,
+                                           UnicastForwardCallback ucb, MulticastForwardCallback mcb,
+                                           LocalDeliverCallback lcb, ErrorCallback ecb)
+{
+  NS_LOG_FUNCTION (this << p << header << header.GetSource () << header.GetDestination () << idev << &lcb << &ecb);
+  NS_ASSERT (m_ipv4->GetInterfaceForDevice (idev) >= 0);
+  uint32_t iif = m_ipv4->GetInterfaceForDevice (idev);
+  Ipv4Address dest = header.GetDestination ();
+
+  if (dest.IsMulticast ())
+    {
+      NS_LOG_LOGIC ("Multicast destination-- returning false");
+      return false; // Let other routing protocols try to handle this
+    }
+
+  for (uint32_t j = 0; j < m_ipv4->GetNInterfaces (); j++)
+    {
+      for (uint32_t i = 0; i < m_ipv4->GetNAddresses (j); i++)
+        {
+          Ipv4InterfaceAddress iaddr = m_ipv4->GetAddress (j, i);
+          if (iaddr.GetLocal ().IsEqual (dest) || dest.IsEqual (iaddr.GetBroadcast ()))
+            {
+              NS_LOG_LOGIC ("For me (destination " << dest << " match)");
+              lcb (p, header, iif);
+              return true;
+            }
+        }
+    }
+  if (m_ipv4->IsForwarding (iif) == false)
+    {
+      NS_LOG_LOGIC ("Forwarding disabled for this interface");
+      ecb (p, header, Socket::ERROR_NOROUTETOHOST);
+      return false;
+    }
+  int32_t interface = Lookup (dest);
+  if (interface < 0)
+    {
+      NS_LOG_LOGIC ("Did not find unicast destination- returning false");
+      return false; // Let other routing protocols try to handle this
+    }
+  ucb (MakeRoute (dest, interface), p, header);
+  return true;
+}
+
+void
+FatTreeIpv4ArithmeticRouting::NotifyInterfaceUp (uint32_t interface)
+{
+  NS_LOG_FUNCTION (this << interface);
+  m_role = ROLE_UNKNOWN;
+}
+
+void
+FatTreeIpv4ArithmeticRouting::NotifyInterfaceDown (uint32_t interface)
+{
+  NS_LOG_FUNCTION (this << interface);
+  m_role = ROLE_UNKNOWN;
+}
+
+void
+FatTreeIpv4ArithmeticRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address)
+{
+  NS_LOG_FUNCTION (this << interface << address);
+  m_role = ROLE_UNKNOWN;
+}
+
+void
+FatTreeIpv4ArithmeticRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address)
+{
+  NS_LOG_FUNCTION (this << interface << address);
+  m_role = ROLE_UNKNOWN;
+}
+
+void
+FatTreeIpv4ArithmeticRouting::SetIpv4 (Ptr<Ipv4> ipv4)
+{
+  NS_LOG_FUNCTION (this << ipv4);
+  NS_ASSERT (m_ipv4 == 0 && ipv4 != 0);
+  m_ipv4 = ipv4;
+  m_role = ROLE_UNKNOWN;
+}
+
+void
+FatTreeIpv4ArithmeticRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const
+{
+  std::ostream* os = stream->GetStream ();
+  *os << "Node: " << m_ipv4->GetObject<Node> ()->GetId ()
+      << ", Time: " << Now ().As (Time::S)
+      << ", FatTreeIpv4ArithmeticRouting table" << std::endl;
+  *os << "Role " << m_role << ", pod " << m_pod << ", index " << m_index << std::endl;
+  *os << "Direction Port  Interface" << std::endl;
+  for (uint32_t i = 0; i < m_up.size (); i++)
+    {
+      *os << "up        " << std::setw (5) << std::left << i << " " << m_up[i] << std::endl;
+    }
+  for (uint32_t i = 0; i < m_down.size (); i++)
+    {
+      *os << "down      " << std::setw (5) << std::left << i << " " << m_down[i] << std::endl;
+    }
+  *os << std::endl;
+}
+
+} /* namespace ns3 */
@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * fat-tree-ipv4-arithmetic-routing.h
+ *
+ *  Created on: Apr 12, 2017
+ *      Author: ubaid
+ *       Email: u.ur.rahman@gmail.com
+ */
+
+#ifndef FAT_TREE_IPV4_ARITHMETIC_ROUTING_H
+#define FAT_TREE_IPV4_ARITHMETIC_ROUTING_H
+
+#include <vector>
+#include <stdint.h>
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ptr.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv4-routing-protocol.h"
+#include "ns3/ipv4-route.h"
+
+namespace ns3 {
+
+/**
+ * \brief Fat-tree routing without forwarding tables
+ *
+ * The next hop is computed from the destination address alone, using the
+ * layout of FatTreeAddressingScheme: the second octet is the pod (the pod
+ * count for core links), the third octet is the access network or the
+ * aggregate switch of the link and the fourth octet is 4 x port + 1 for
+ * the lower end and 4 x port + 2 for the upper end of each /30 link.
+ * The role of the node and its ports are taken from the addresses of its
+ * own interfaces, so a node keeps at most k interface indexes and nothing
+ * per destination. Upward traffic is spread over the uplinks by the
+ * destination port, as in the two level tables of the fat-tree paper.
+ */
+class FatTreeIpv4ArithmeticRouting: public Ipv4RoutingProtocol {
+public:
+
+	/**
+	* \brief Get the type ID.
+	* \return the object TypeId
+	*/
+	static TypeId GetTypeId (void);
+
+	FatTreeIpv4ArithmeticRouting();
+	virtual ~FatTreeIpv4ArithmeticRouting();
+
+	// These methods inherited from base class
+	virtual Ptr<Ipv4Route> RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice> oif, Socket::SocketErrno &sockerr);
+
+	virtual bool RouteInput  (Ptr<const Packet> p, const Ipv4Header &header, Ptr<const NetDevice> idev,
+							UnicastForwardCallback ucb, MulticastForwardCallback mcb,
+							LocalDeliverCallback lcb, ErrorCallback ecb);
+	virtual void NotifyInterfaceUp (uint32_t interface);
+	virtual void NotifyInterfaceDown (uint32_t interface);
+	virtual void NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address);
+	virtual void NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address);
+	virtual void SetIpv4 (Ptr<Ipv4> ipv4);
+	virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const;
+
+	/**
+	* \brief Set the number of pods of the fat-tree
+	* \param pods the k of the fat-tree, 2 to 32 as the core networks are numbered in one octet
+	*/
+	void SetPods (uint32_t pods);
+
+protected:
+	virtual void DoDispose (void);
+
+private:
+	/**
+	 * \brief Position of the node in the fat-tree
+	 */
+	enum Role_e {
+		ROLE_UNKNOWN,
+		ROLE_HOST,
+		ROLE_EDGE,
+		ROLE_AGGREGATE,
+		ROLE_CORE
+	};
+
+	/**
+	* \brief Derives the role and the ports of the node from its interface
+	* addresses
+	*/
+	void Classify (void);
+
+	/**
+	* \brief Computes the outgoing interface towards a destination
+	* \param dest the destination address
+	* \return the interface index, or -1 if the destination is not in the fat-tree
+	*/
+	int32_t Lookup (Ipv4Address dest);
+
+	/**
+	* \brief Builds the route over an interface
+	* \param dest the destination address
+	* \param interface the outgoing interface
+	* \return the route, the gateway is the other end of the /30 link
+	*/
+	Ptr<Ipv4Route> MakeRoute (Ipv4Address dest, int32_t interface) const;
+
+	Ptr<Ipv4> m_ipv4; //!< IPv4 of the node
+	uint32_t m_pods; //!< k of the fat-tree
+	Role_e m_role; //!< Role of the node, derived lazily
+	uint32_t m_pod; //!< Pod of the node, unused for core switches
+	uint32_t m_index; //!< Edge index of a host or edge switch, aggregate index or core index
+	std::vector<int32_t> m_up; //!< Interface of each uplink
+	std::vector<int32_t> m_down; //!< Interface of each downlink
+};
+
+} /* namespace ns3 */
+
+#endif /* FAT_TREE_IPV4_ARITHMETIC_ROUTING_H */
@@ -0,0 +1,202 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *
+ * fat-tree-ipv4-fib.cc
+ *
+ *  Created on: Mar 24, 2017
+ *      Author: ubaid
+ *       Email: u.ur.rahman@gmail.com
+ */
+
+#include <algorithm>
+
+#include "ns3/ipv4-routing-table-entry.h"
+
+#include "fat-tree-ipv4-fib.h"
+
+namespace ns3 {
+
+bool
+FatTreeIpv4Fib::Suffix_s::operator < (const Suffix_s & other) const
+{
+	if(network != other.network)
+	{
+		return network < other.network;
+	}
+	return order < other.order;
+}
+
+FatTreeIpv4Fib::FatTreeIpv4Fib()
+{
+	Clear();
+}
+
+FatTreeIpv4Fib::~FatTreeIpv4Fib()
+{
+}
+
+void
+FatTreeIpv4Fib::Clear()
+{
+	m_trie.clear();
+	m_suffixes.clear();
+	m_nPrefixRoutes = 0;
+	TrieNode_s root;
+	root.child[0] = 0;
+	root.child[1] = 0;
+	m_trie.push_back(root);
+}
+
+void
+FatTreeIpv4Fib::AddPrefixRoute(Ipv4RoutingTableEntry * route, uint8_t prefixLen)
+{
+	uint32_t network = route->GetDestNetwork().Get();
+	uint32_t node = 0;
+	for(uint8_t depth = 0; depth < prefixLen && depth < 32; depth++)
+	{
+		uint32_t bit = (network >> (31 - depth)) & 1;
+		if(m_trie[node].child[bit] == 0)
+		{
+			TrieNode_s n;
+			n.child[0] = 0;
+			n.child[1] = 0;
+			m_trie.push_back(n);
+			m_trie[node].child[bit] = m_trie.size() - 1;
+		}
+		node = m_trie[node].child[bit];
+	}
+	m_trie[node].routes.push_back(route);
+	m_trie[node].orders.push_back(m_nPrefixRoutes++);
+}
+
+void
+FatTreeIpv4Fib::AddSuffixRoute(Ipv4RoutingTableEntry * route)
+{
+	Suffix_s s;
+	s.network = route->GetDestNetwork().Get();
+	s.order = m_suffixes.size();
+	s.route = route;
+	m_suffixes.push_back(s);
+}
+
+void
+FatTreeIpv4Fib::Finalize()
+{
+	std::sort(m_suffixes.begin(), m_suffixes.end());
+}
+
+Ipv4RoutingTableEntry *
+FatTreeIpv4Fib::LookupPrefix(Ipv4Address dest, int32_t iface) const
+{
+	uint32_t addr = dest.Get();
+	uint32_t matches[33];
+	uint32_t nMatches = 0;
+	uint32_t node = 0;
+
+	if(!m_trie[0].routes.empty())
+	{
+		matches[nMatches++] = 0;
+	}
+	for(uint8_t depth = 0; depth < 32; depth++)
+	{
+		node = m_trie[node].child[(addr >> (31 - depth)) & 1];
+		if(node == 0)
+		{
+			break;
+		}
+		if(!m_trie[node].routes.empty())
+		{
+			matches[nMatches++] = node;
+		}
+	}
+
+	// every matching route is a candidate, the closest network wins
+	Ipv4RoutingTableEntry * best = 0;
+	uint32_t bestDiff = 0;
+	uint32_t bestOrder = 0;
+	for(uint32_t m = 0; m < nMatches; m++)
+	{
+		const TrieNode_s & n = m_trie[matches[m]];
+		for(uint32_t i = 0; i < n.routes.size(); i++)
+		{
+			if(iface >= 0 && n.routes[i]->GetInterface() != static_cast<uint32_t>(iface))
+			{
+				continue;
+			}
+			uint32_t network = n.routes[i]->GetDestNetwork().Get();
+			uint32_t diff = addr > network ? addr - network : network - addr;
+			if(best == 0 || diff < bestDiff || (diff == bestDiff && n.orders[i] < bestOrder))
+			{
+				best = n.routes[i];
+				bestDiff = diff;
+				bestOrder = n.orders[i];
+			}
+		}
+	}
+	return best;
+}
+
+Ipv4RoutingTableEntry *
+FatTreeIpv4Fib::LookupSuffix(Ipv4Address dest) const
+{
+	if(m_suffixes.empty())
+	{
+		return 0;
+	}
+	Suffix_s key;
+	key.network = dest.Get();
+	key.order = UINT32_MAX;
+	key.route = 0;
+
+	// the first route above the destination, its run starts at it
+	std::vector<Suffix_s>::const_iterator above = std::upper_bound(m_suffixes.begin(), m_suffixes.end(), key);
+	if(above == m_suffixes.begin())
+	{
+		return above->route;
+	}
+
+	// the first route of the run at or below the destination
+	key.network = (above - 1)->network;
+	key.order = 0;
+	std::vector<Suffix_s>::const_iterator below = std::lower_bound(m_suffixes.begin(), above, key);
+	if(above == m_suffixes.end())
+	{
+		return below->route;
+	}
+
+	uint32_t belowDiff = dest.Get() - below->network;
+	uint32_t aboveDiff = above->network - dest.Get();
+	if(aboveDiff < belowDiff || (aboveDiff == belowDiff && above->order < below->order))
+	{
+		return above->route;
+	}
+	return below->route;
+}
+
+uint32_t
+FatTreeIpv4Fib::GetNSuffixRoutes() const
+{
+	return m_suffixes.size();
+}
+
+Ipv4RoutingTableEntry *
+FatTreeIpv4Fib::GetSuffixRoute(uint32_t i) const
+{
+	return m_suffixes[i].route;
+}
+
+} /* namespace ns3 */
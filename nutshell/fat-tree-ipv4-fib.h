@@ -0,0 +1,135 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *
+ * fat-tree-ipv4-fib.h
+ *
+ *  Created on: Mar 24, 2017
+ *      Author: ubaid
+ *       Email: u.ur.rahman@gmail.com
+ */
+
+#ifndef NUTSHELL_FAT_TREE_IPV4_FIB_H
+#define NUTSHELL_FAT_TREE_IPV4_FIB_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "ns3/ipv4-address.h"
+
+namespace ns3 {
+
+class Ipv4RoutingTableEntry;
+
+/**
+ * \brief The compiled forwarding table of fat-tree routing
+ *
+ * The prefix routes are kept in a binary trie, a lookup walks at most
+ * 32 levels. Of the routes on the way whose prefix matches, whatever its
+ * length, the one with network numerically closest to the destination
+ * is taken, as FindCloseMatch did over the matching routes. On core
+ * switches every route of a pod is under its /16, so the choice among
+ * them is by closeness rather than insertion order. The suffix routes
+ * are kept sorted by their network, a lookup binary searches the route
+ * numerically closest to the destination. Both give the same answer as
+ * scanning the route lists, ties going to the route added first, and
+ * allocate nothing per lookup.
+ *
+ * The table holds pointers to the routes of the routing protocol and is
+ * rebuilt by it whenever the routes change.
+ */
+class FatTreeIpv4Fib {
+public:
+	FatTreeIpv4Fib();
+	virtual ~FatTreeIpv4Fib();
+
+	/**
+	 * \brief Removes all routes
+	 */
+	void Clear();
+
+	/**
+	 * \brief Adds a route to the prefix trie
+	 * \param route The route
+	 * \param prefixLen The prefix length matched against destination
+	 */
+	void AddPrefixRoute(Ipv4RoutingTableEntry * route, uint8_t prefixLen);
+
+	/**
+	 * \brief Adds a route to the suffix table
+	 * \param route The route
+	 */
+	void AddSuffixRoute(Ipv4RoutingTableEntry * route);
+
+	/**
+	 * \brief Sorts the suffix table, called after the routes are added
+	 */
+	void Finalize();
+
+	/**
+	 * \brief The matching prefix route with network closest to the destination
+	 * \param dest The destination address
+	 * \param iface The interface the route must use, -1 for any
+	 * \return The route, 0 if no prefix matches
+	 */
+	Ipv4RoutingTableEntry * LookupPrefix(Ipv4Address dest, int32_t iface) const;
+
+	/**
+	 * \brief The suffix route with network closest to the destination
+	 * \param dest The destination address
+	 * \return The route, 0 if there is no suffix route
+	 */
+	Ipv4RoutingTableEntry * LookupSuffix(Ipv4Address dest) const;
+
+	/**
+	 * \return The number of suffix routes, i.e. the uplinks of switch
+	 */
+	uint32_t GetNSuffixRoutes() const;
+
+	/**
+	 * \brief Get a suffix route, the routes are ordered by their network
+	 * \param i The index of route
+	 * \return The route
+	 */
+	Ipv4RoutingTableEntry * GetSuffixRoute(uint32_t i) const;
+
+private:
+	/**
+	 * \brief A node of prefix trie
+	 */
+	struct TrieNode_s {
+		uint32_t child[2]; //!< The index of children, 0 if none
+		std::vector<Ipv4RoutingTableEntry *> routes; //!< The routes of prefix, in order added
+		std::vector<uint32_t> orders; //!< The position of each route among the prefix routes
+	};
+	/**
+	 * \brief An entry of suffix table
+	 */
+	struct Suffix_s {
+		uint32_t network; //!< The destination network of route
+		uint32_t order; //!< The position of route in the suffix list
+		Ipv4RoutingTableEntry * route;
+		bool operator < (const Suffix_s & other) const;
+	};
+
+	std::vector<TrieNode_s> m_trie; //!< The prefix trie, the root is at 0
+	std::vector<Suffix_s> m_suffixes; //!< The suffix routes sorted by network
+	uint32_t m_nPrefixRoutes; //!< The number of prefix routes added
+};
+
+} /* namespace ns3 */
+
+#endif /* NUTSHELL_FAT_TREE_IPV4_FIB_H */
@@ -26,6 +26,8 @@
 #include <iomanip>
 #include <string>
 #include <algorithm>
+#include <cstring>
+#include <cmath>
 #include "ns3/names.h"
 #include "ns3/log.h"
 #include "ns3/abort.h"
@@ -42,6 +44,9 @@
 #include "ns3/node.h"
 #include "ns3/ipv4-packet-info-tag.h"
 #include "ns3/udp-header.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/nstime.h"
+#include "ns3/hash.h"
 
 #include "fat-tree-ipv4-routing-protocol.h"
 #include "fat-tree-ipv4-rte.h"
@@ -59,11 +64,45 @@ FatTreeIpv4RoutingProtocol::GetTypeId (void)
   static TypeId tid = TypeId ("ns3::FatTreeIpv4RoutingProtocol")
     .SetParent<Ipv4RoutingProtocol> ()
     .AddConstructor<FatTreeIpv4RoutingProtocol>()
+    .AddAttribute ("FlowHashEcmp",
+                   "Spread the forwarded flows over the equal cost uplinks by the hash of their 5-tuple"
+                   " instead of taking the uplink closest to the destination",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&FatTreeIpv4RoutingProtocol::m_flowHashEcmp),
+                   MakeBooleanChecker ())
+    .AddAttribute ("FlowletTimeout",
+                   "With flow hash ECMP, the idle time after which the next packets of a flow"
+                   " start a flowlet on the least loaded uplink, zero disables flowlets",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&FatTreeIpv4RoutingProtocol::m_flowletTimeout),
+                   MakeTimeChecker ())
+    .AddAttribute ("LoadDecay",
+                   "The time constant of the exponentially decayed uplink load,"
+                   " the least loaded uplink of a new flowlet is chosen by the recent load",
+                   TimeValue (MilliSeconds (1)),
+                   MakeTimeAccessor (&FatTreeIpv4RoutingProtocol::m_loadDecay),
+                   MakeTimeChecker ())
+    .AddTraceSource ("UplinkForward",
+                     "A packet has been forwarded on an uplink, with the interface of uplink",
+                     MakeTraceSourceAccessor (&FatTreeIpv4RoutingProtocol::m_uplinkForwardTrace))
+    .AddTraceSource ("RouteCacheHits",
+                     "The number of route lookups answered by the route cache",
+                     MakeTraceSourceAccessor (&FatTreeIpv4RoutingProtocol::m_cacheHits))
+    .AddTraceSource ("RouteCacheMisses",
+                     "The number of route lookups done on the forwarding table",
+                     MakeTraceSourceAccessor (&FatTreeIpv4RoutingProtocol::m_cacheMisses))
     ;
   return tid;
 }
 
 FatTreeIpv4RoutingProtocol::FatTreeIpv4RoutingProtocol()
+	: m_fibValid(false),
+	  m_cacheHits(0),
+	  m_cacheMisses(0),
+	  m_flowHashEcmp(false),
+	  m_flowletTimeout(Seconds(0)),
+	  m_loadDecay(MilliSeconds(1)),
+	  m_nodeId(0)
 {
 	NS_LOG_FUNCTION(this);
 }
@@ -82,6 +121,8 @@ FatTreeIpv4RoutingProtocol::DoInitialize()
 	m_isCoreSw = false;
 
 	FindSwitchIndex();
+	InvalidateRoutes();
+	m_nodeId = GetObject<Node> ()->GetId ();
 
 	// looping through all ipv4 interfaces of node
 	for(uint32_t i = 0; i < m_ipv4->GetNInterfaces(); i++)
@@ -139,6 +180,7 @@ FatTreeIpv4RoutingProtocol::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (route);
+  InvalidateRoutes ();
 }
 
 void
@@ -152,6 +194,7 @@ FatTreeIpv4RoutingProtocol::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (route);
+  InvalidateRoutes ();
 }
 
 void
@@ -167,6 +210,7 @@ FatTreeIpv4RoutingProtocol::AddSuffixNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_suffixRoutes.push_back (route);
+  InvalidateRoutes ();
 }
 
 void
@@ -180,6 +224,156 @@ FatTreeIpv4RoutingProtocol::AddSuffixNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_suffixRoutes.push_back (route);
+  InvalidateRoutes ();
+}
+
+void
+FatTreeIpv4RoutingProtocol::InvalidateRoutes (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_fibValid = false;
+  m_routeCache.clear ();
+  m_uplinkRoutes.clear ();
+  m_flowlets.clear ();
+}
+
+void
+FatTreeIpv4RoutingProtocol::BuildFib (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_fib.Clear ();
+  for (NetworkRoutesCI i = m_networkRoutes.begin ();
+       i != m_networkRoutes.end (); i++)
+    {
+      // core switches match every route on its pod, i.e. the /16 prefix
+      uint8_t prefixLen = m_isCoreSw ? 16 : (*i)->GetDestNetworkMask ().GetPrefixLength ();
+      m_fib.AddPrefixRoute (*i, prefixLen);
+    }
+  if (!m_isCoreSw)
+    {
+      for (SuffixRoutesCI i = m_suffixRoutes.begin ();
+           i != m_suffixRoutes.end (); i++)
+        {
+          m_fib.AddSuffixRoute (*i);
+        }
+    }
+  m_fib.Finalize ();
+  m_fibValid = true;
+
+  // the uplinks, i.e. the interfaces of suffix routes
+  m_isUplink.assign (m_ipv4->GetNInterfaces (), false);
+  m_uplinkLoad.resize (m_ipv4->GetNInterfaces ());
+  for (uint32_t i = 0; i < m_fib.GetNSuffixRoutes (); i++)
+    {
+      m_isUplink[m_fib.GetSuffixRoute (i)->GetInterface ()] = true;
+    }
+  m_uplinkRoutes.assign (m_fib.GetNSuffixRoutes (), Ptr<Ipv4Route> ());
+}
+
+Ptr<Ipv4Route>
+FatTreeIpv4RoutingProtocol::CreateRoute (Ipv4RoutingTableEntry* route)
+{
+  Ptr<Ipv4Route> rtentry = Create<Ipv4Route> ();
+  rtentry->SetDestination (route->GetDest ());
+  rtentry->SetSource (m_ipv4->GetAddress (route->GetInterface (), 0).GetLocal ());
+  rtentry->SetGateway (route->GetGateway ());
+  rtentry->SetOutputDevice (m_ipv4->GetNetDevice (route->GetInterface ()));
+  return rtentry;
+}
+
+Ptr<Ipv4Route>
+FatTreeIpv4RoutingProtocol::LookupEcmp (Ptr<const Packet> p, const Ipv4Header &header)
+{
+  NS_LOG_FUNCTION (this << p << header);
+  Ipv4Address dest = header.GetDestination ();
+  if (!m_fibValid)
+    {
+      BuildFib ();
+    }
+
+  // the routes down the tree are unique, only the uplinks are of equal cost
+  uint32_t nUplinks = m_fib.GetNSuffixRoutes ();
+  if (nUplinks < 2 || m_fib.LookupPrefix (dest, -1) != 0)
+    {
+      return LookupGlobal (dest);
+    }
+
+  uint32_t hash = FlowHash (p, header);
+  uint32_t index = hash % nUplinks;
+  if (!m_flowletTimeout.IsZero ())
+    {
+      Time now = Simulator::Now ();
+      if (now - m_lastExpiry > m_flowletTimeout)
+        {
+          ExpireFlowlets ();
+        }
+      std::map<uint32_t, Flowlet_s>::iterator it = m_flowlets.find (hash);
+      if (it == m_flowlets.end ())
+        {
+          Flowlet_s flowlet;
+          flowlet.uplink = index;
+          it = m_flowlets.insert (std::make_pair (hash, flowlet)).first;
+        }
+      else if (now - it->second.lastSeen > m_flowletTimeout)
+        {
+          // a gap long enough not to reorder the flow, move it to the least loaded uplink
+          uint32_t least = 0;
+          for (uint32_t i = 1; i < nUplinks; i++)
+            {
+              if (GetRecentLoad (m_fib.GetSuffixRoute (i)->GetInterface ())
+                  < GetRecentLoad (m_fib.GetSuffixRoute (least)->GetInterface ()))
+                {
+                  least = i;
+                }
+            }
+          it->second.uplink = least;
+        }
+      it->second.lastSeen = now;
+      index = it->second.uplink;
+    }
+
+  if (m_uplinkRoutes[index] == 0)
+    {
+      m_uplinkRoutes[index] = CreateRoute (m_fib.GetSuffixRoute (index));
+    }
+  NS_LOG_LOGIC ("Flow hash " << hash << " forwarded on uplink " << index);
+  return m_uplinkRoutes[index];
+}
+
+uint32_t
+FatTreeIpv4RoutingProtocol::FlowHash (Ptr<const Packet> p, const Ipv4Header &header) const
+{
+  // source, destination, protocol, ports and the node, so switches do not polarize
+  uint8_t buf[17];
+  header.GetSource ().Serialize (buf);
+  header.GetDestination ().Serialize (buf + 4);
+  buf[8] = header.GetProtocol ();
+  std::memset (buf + 9, 0, 4);
+  if ((header.GetProtocol () == 6 || header.GetProtocol () == 17)
+      && header.GetFragmentOffset () == 0 && p->GetSize () >= 4)
+    {
+      // TCP and UDP both start with the source and destination ports
+      p->CopyData (buf + 9, 4);
+    }
+  uint32_t node = m_nodeId;
+  std::memcpy (buf + 13, &node, 4);
+  return Hash32 (reinterpret_cast<const char *> (buf), sizeof (buf));
+}
+
+void
+FatTreeIpv4RoutingProtocol::CountUplink (Ptr<const Ipv4Route> route, Ptr<const Packet> p, const Ipv4Header &header)
+{
+  int32_t iface = m_ipv4->GetInterfaceForDevice (route->GetOutputDevice ());
+  if (iface >= 0 && static_cast<uint32_t> (iface) < m_isUplink.size () && m_isUplink[iface])
+    {
+      uint32_t size = p->GetSize () + header.GetSerializedSize ();
+      UplinkLoad_s &load = m_uplinkLoad[iface];
+      load.packets++;
+      load.bytes += size;
+      load.recent = GetRecentLoad (iface) + size;
+      load.updated = Simulator::Now ();
+      m_uplinkForwardTrace (iface, p);
+    }
 }
 
 Ptr<Ipv4Route>
@@ -189,88 +383,44 @@ FatTreeIpv4RoutingProtocol::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
   NS_LOG_FUNCTION (this << dest << oif);
   NS_LOG_LOGIC ("Looking for route for destination " << dest);
   Ptr<Ipv4Route> rtentry = 0;
-  // store all available routes
-  typedef std::vector<Ipv4RoutingTableEntry*> RouteVec_t;
-  RouteVec_t allRoutes;
 
-  if(m_isCoreSw)
-  {
-	  NS_LOG_INFO("its a core switch");
-	  for (NetworkRoutesI i = m_networkRoutes.begin();
-	  				i != m_networkRoutes.end(); i++)
-		{
-			Ipv4Mask mask("255.255.0.0");
-			Ipv4Address entry = (*i)->GetDestNetwork();
-			if (mask.IsMatch(dest, entry))
-			{
-				if (oif != 0)
-				{
-					if (oif != m_ipv4->GetNetDevice((*i)->GetInterface()))
-					{
-						NS_LOG_LOGIC("Not on requested interface, skipping");
-						continue;
-					}
-				}
-				// found a route
-				allRoutes.push_back(*i);
-			}
-		}
-  }
-  else
-  {
-	  NS_LOG_INFO("No Its not a core switch");
-		for (NetworkRoutesI i = m_networkRoutes.begin();
-				i != m_networkRoutes.end(); i++)
-		{
-			Ipv4Mask mask = (*i)->GetDestNetworkMask();
-			Ipv4Address entry = (*i)->GetDestNetwork();
-			if (mask.IsMatch(dest, entry))
-			{
-				if (oif != 0)
-				{
-					if (oif != m_ipv4->GetNetDevice((*i)->GetInterface()))
-					{
-						NS_LOG_LOGIC("Not on requested interface, skipping");
-						continue;
-					}
-				}
-				// found a route
-				allRoutes.push_back(*i);
-			}
-		}
-
-		if (allRoutes.size() == 0)
-		{
-			NS_LOG_INFO("checking the suffix, suffix size: " << m_suffixRoutes.size());
-			for (SuffixRoutesI i = m_suffixRoutes.begin();
-					i != m_suffixRoutes.end(); i++)
-			{
-				allRoutes.push_back(*i);
-			}
-		}
-	}
-
-  Ipv4RoutingTableEntry* route = 0;
-  if(allRoutes.size() > 0)
-  {
-	  if(allRoutes.size() > 1)
-	  {
-		  route = FindCloseMatch(allRoutes, dest);
-	  }
-	  else
-	  {
-		  route = allRoutes.at(0);
-	  }
+  // the route of a destination only changes with the routes, share it
+  if (oif == 0)
+    {
+      RouteCacheCI cached = m_routeCache.find (dest);
+      if (cached != m_routeCache.end ())
+        {
+          m_cacheHits++;
+          return cached->second;
+        }
+    }
+  m_cacheMisses++;
 
-	rtentry = Create<Ipv4Route>();
+  if (!m_fibValid)
+    {
+      BuildFib ();
+    }
 
-	rtentry->SetDestination (route->GetDest());
+  int32_t iface = -1;
+  if (oif != 0)
+    {
+      iface = m_ipv4->GetInterfaceForDevice (oif);
+      if (iface < 0)
+        {
+          return 0;
+        }
+    }
 
+  // the closest matching prefix, any route of the pod on core switches, else the closest suffix
+  Ipv4RoutingTableEntry* route = m_fib.LookupPrefix (dest, iface);
+  if (route == 0)
+    {
+      route = m_fib.LookupSuffix (dest);
+    }
 
-	rtentry->SetSource (m_ipv4->GetAddress (route->GetInterface (), 0).GetLocal ());
-	rtentry->SetGateway (route->GetGateway ());
-	uint32_t interfaceIdx = route->GetInterface ();
-	rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
+  if(route != 0)
+  {
+	rtentry = CreateRoute (route);
 	NS_LOG_INFO("---------------------------------");
 	NS_LOG_INFO("At Node: "<< this->GetObject<Node> ()->GetId() <<"\nForwarding packet for: \t" << dest
 				  	  	  << "\nTo next hop with dest\t" << route->GetDest()
@@ -278,6 +428,10 @@ FatTreeIpv4RoutingProtocol::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
 						  <<"\nOuput Port: \t\t" << route->GetInterface());
 	NS_LOG_INFO("---------------------------------");
 	NS_LOG_INFO("From lookup " << rtentry);
+	if (oif == 0)
+	{
+		m_routeCache[dest] = rtentry;
+	}
 	return rtentry;
   }
   else
@@ -286,6 +440,62 @@ FatTreeIpv4RoutingProtocol::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
   }
 }
 
+double
+FatTreeIpv4RoutingProtocol::GetRecentLoad (uint32_t iface) const
+{
+  const UplinkLoad_s &load = m_uplinkLoad[iface];
+  if (m_loadDecay.IsZero ())
+    {
+      return load.recent;
+    }
+  double age = (Simulator::Now () - load.updated).GetSeconds ();
+  return load.recent * std::exp (-age / m_loadDecay.GetSeconds ());
+}
+
+void
+FatTreeIpv4RoutingProtocol::ExpireFlowlets (void)
+{
+  // a flow idle that long starts a new flowlet anyway, forget it
+  Time now = Simulator::Now ();
+  std::map<uint32_t, Flowlet_s>::iterator it = m_flowlets.begin ();
+  while (it != m_flowlets.end ())
+    {
+      if (now - it->second.lastSeen > m_flowletTimeout)
+        {
+          m_flowlets.erase (it++);
+        }
+      else
+        {
+          ++it;
+        }
+    }
+  m_lastExpiry = now;
+}
+
+uint64_t
+FatTreeIpv4RoutingProtocol::GetUplinkPackets (uint32_t interface) const
+{
+  return interface < m_uplinkLoad.size () ? m_uplinkLoad[interface].packets : 0;
+}
+
+uint64_t
+FatTreeIpv4RoutingProtocol::GetUplinkBytes (uint32_t interface) const
+{
+  return interface < m_uplinkLoad.size () ? m_uplinkLoad[interface].bytes : 0;
+}
+
+uint64_t
+FatTreeIpv4RoutingProtocol::GetRouteCacheHits (void) const
+{
+  return m_cacheHits;
+}
+
+uint64_t
+FatTreeIpv4RoutingProtocol::GetRouteCacheMisses (void) const
+{
+  return m_cacheMisses;
+}
+
 uint32_t
 FatTreeIpv4RoutingProtocol::GetNRoutes (void) const
 {
@@ -341,6 +551,8 @@ void
 FatTreeIpv4RoutingProtocol::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
+  InvalidateRoutes ();
+  m_fib.Clear ();
   for (NetworkRoutesI j = m_networkRoutes.begin ();
        j != m_networkRoutes.end ();
        j = m_networkRoutes.erase (j))
@@ -504,9 +716,10 @@ FatTreeIpv4RoutingProtocol::RouteInput  (Ptr<const Packet> p, const Ipv4Header &
     }
   // Next, try to find a route
   NS_LOG_LOGIC ("Unicast destination- looking up global route");
-  Ptr<Ipv4Route> rtentry = LookupGlobal (header.GetDestination ());
+  Ptr<Ipv4Route> rtentry = m_flowHashEcmp ? LookupEcmp (p, header) : LookupGlobal (header.GetDestination ());
   if (rtentry != 0)
     {
+      CountUplink (rtentry, p, header);
       NS_LOG_LOGIC ("Found unicast destination- calling unicast callback");
       ucb (rtentry, p, header);
       return true;
@@ -522,6 +735,7 @@ void
 FatTreeIpv4RoutingProtocol::NotifyInterfaceUp (uint32_t i)
 {
   NS_LOG_FUNCTION (this << i);
+  InvalidateRoutes ();
 
 }
 
@@ -529,6 +743,7 @@ void
 FatTreeIpv4RoutingProtocol::NotifyInterfaceDown (uint32_t i)
 {
   NS_LOG_FUNCTION (this << i);
+  InvalidateRoutes ();
 
 }
 
@@ -543,6 +758,7 @@ void
 FatTreeIpv4RoutingProtocol::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
   NS_LOG_FUNCTION (this << interface << address);
+  InvalidateRoutes ();
 
 }
 
@@ -905,33 +1121,6 @@ FatTreeIpv4RoutingProtocol::FindSwitchIndex()
 	}
 }
 
-Ipv4RoutingTableEntry*
-FatTreeIpv4RoutingProtocol::FindCloseMatch(std::vector<Ipv4RoutingTableEntry*> allRoutes, Ipv4Address dest)
-{
-	int32_t diff = INT32_MAX;
-	uint32_t destNo = dest.Get();
-	int index = -1;
-	for(uint32_t i = 0; i < allRoutes.size(); i++)
-	{
-		uint32_t rno = allRoutes.at(i)->GetDestNetwork().Get();
-		int32_t tmpDiff = destNo - rno;
-//		NS_LOG_INFO("Route: " << i << "\n" << "dest: " << allRoutes.at(i)->GetDestNetwork());
-//		NS_LOG_INFO("tmpDiff" << tmpDiff);
-		if(tmpDiff < 0)
-		{
-			tmpDiff = (-1) * tmpDiff;
-		}
-
-		if(tmpDiff < diff)
-		{
-			diff = tmpDiff;
-			index = i;
-		}
-	}
-//	NS_LOG_INFO("Destination Network: " << allRoutes.at(index)->GetDestNetwork() << " Destination Address" << allRoutes.at(index)->GetGateway());
-	return allRoutes.at(index);
-}
-
 Ipv4Address
 FatTreeIpv4RoutingProtocol::CorePodAddress(uint32_t p)
 {
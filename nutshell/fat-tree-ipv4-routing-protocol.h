@@ -26,15 +26,22 @@
 #define FAT_TREE_IPV4_ROUTING_PROTOCOL_H
 
 #include <list>
+#include <map>
+#include <vector>
 #include <stdint.h>
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-header.h"
 #include "ns3/ptr.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/traced-value.h"
+#include "ns3/traced-callback.h"
+#include "ns3/nstime.h"
 
 #include "fat-tree-ipv4-rte.h"
 #include "fat-tree-ipv4-routing-header.h"
+#include "fat-tree-ipv4-fib.h"
 
 
 namespace ns3 {
@@ -164,6 +171,32 @@ public:
 	*/
 	Ipv4RoutingTableEntry *GetRoute (uint32_t i) const;
 
+	/**
+	* \brief Get the packets forwarded on an uplink
+	* \param interface The interface of uplink
+	* \returns the number of packets
+	*/
+	uint64_t GetUplinkPackets (uint32_t interface) const;
+
+	/**
+	* \brief Get the bytes forwarded on an uplink, IP header included
+	* \param interface The interface of uplink
+	* \returns the number of bytes
+	*/
+	uint64_t GetUplinkBytes (uint32_t interface) const;
+
+	/**
+	* \brief Get the number of lookups answered by the route cache
+	* \returns the number of cache hits
+	*/
+	uint64_t GetRouteCacheHits (void) const;
+
+	/**
+	* \brief Get the number of lookups done on the forwarding table
+	* \returns the number of cache misses
+	*/
+	uint64_t GetRouteCacheMisses (void) const;
+
 protected:
 	void DoDispose (void);
 
@@ -187,6 +220,11 @@ private:
 	/// iterator of container of Ipv4RoutingTableEntry (routes to networks)
 	typedef std::list<Ipv4RoutingTableEntry *>::iterator SuffixRoutesI;
 
+	/// container of the routes found per destination
+	typedef std::map<Ipv4Address, Ptr<Ipv4Route> > RouteCache;
+	/// const iterator of container of the routes found per destination
+	typedef std::map<Ipv4Address, Ptr<Ipv4Route> >::const_iterator RouteCacheCI;
+
 	/// Socket list type
 	typedef std::map< Ptr<Socket>, uint32_t> SocketList;
 	/// Socket list type iterator
@@ -196,9 +234,91 @@ private:
 
 	Ptr<Ipv4Route> LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif = 0);
 
+	/**
+	* \brief Compiles the route lists into the forwarding table
+	*/
+	void BuildFib (void);
+
+	/**
+	* \brief Drops the forwarding table and the cached routes, called when the routes change
+	*/
+	void InvalidateRoutes (void);
+
+	/**
+	* \brief Creates the route to the next hop of a routing table entry
+	*/
+	Ptr<Ipv4Route> CreateRoute (Ipv4RoutingTableEntry* route);
+
+	/**
+	* \brief Looks up the route of a forwarded packet, hashing its flow over the uplinks
+	*/
+	Ptr<Ipv4Route> LookupEcmp (Ptr<const Packet> p, const Ipv4Header &header);
+
+	/**
+	* \brief Hash of the 5-tuple of packet, salted with the node
+	*/
+	uint32_t FlowHash (Ptr<const Packet> p, const Ipv4Header &header) const;
+
+	/**
+	* \brief Counts a forwarded packet if its route is an uplink
+	*/
+	void CountUplink (Ptr<const Ipv4Route> route, Ptr<const Packet> p, const Ipv4Header &header);
+
+	/**
+	* \brief The load of an uplink
+	*/
+	struct UplinkLoad_s {
+		UplinkLoad_s () : packets (0), bytes (0), recent (0) {}
+		uint64_t packets; //!< Packets forwarded
+		uint64_t bytes; //!< Bytes forwarded
+		double recent; //!< Bytes forwarded, decayed by LoadDecay up to updated
+		Time updated; //!< The time recent was last decayed
+	};
+
+	/**
+	* \brief The recent load of an uplink, decayed to now
+	* \param iface The interface of uplink
+	* \returns the decayed number of bytes
+	*/
+	double GetRecentLoad (uint32_t iface) const;
+
+	/**
+	* \brief Removes the flowlets idle for longer than the flowlet timeout
+	*/
+	void ExpireFlowlets (void);
+
+	/**
+	* \brief The uplink taken by the current flowlet of a flow
+	*/
+	struct Flowlet_s {
+		uint32_t uplink; //!< The index of suffix route
+		Time lastSeen; //!< The last packet of flow
+	};
+
 	NetworkRoutes m_networkRoutes;       //!< Routes to networks
 	SuffixRoutes m_suffixRoutes;		//!<Routes to networks
 
+	FatTreeIpv4Fib m_fib; //!< The compiled forwarding table
+	bool m_fibValid; //!< false if the routes changed since the table was built
+	RouteCache m_routeCache; //!< The routes found per destination, for lookups on any interface
+	TracedValue<uint64_t> m_cacheHits; //!< Lookups answered by the route cache
+	TracedValue<uint64_t> m_cacheMisses; //!< Lookups done on the forwarding table
+
+	bool m_flowHashEcmp; //!< Hash the flows over the uplinks
+	Time m_flowletTimeout; //!< The idle time starting a new flowlet, zero for none
+	Time m_loadDecay; //!< The time constant of the recent uplink load
+	Time m_lastExpiry; //!< The last time idle flowlets were removed
+	uint32_t m_nodeId; //!< The node, salting the flow hash
+	std::vector<bool> m_isUplink; //!< true for the interfaces of uplinks
+	std::vector<UplinkLoad_s> m_uplinkLoad; //!< The load per interface
+	std::vector<Ptr<Ipv4Route> > m_uplinkRoutes; //!< The route of each uplink, built on first use
+	std::map<uint32_t, Flowlet_s> m_flowlets; //!< The flowlets by flow hash
+
+	/**
+	* Fired when a packet is forwarded on an uplink, with the interface of uplink
+	*/
+	TracedCallback<uint32_t, Ptr<const Packet> > m_uplinkForwardTrace;
+
 	Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 
 	SocketList m_sendSocketList; //!< list of sockets for sending (socket, interface index)
@@ -220,8 +340,6 @@ private:
 
 	void FindSwitchIndex();
 
-	Ipv4RoutingTableEntry* FindCloseMatch(std::vector<Ipv4RoutingTableEntry*> allRoutes, Ipv4Address dest);
-
 	Ipv4Address CorePodAddress(uint32_t p);
 	Ipv4Address SwitchPod(Ipv4Address & addr);
 	Ipv4Address SwitchIndexAddress(Ipv4Address & addr);
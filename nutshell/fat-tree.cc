@@ -34,6 +34,9 @@
 #include "ns3/log.h"
 #include "ns3/node.h"
 #include "ns3/node-container.h"
+#ifdef NS3_MPI
+#include "ns3/mpi-interface.h"
+#endif
 
 #include "fat-tree-config.h"
 #include "fat-tree-addressing-scheme.h"
@@ -62,6 +65,24 @@ FatTree::CreateArchitecture()
 	 * pod switches
 	 */
 	m_podBy2 = m_config.GetPods() / 2;
+	m_partitions = m_config.GetPartitions();
+	m_systemId = 0;
+	if(m_partitions > 1)
+	{
+#ifdef NS3_MPI
+		if(MpiInterface::GetSize() != m_partitions)
+		{
+			NS_FATAL_ERROR("FatTree partitioned onto " << m_partitions << " processes, MPI has " << MpiInterface::GetSize());
+		}
+		m_systemId = MpiInterface::GetSystemId();
+#else
+		NS_FATAL_ERROR("FatTree partitions require ns-3 built with MPI");
+#endif
+		if(m_partitions > m_config.GetPods())
+		{
+			NS_FATAL_ERROR("FatTree of " << m_config.GetPods() << " pods partitioned onto " << m_partitions << " processes");
+		}
+	}
 	m_rstart = 0;
 	m_rend = m_rstart + m_podBy2;
 
@@ -151,7 +172,11 @@ FatTree::CreateAllNodes()
 
 	NS_LOG_UNCOND("Total Nodes: " << totNode);
 
-	m_allNodes.Create(totNode);
+	// nodes are in pod order, each pod is owned by one logical process
+	for(uint32_t i = 0; i < m_config.GetPods(); i++)
+	{
+		m_allNodes.Create(totNode / m_config.GetPods(), GetPodSystemId(i));
+	}
 
 }
 
@@ -168,9 +193,10 @@ FatTree::CreateAccessNetwork(uint32_t podIndex)
 		nodes.Add(m_allNodes.GetNodeContainerOfRange(m_rstart, m_rend));
 		stack.Install(nodes);
 		AccessNetwork an;
-		an.SetNetwork(m_addrScheme->GetNetwork(m_addrCount), m_addrScheme->GetSubnet(m_addrCount));
+		an.SetNetwork(m_addrScheme->GetNetworkAddress(m_addrCount), m_addrScheme->GetNetworkMask(m_addrCount));
 
 		an.SetChannel(p2p);
+		an.SetSystemId(GetPodSystemId(podIndex));
 		an.SetIntenetStack(stack);
 		an.SetNodes(nodes);
 		an.CreateNetwork();
@@ -192,7 +218,7 @@ FatTree::CreateAccessNetwork(uint32_t podIndex)
 void
 FatTree::CreateAggSw(uint32_t podIndex)
 {
-	m_aggSw[podIndex].Create(m_podBy2);
+	m_aggSw[podIndex].Create(m_podBy2, GetPodSystemId(podIndex));
 	m_config.GetStack().Install(m_aggSw[podIndex]);
 }
 
@@ -200,7 +226,12 @@ void
 FatTree::CreateCorePod()
 {
 	uint32_t coreSwitches = pow(m_podBy2, 2);
-	m_coreSw.Create(coreSwitches);
+	// the core switches are spread over the logical processes, their
+	// links to aggregate switches are the partition boundary
+	for(uint32_t i = 0; i < coreSwitches; i++)
+	{
+		m_coreSw.Create(1, i % m_partitions);
+	}
 	m_config.GetStack().Install(m_coreSw);
 }
 
@@ -217,7 +248,7 @@ FatTree::ConnectAggToAcc(uint32_t podIndex)
 	for(uint32_t i = 0; i < m_podBy2; i++)
 	{
 		Ptr<Node> aggSw = m_aggSw[podIndex].Get(i);
-		ch.ConnectDevicesLayer3(aggSw, accSw, p2p, m_addrScheme->GetNetwork(m_addrCount), m_addrScheme->GetSubnet(m_addrCount));
+		ch.ConnectDevicesLayer3(aggSw, accSw, p2p, m_addrScheme->GetNetworkAddress(m_addrCount), m_addrScheme->GetNetworkMask(m_addrCount));
 		m_addrCount++;
 	}
 }
@@ -245,7 +276,7 @@ FatTree::ConnectCoreToPod()
 			connectingAggSw = tmpC;
 		}
 		Ptr<Node> coreSw = m_coreSw.Get(i);
-		ch.ConnectDevicesLayer3(coreSw, connectingAggSw, p2p, m_addrScheme->GetNetwork(m_addrCount), m_addrScheme->GetSubnet(m_addrCount));
+		ch.ConnectDevicesLayer3(coreSw, connectingAggSw, p2p, m_addrScheme->GetNetworkAddress(m_addrCount), m_addrScheme->GetNetworkMask(m_addrCount));
 		m_addrCount++;
 	}
 }
@@ -287,10 +318,36 @@ FatTree::BeginScheduling()
 {
 
 	m_config.GetVmScheduler()->SetConfiguration(m_config);
-	m_config.GetVmScheduler()->SetNodes(m_allNodes);
-	m_config.GetVmScheduler()->SetInterfaces(m_nodeInterfaces);
+	if(m_partitions > 1)
+	{
+		// VMs run only on the nodes of this logical process
+		ComputationalNodeContainer localNodes;
+		Ipv4InterfaceContainer localInterfaces;
+		for(uint32_t i = 0; i < m_allNodes.GetN(); i++)
+		{
+			if(m_allNodes.Get(i)->GetSystemId() == m_systemId)
+			{
+				localNodes.Add(m_allNodes.Get(i));
+				localInterfaces.Add(m_nodeInterfaces.Get(i));
+			}
+		}
+		m_config.GetVmScheduler()->SetNodes(localNodes);
+		m_config.GetVmScheduler()->SetInterfaces(localInterfaces);
+		m_config.GetVmScheduler()->SetPartition(m_systemId, m_partitions);
+	}
+	else
+	{
+		m_config.GetVmScheduler()->SetNodes(m_allNodes);
+		m_config.GetVmScheduler()->SetInterfaces(m_nodeInterfaces);
+	}
 	m_config.GetVmScheduler()->BeginScheduling();
 
 }
 
+uint32_t
+FatTree::GetPodSystemId(uint32_t podIndex) const
+{
+	return podIndex * m_partitions / m_config.GetPods();
+}
+
 } /* namespace ns3 */
@@ -104,6 +104,12 @@ private:
 	 * \brief Begins the scheduling of Virtual Machines
 	 */
 	void BeginScheduling();
+	/**
+	 * \brief Get the system id of the logical process owning a pod
+	 * \param podIndex The pod index
+	 * \return The system id
+	 */
+	uint32_t GetPodSystemId(uint32_t podIndex) const;
 
 	uint32_t m_podBy2; //!< value of pod/2 (k/2)
 	uint32_t m_addrCount; //!< used address counter
@@ -118,6 +124,9 @@ private:
 	// range definer
 	uint32_t m_rstart; //!< range start to group access network, aggregate routers according to k/2 while looping through the list
 	uint32_t m_rend; //!< range end
+
+	uint32_t m_partitions; //!< number of logical processes the pods are split onto
+	uint32_t m_systemId; //!< system id of this logical process
 };
 
 } /* namespace ns3 */
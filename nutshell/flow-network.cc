@@ -0,0 +1,546 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *
+ * flow-network.cc
+ *
+ *  Created on: Mar 13, 2017
+ *      Author: ubaid
+ *       Email: u.ur.rahman@gmail.com
+ */
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/node-list.h"
+#include "ns3/channel.h"
+#include "ns3/ipv4.h"
+#include "ns3/trace-source-accessor.h"
+
+#include "flow-network.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FlowNetwork");
+
+NS_OBJECT_ENSURE_REGISTERED (FlowNetwork);
+
+TypeId
+FlowNetwork::GetTypeId ()
+{
+	static TypeId tid = TypeId("ns3::FlowNetwork")
+		.SetParent (Object::GetTypeId())
+		.AddConstructor<FlowNetwork> ()
+		.AddTraceSource ("FlowCompleted",
+						"A flow has been delivered, with its size in bytes and duration",
+						MakeTraceSourceAccessor (&FlowNetwork::m_flowCompletedTrace))
+		;
+	return tid;
+}
+
+FlowNetwork::FlowNetwork()
+	: m_mappedNodes (0),
+	  m_nextId (1)
+{
+	NS_LOG_FUNCTION(this);
+}
+
+FlowNetwork::~FlowNetwork()
+{
+	NS_LOG_FUNCTION(this);
+}
+
+void
+FlowNetwork::DoDispose()
+{
+	NS_LOG_FUNCTION(this);
+	Simulator::Cancel(m_completion);
+	m_flows.clear();
+	m_endpoints.clear();
+	m_paths.clear();
+	m_links.clear();
+	m_linkIndex.clear();
+	Object::DoDispose();
+}
+
+/*
+ * ------------------ endpoints ------------------
+ */
+
+void
+FlowNetwork::Bind(Ptr<Node> node, uint16_t port, ReceiveCallback cb)
+{
+	NS_LOG_FUNCTION(this << node->GetId() << port);
+	m_endpoints[EndpointKey(node->GetId(), port)].recv = cb;
+}
+
+void
+FlowNetwork::BindServer(Ptr<Node> node, uint16_t port, RequestCallback cb)
+{
+	NS_LOG_FUNCTION(this << node->GetId() << port);
+	m_endpoints[EndpointKey(node->GetId(), port)].request = cb;
+}
+
+void
+FlowNetwork::Unbind(Ptr<Node> node, uint16_t port)
+{
+	NS_LOG_FUNCTION(this << node->GetId() << port);
+	m_endpoints.erase(EndpointKey(node->GetId(), port));
+}
+
+void
+FlowNetwork::Request(Ptr<Node> client, uint16_t clientPort, Ipv4Address server, uint16_t serverPort,
+		uint64_t bytes, DataRate rate)
+{
+	NS_LOG_FUNCTION(this << client->GetId() << clientPort << server << serverPort << bytes);
+	Ptr<Node> s = GetNode(server);
+	if(s == 0)
+	{
+		NS_FATAL_ERROR("No node has the address " << server);
+	}
+	/*
+	 * The request is a single small packet, it is delivered
+	 * without taking a share of the links.
+	 */
+	Request_s request;
+	request.client = client;
+	request.clientPort = clientPort;
+	request.server = s->GetId();
+	request.serverPort = serverPort;
+	request.bytes = bytes;
+	request.rate = rate;
+	Simulator::ScheduleNow(&FlowNetwork::DeliverRequest, this, request);
+}
+
+void
+FlowNetwork::DeliverRequest(Request_s request)
+{
+	NS_LOG_FUNCTION(this);
+	std::map<EndpointKey, Endpoint_s>::iterator it =
+			m_endpoints.find(EndpointKey(request.server, request.serverPort));
+	if(it == m_endpoints.end() || it->second.request.IsNull())
+	{
+		NS_LOG_WARN("Request dropped, no server bound on node " << request.server
+				<< " port " << request.serverPort);
+		return;
+	}
+	RequestCallback cb = it->second.request;
+	cb(request.client, request.clientPort, request.bytes, request.rate);
+}
+
+Ptr<Node>
+FlowNetwork::GetNode(Ipv4Address address)
+{
+	if(m_mappedNodes != NodeList::GetNNodes())
+	{
+		MapAddresses();
+	}
+	std::map<Ipv4Address, uint32_t>::iterator it = m_addresses.find(address);
+	if(it == m_addresses.end())
+	{
+		return 0;
+	}
+	return NodeList::GetNode(it->second);
+}
+
+void
+FlowNetwork::MapAddresses()
+{
+	NS_LOG_FUNCTION(this);
+	m_addresses.clear();
+	m_mappedNodes = NodeList::GetNNodes();
+	for(NodeList::Iterator n = NodeList::Begin(); n != NodeList::End(); n++)
+	{
+		Ptr<Ipv4> ipv4 = (*n)->GetObject<Ipv4>();
+		if(ipv4 == 0)
+		{
+			continue;
+		}
+		for(uint32_t i = 0; i < ipv4->GetNInterfaces(); i++)
+		{
+			for(uint32_t j = 0; j < ipv4->GetNAddresses(i); j++)
+			{
+				m_addresses[ipv4->GetAddress(i, j).GetLocal()] = (*n)->GetId();
+			}
+		}
+	}
+}
+
+/*
+ * ------------------ flows ------------------
+ */
+
+uint64_t
+FlowNetwork::StartFlow(Ptr<Node> src, Ptr<Node> dst, uint16_t port, uint64_t bytes,
+		DataRate rate, Callback<void> sent)
+{
+	NS_LOG_FUNCTION(this << src->GetId() << dst->GetId() << port << bytes << rate);
+	Advance();
+
+	Flow_s flow;
+	flow.path = GetPath(src->GetId(), dst->GetId());
+	flow.bytes = bytes;
+	flow.remaining = bytes * 8.0;
+	flow.rate = 0;
+	flow.cap = rate.GetBitRate();
+	flow.dstNode = dst->GetId();
+	flow.port = port;
+	flow.sent = sent;
+	flow.start = Simulator::Now();
+
+	/*
+	 * A flow gets a positive rate unless its VM or a link of its path
+	 * has no capacity, such a flow would never complete.
+	 */
+	if(flow.cap <= 0)
+	{
+		NS_FATAL_ERROR("Flow from node " << src->GetId() << " to node " << dst->GetId()
+				<< " has a zero sending rate");
+	}
+	for(uint32_t i = 0; i < flow.path.size(); i++)
+	{
+		if(m_links[flow.path[i]].capacity <= 0)
+		{
+			NS_FATAL_ERROR("Flow from node " << src->GetId() << " to node " << dst->GetId()
+					<< " crosses a link of zero capacity");
+		}
+	}
+
+	uint64_t id = m_nextId++;
+	m_flows[id] = flow;
+	for(uint32_t i = 0; i < flow.path.size(); i++)
+	{
+		m_links[flow.path[i]].flows.insert(id);
+	}
+
+	Allocate();
+	Reschedule();
+	return id;
+}
+
+void
+FlowNetwork::CancelFlow(uint64_t id)
+{
+	NS_LOG_FUNCTION(this << id);
+	if(m_flows.find(id) == m_flows.end())
+	{
+		return;
+	}
+	Advance();
+	RemoveFlow(id);
+	Allocate();
+	Reschedule();
+}
+
+uint32_t
+FlowNetwork::GetNFlows() const
+{
+	return m_flows.size();
+}
+
+void
+FlowNetwork::RemoveFlow(uint64_t id)
+{
+	std::map<uint64_t, Flow_s>::iterator it = m_flows.find(id);
+	for(uint32_t i = 0; i < it->second.path.size(); i++)
+	{
+		m_links[it->second.path[i]].flows.erase(id);
+	}
+	m_flows.erase(it);
+}
+
+void
+FlowNetwork::Advance()
+{
+	Time now = Simulator::Now();
+	double dt = (now - m_lastUpdate).GetSeconds();
+	if(dt > 0)
+	{
+		for(std::map<uint64_t, Flow_s>::iterator it = m_flows.begin(); it != m_flows.end(); it++)
+		{
+			it->second.remaining -= it->second.rate * dt;
+		}
+	}
+	m_lastUpdate = now;
+}
+
+void
+FlowNetwork::Allocate()
+{
+	/*
+	 * Progressive filling: all unfrozen flows grow at the same rate until
+	 * a link is saturated or a flow reaches the rate of its VM, those
+	 * flows are frozen and the rest keep growing.
+	 */
+	std::vector<uint32_t> active;
+	for(uint32_t l = 0; l < m_links.size(); l++)
+	{
+		if(!m_links[l].flows.empty())
+		{
+			m_links[l].left = m_links[l].capacity;
+			m_links[l].unfrozen = m_links[l].flows.size();
+			active.push_back(l);
+		}
+	}
+
+	std::set<uint64_t> unfrozen;
+	for(std::map<uint64_t, Flow_s>::iterator it = m_flows.begin(); it != m_flows.end(); it++)
+	{
+		it->second.rate = 0;
+		unfrozen.insert(it->first);
+	}
+
+	double level = 0;
+	while(!unfrozen.empty())
+	{
+		double delta = std::numeric_limits<double>::max();
+		for(uint32_t i = 0; i < active.size(); i++)
+		{
+			Link_s & link = m_links[active[i]];
+			if(link.unfrozen > 0)
+			{
+				delta = std::min(delta, link.left / link.unfrozen);
+			}
+		}
+		for(std::set<uint64_t>::iterator f = unfrozen.begin(); f != unfrozen.end(); f++)
+		{
+			delta = std::min(delta, m_flows[*f].cap - level);
+		}
+		delta = std::max(delta, 0.0);
+		level += delta;
+
+		for(uint32_t i = 0; i < active.size(); i++)
+		{
+			Link_s & link = m_links[active[i]];
+			link.left -= delta * link.unfrozen;
+		}
+
+		std::vector<uint64_t> frozen;
+		for(std::set<uint64_t>::iterator f = unfrozen.begin(); f != unfrozen.end(); f++)
+		{
+			Flow_s & flow = m_flows[*f];
+			flow.rate = level;
+			bool freeze = (flow.cap - level) <= flow.cap * 1e-9;
+			for(uint32_t i = 0; !freeze && i < flow.path.size(); i++)
+			{
+				const Link_s & link = m_links[flow.path[i]];
+				freeze = link.left <= link.capacity * 1e-9;
+			}
+			if(freeze)
+			{
+				frozen.push_back(*f);
+			}
+		}
+		for(uint32_t i = 0; i < frozen.size(); i++)
+		{
+			const Flow_s & flow = m_flows[frozen[i]];
+			for(uint32_t j = 0; j < flow.path.size(); j++)
+			{
+				m_links[flow.path[j]].unfrozen--;
+			}
+			unfrozen.erase(frozen[i]);
+		}
+	}
+}
+
+void
+FlowNetwork::Reschedule()
+{
+	Simulator::Cancel(m_completion);
+	double next = std::numeric_limits<double>::max();
+	for(std::map<uint64_t, Flow_s>::iterator it = m_flows.begin(); it != m_flows.end(); it++)
+	{
+		if(it->second.rate > 0)
+		{
+			next = std::min(next, std::max(it->second.remaining, 0.0) / it->second.rate);
+		}
+	}
+	if(next < std::numeric_limits<double>::max())
+	{
+		m_completion = Simulator::Schedule(Seconds(next), &FlowNetwork::Complete, this);
+	}
+}
+
+void
+FlowNetwork::Complete()
+{
+	NS_LOG_FUNCTION(this);
+	Advance();
+
+	/*
+	 * Time is rounded to the simulator resolution, a flow within
+	 * a nanosecond of its end is complete.
+	 */
+	std::vector<uint64_t> done;
+	for(std::map<uint64_t, Flow_s>::iterator it = m_flows.begin(); it != m_flows.end(); it++)
+	{
+		if(it->second.remaining <= it->second.rate * 1e-9 + 1e-6)
+		{
+			done.push_back(it->first);
+		}
+	}
+
+	std::vector<Flow_s> delivered;
+	for(uint32_t i = 0; i < done.size(); i++)
+	{
+		delivered.push_back(m_flows[done[i]]);
+		RemoveFlow(done[i]);
+	}
+	Allocate();
+	Reschedule();
+
+	for(uint32_t i = 0; i < delivered.size(); i++)
+	{
+		const Flow_s & flow = delivered[i];
+		NS_LOG_INFO("At time " << Simulator::Now().GetSeconds() << "s flow of " << flow.bytes
+				<< " bytes delivered to node " << flow.dstNode << " port " << flow.port);
+		m_flowCompletedTrace(flow.bytes, Simulator::Now() - flow.start);
+
+		std::map<EndpointKey, Endpoint_s>::iterator it =
+				m_endpoints.find(EndpointKey(flow.dstNode, flow.port));
+		if(it != m_endpoints.end() && !it->second.recv.IsNull())
+		{
+			// the receiver may unbind itself
+			ReceiveCallback cb = it->second.recv;
+			cb(flow.bytes);
+		}
+		else
+		{
+			NS_LOG_WARN("Flow dropped, nothing bound on node " << flow.dstNode << " port " << flow.port);
+		}
+		if(!flow.sent.IsNull())
+		{
+			flow.sent();
+		}
+	}
+}
+
+/*
+ * ------------------ topology ------------------
+ */
+
+uint32_t
+FlowNetwork::GetLink(Ptr<NetDevice> device)
+{
+	std::map<Ptr<NetDevice>, uint32_t>::iterator it = m_linkIndex.find(device);
+	if(it != m_linkIndex.end())
+	{
+		return it->second;
+	}
+
+	DataRateValue rate;
+	if(!device->GetAttributeFailSafe("DataRate", rate) &&
+			!device->GetChannel()->GetAttributeFailSafe("DataRate", rate))
+	{
+		NS_FATAL_ERROR("Unable to find the data rate of device " << device->GetIfIndex()
+				<< " on node " << device->GetNode()->GetId());
+	}
+
+	Link_s link;
+	link.device = device;
+	link.capacity = rate.Get().GetBitRate();
+	link.left = 0;
+	link.unfrozen = 0;
+	m_links.push_back(link);
+	m_linkIndex[device] = m_links.size() - 1;
+	return m_links.size() - 1;
+}
+
+const std::vector<uint32_t> &
+FlowNetwork::GetPath(uint32_t src, uint32_t dst)
+{
+	std::pair<uint32_t, uint32_t> key(src, dst);
+	std::map<std::pair<uint32_t, uint32_t>, std::vector<uint32_t> >::iterator cached = m_paths.find(key);
+	if(cached != m_paths.end())
+	{
+		return cached->second;
+	}
+
+	/*
+	 * Breadth first search over the channels, keeping every parent at
+	 * the previous hop so that all shortest paths are known.
+	 */
+	std::map<uint32_t, uint32_t> hops;
+	std::map<uint32_t, std::vector<std::pair<uint32_t, uint32_t> > > parents;
+	std::deque<uint32_t> queue;
+	hops[src] = 0;
+	queue.push_back(src);
+	while(!queue.empty())
+	{
+		uint32_t u = queue.front();
+		queue.pop_front();
+		if(hops.find(dst) != hops.end() && hops[u] >= hops[dst])
+		{
+			break;
+		}
+		Ptr<Node> node = NodeList::GetNode(u);
+		for(uint32_t d = 0; d < node->GetNDevices(); d++)
+		{
+			Ptr<NetDevice> device = node->GetDevice(d);
+			Ptr<Channel> channel = device->GetChannel();
+			if(channel == 0)
+			{
+				continue;
+			}
+			for(uint32_t p = 0; p < channel->GetNDevices(); p++)
+			{
+				Ptr<NetDevice> peer = channel->GetDevice(p);
+				if(peer == device)
+				{
+					continue;
+				}
+				uint32_t v = peer->GetNode()->GetId();
+				std::map<uint32_t, uint32_t>::iterator h = hops.find(v);
+				if(h == hops.end())
+				{
+					hops[v] = hops[u] + 1;
+					queue.push_back(v);
+					parents[v].push_back(std::make_pair(u, GetLink(device)));
+				}
+				else if(h->second == hops[u] + 1)
+				{
+					parents[v].push_back(std::make_pair(u, GetLink(device)));
+				}
+			}
+		}
+	}
+	if(src != dst && hops.find(dst) == hops.end())
+	{
+		NS_FATAL_ERROR("No path from node " << src << " to node " << dst);
+	}
+
+	/*
+	 * Walk back from destination, the parent at each hop is picked
+	 * by hashing the pair of nodes so pairs spread over equal paths.
+	 */
+	std::vector<uint32_t> path;
+	uint32_t hash = (src * 2654435761u) ^ (dst * 40503u);
+	for(uint32_t v = dst; v != src; )
+	{
+		const std::vector<std::pair<uint32_t, uint32_t> > & p = parents[v];
+		const std::pair<uint32_t, uint32_t> & choice = p[hash % p.size()];
+		path.push_back(choice.second);
+		v = choice.first;
+		hash = hash * 31 + 7;
+	}
+	std::reverse(path.begin(), path.end());
+	return m_paths[key] = path;
+}
+
+} /* namespace ns3 */
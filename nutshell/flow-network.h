@@ -0,0 +1,258 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *
+ * flow-network.h
+ *
+ *  Created on: Mar 13, 2017
+ *      Author: ubaid
+ *       Email: u.ur.rahman@gmail.com
+ */
+
+#ifndef NUTSHELL_FLOW_NETWORK_H
+#define NUTSHELL_FLOW_NETWORK_H
+
+#include <stdint.h>
+#include <map>
+#include <set>
+#include <vector>
+#include <utility>
+
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+#include "ns3/callback.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/data-rate.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/node.h"
+#include "ns3/net-device.h"
+#include "ns3/traced-callback.h"
+
+namespace ns3 {
+
+/**
+ * \brief A flow level (fluid) model of data transfer over the datacenter network
+ *
+ * A transfer is a single flow instead of a stream of packets. Every flow
+ * follows a shortest path between its end nodes, found over the channels of
+ * the topology, and gets a max-min fair share of the links on its path,
+ * limited by the transmission rate of the sending VM.
+ *
+ * The rates are recomputed only when a flow arrives or departs and only the
+ * earliest flow completion is scheduled, so a transfer of any size costs a
+ * few events instead of one event per MTU.
+ *
+ * Endpoints bind a node and port, like a listening socket. A receiver is
+ * called with the bytes of each flow delivered to it, a server is called
+ * with the requests sent to it, see StorageServer.
+ *
+ * Propagation and queuing delays are not modelled, the shortest path among
+ * the equal cost ones is picked per pair of nodes, as ECMP hashing would.
+ */
+class FlowNetwork : public Object {
+public:
+	/**
+	* \brief Get the type ID.
+	* \return the object TypeId
+	*/
+	static TypeId GetTypeId (void);
+	FlowNetwork();
+	virtual ~FlowNetwork();
+
+	/**
+	 * Called with the number of bytes of a flow delivered to the endpoint
+	 */
+	typedef Callback<void, uint64_t> ReceiveCallback;
+	/**
+	 * Called with a request for data: the node and port to reply to,
+	 * the number of bytes and the rate of requesting VM
+	 */
+	typedef Callback<void, Ptr<Node>, uint16_t, uint64_t, DataRate> RequestCallback;
+
+	/**
+	 * \brief Binds a receiving endpoint
+	 * \param node The node of endpoint
+	 * \param port The port of endpoint
+	 * \param cb The callback receiving the delivered flows
+	 */
+	void Bind(Ptr<Node> node, uint16_t port, ReceiveCallback cb);
+	/**
+	 * \brief Binds a serving endpoint
+	 * \param node The node of endpoint
+	 * \param port The port of endpoint
+	 * \param cb The callback receiving the requests
+	 */
+	void BindServer(Ptr<Node> node, uint16_t port, RequestCallback cb);
+	/**
+	 * \brief Removes the endpoint bound to a node and port
+	 */
+	void Unbind(Ptr<Node> node, uint16_t port);
+
+	/**
+	 * \brief Sends a request for data to a server
+	 *
+	 * \param client The node of requesting VM
+	 * \param clientPort The port bound by the requesting VM for the data
+	 * \param server The address of server
+	 * \param serverPort The port of server
+	 * \param bytes The amount of data requested
+	 * \param rate The rate at which the VM receives data
+	 */
+	void Request(Ptr<Node> client, uint16_t clientPort, Ipv4Address server, uint16_t serverPort,
+			uint64_t bytes, DataRate rate);
+
+	/**
+	 * \brief Starts a flow
+	 *
+	 * \param src The sending node
+	 * \param dst The receiving node
+	 * \param port The port bound on receiving node
+	 * \param bytes The amount of data to transfer
+	 * \param rate The maximum rate of flow, i.e. the rate of sending VM
+	 * \param sent The callback invoked on the sender when the flow is delivered
+	 * \return The ID of flow, never 0
+	 */
+	uint64_t StartFlow(Ptr<Node> src, Ptr<Node> dst, uint16_t port, uint64_t bytes,
+			DataRate rate, Callback<void> sent);
+	/**
+	 * \brief Removes a flow before it is delivered
+	 * \param id The ID of flow
+	 */
+	void CancelFlow(uint64_t id);
+
+	/**
+	 * \brief Get the node owning an address
+	 * \param address The IPv4 address of an interface
+	 * \return The node, 0 if no node has the address
+	 */
+	Ptr<Node> GetNode(Ipv4Address address);
+	/**
+	 * \brief Get the number of active flows
+	 * \return The number of flows
+	 */
+	uint32_t GetNFlows() const;
+
+protected:
+	virtual void DoDispose(void);
+
+private:
+	/**
+	 * \brief A directed link, the egress of a device into its channel
+	 */
+	struct Link_s {
+		Ptr<NetDevice> device; //!< The sending device
+		double capacity; //!< Bits per second
+		std::set<uint64_t> flows; //!< The flows crossing the link
+		double left; //!< Capacity not yet allocated, during allocation
+		uint32_t unfrozen; //!< Flows still growing, during allocation
+	};
+	/**
+	 * \brief An active flow
+	 */
+	struct Flow_s {
+		std::vector<uint32_t> path; //!< The links of flow
+		uint64_t bytes; //!< The size of flow
+		double remaining; //!< Bits left to transfer
+		double rate; //!< Allocated bits per second
+		double cap; //!< The rate of sending VM
+		uint32_t dstNode; //!< The receiving node
+		uint16_t port; //!< The receiving port
+		Callback<void> sent; //!< Invoked on the sender on delivery
+		Time start; //!< The start of flow
+	};
+	/**
+	 * \brief A bound endpoint
+	 */
+	struct Endpoint_s {
+		ReceiveCallback recv;
+		RequestCallback request;
+	};
+
+	/**
+	 * \brief A request on its way to a server
+	 */
+	struct Request_s {
+		Ptr<Node> client; //!< The requesting node
+		uint16_t clientPort; //!< The port to reply to
+		uint32_t server; //!< The server node
+		uint16_t serverPort; //!< The server port
+		uint64_t bytes; //!< The amount of data requested
+		DataRate rate; //!< The rate of requesting VM
+	};
+
+	typedef std::pair<uint32_t, uint16_t> EndpointKey;
+
+	/**
+	 * \brief Get the index of link of a device, adding it if new
+	 */
+	uint32_t GetLink(Ptr<NetDevice> device);
+	/**
+	 * \brief Get the links of path between two nodes
+	 */
+	const std::vector<uint32_t> & GetPath(uint32_t src, uint32_t dst);
+	/**
+	 * \brief Maps the interface addresses of all nodes
+	 *
+	 * The addresses are mapped once, and again only when nodes were added
+	 * since, an unknown address does not rescan the nodes.
+	 */
+	void MapAddresses();
+	/**
+	 * \brief Delivers a request to the server bound to a node and port
+	 */
+	void DeliverRequest(Request_s request);
+	/**
+	 * \brief Deducts the bits transferred since the last update
+	 */
+	void Advance();
+	/**
+	 * \brief Max-min fair allocation of link capacity to the flows
+	 */
+	void Allocate();
+	/**
+	 * \brief Schedules the completion of earliest flow
+	 */
+	void Reschedule();
+	/**
+	 * \brief Delivers the flows completed at current time
+	 */
+	void Complete();
+	/**
+	 * \brief Removes a flow from its links
+	 */
+	void RemoveFlow(uint64_t id);
+
+	std::vector<Link_s> m_links; //!< All links seen on a path
+	std::map<Ptr<NetDevice>, uint32_t> m_linkIndex; //!< Maps device to link
+	std::map<std::pair<uint32_t, uint32_t>, std::vector<uint32_t> > m_paths; //!< Path cache
+	std::map<Ipv4Address, uint32_t> m_addresses; //!< Maps address to node ID
+	uint32_t m_mappedNodes; //!< The number of nodes when the addresses were mapped
+	std::map<EndpointKey, Endpoint_s> m_endpoints; //!< Bound endpoints
+	std::map<uint64_t, Flow_s> m_flows; //!< Active flows
+	uint64_t m_nextId; //!< The ID of next flow
+	Time m_lastUpdate; //!< The time remaining bits were last updated
+	EventId m_completion; //!< The completion of earliest flow
+
+	/**
+	 * Fired when a flow is delivered, with its size in bytes and duration
+	 */
+	TracedCallback<uint64_t, Time> m_flowCompletedTrace;
+};
+
+} /* namespace ns3 */
+
+#endif /* NUTSHELL_FLOW_NETWORK_H */
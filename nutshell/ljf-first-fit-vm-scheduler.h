@@ -65,7 +65,13 @@ public:
 	LjfFirstFitVmScheduler(DatacenterConfig config);
 	virtual ~LjfFirstFitVmScheduler();
 protected:
-	virtual void SortVmList();
+	/**
+	 * \brief Orders VMs by arrival, longest job first on equal arrival
+	 *
+	 * VMs arriving together are ordered by larger data amount, then
+	 * larger application size, then smaller processing power.
+	 */
+	virtual bool CompareVm(const VmProperties & a, const VmProperties & b) const;
 };
 
 } /* namespace ns3 */
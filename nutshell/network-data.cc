@@ -27,6 +27,7 @@
 #include "ns3/flow-monitor-module.h"
 #include "nutshell-data-collector.h"
 #include "network-data.h"
+#include "columnar-writer.h"
 
 namespace ns3 {
 
@@ -45,7 +46,9 @@ NetworkData::NetworkData()
 	m_rxBytesSum = 0;
 	m_lostPacketRatioSum = 0;
 	m_packetDeliverySum = 0;
-
+	m_knownFlows = 0;
+	m_nextFlowId = 0;
+	m_lastSampleTime = 0;
 
 }
 
@@ -63,7 +66,12 @@ NetworkData::AttachTraceSink()
 	Config::ConnectWithoutContext("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Mac/MacTxDrop", MakeCallback(&NetworkData::MacTxDrop, this));
 	Config::ConnectWithoutContext("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/PhyRxDrop", MakeCallback(&NetworkData::PhyRxDrop, this));
 	Config::ConnectWithoutContext("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/PhyTxDrop", MakeCallback(&NetworkData::PhyTxDrop, this));
-	Simulator::Schedule(Seconds(m_timeInterval), &NetworkData::ProcessTraffic, this);
+}
+
+void
+NetworkData::Sample()
+{
+	ProcessTraffic();
 }
 
 void
@@ -102,13 +110,59 @@ NetworkData::ExportDetails()
 	file.close();
 }
 
+void
+NetworkData::ExportBinary(ColumnarWriter & writer)
+{
+	uint32_t drops = writer.AddTable("network_drops");
+	writer.AddColumn(drops, "mac_tx_drop", ColumnarWriter::TYPE_U32);
+	writer.AddColumn(drops, "phy_tx_drop", ColumnarWriter::TYPE_U32);
+	writer.AddColumn(drops, "phy_rx_drop", ColumnarWriter::TYPE_U32);
+	writer.PutUint(drops, 0, m_macTxDrop);
+	writer.PutUint(drops, 1, m_phyTxDrop);
+	writer.PutUint(drops, 2, m_phyRxDrop);
+	writer.EndRow(drops);
+
+	uint32_t stats = writer.AddTable("network_stats");
+	writer.AddColumn(stats, "time", ColumnarWriter::TYPE_F64);
+	writer.AddColumn(stats, "flows", ColumnarWriter::TYPE_U32);
+	writer.AddColumn(stats, "avg_tx_packets", ColumnarWriter::TYPE_U32);
+	writer.AddColumn(stats, "avg_rx_packets", ColumnarWriter::TYPE_U32);
+	writer.AddColumn(stats, "avg_tx_bytes", ColumnarWriter::TYPE_U64);
+	writer.AddColumn(stats, "avg_rx_bytes", ColumnarWriter::TYPE_U64);
+	writer.AddColumn(stats, "avg_drop_packets", ColumnarWriter::TYPE_U32);
+	writer.AddColumn(stats, "avg_lost_packets", ColumnarWriter::TYPE_U32);
+	writer.AddColumn(stats, "avg_delivery_ratio", ColumnarWriter::TYPE_F64);
+	writer.AddColumn(stats, "avg_lost_ratio", ColumnarWriter::TYPE_F64);
+	writer.AddColumn(stats, "avg_throughput", ColumnarWriter::TYPE_F64);
+	writer.AddColumn(stats, "avg_mean_delay", ColumnarWriter::TYPE_F64);
+	writer.AddColumn(stats, "avg_mean_jitter", ColumnarWriter::TYPE_F64);
+	for(uint32_t i = 0; i < m_netStat.size(); i++)
+	{
+		const NetworkStat_s & ns = m_netStat[i];
+		writer.PutDouble(stats, 0, ns.time);
+		writer.PutUint(stats, 1, ns.numOfFlows);
+		writer.PutUint(stats, 2, ns.avgTxPacket);
+		writer.PutUint(stats, 3, ns.avgRxPacket);
+		writer.PutUint(stats, 4, ns.avgTxBytes);
+		writer.PutUint(stats, 5, ns.avgRxBytes);
+		writer.PutUint(stats, 6, ns.avgDropPacket);
+		writer.PutUint(stats, 7, ns.avgLostPacket);
+		writer.PutDouble(stats, 8, ns.avgPacketDeliveryRatio);
+		writer.PutDouble(stats, 9, ns.avgLostPacketRatio);
+		writer.PutDouble(stats, 10, ns.avgThroughput);
+		writer.PutDouble(stats, 11, ns.avgMeanDelay);
+		writer.PutDouble(stats, 12, ns.avgMeanJitter);
+		writer.EndRow(stats);
+	}
+}
+
 void
 NetworkData::ExportSummary()
 {
 //	std::fstream file;
 //	std::string fileName = MakeFileName("network_stats_summary", ".txt");
 //	file.open(fileName.c_str(), std::fstream::out);
-//	file << "Total Flows:\t" << m_flows.size() << "\n";
+//	file << "Total Flows:\t" << m_knownFlows << "\n";
 //	file << "Total Tx Packets\t" << m_txPacketsum << "\n";
 //	file << "Total Rx Packets\t" << m_rxPacketsum << "\n";
 //	file << "Total Tx Bytes\t" << m_txBytesSum << "\n";
@@ -116,8 +170,8 @@ NetworkData::ExportSummary()
 //	file << "Total Drop Packets\t" << m_dropPacketsum << "\n";
 //
 //	file << "Total Lost Packets\t" << m_lostPacketsum << "\n";
-//	file << "Total Lost Packet Ratio (%)\t" << (m_lostPacketRatioSum/m_flows.size()) << "\n";
-//	file << "Total Delivered Packets Ratio(%)\t" << (m_packetDeliverySum / m_flows.size()) << "\n";
+//	file << "Total Lost Packet Ratio (%)\t" << (m_lostPacketRatioSum/m_knownFlows) << "\n";
+//	file << "Total Delivered Packets Ratio(%)\t" << (m_packetDeliverySum / m_knownFlows) << "\n";
 //	file << "Total Mac Tx Drop\t" << m_macTxDrop << "\n";
 //	file << "Total Phy Tx Drop\t" << m_phyTxDrop << "\n";
 //	file << "Total Phy Rx Drop\t" << m_phyRxDrop << "\n";
@@ -130,10 +184,14 @@ void
 NetworkData::ProcessTraffic()
 {
 	NS_LOG_UNCOND("Processing Traffic");
-	Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier>(
-			m_flowmonHelper.GetClassifier());
 
-	std::map<FlowId, FlowMonitor::FlowStats> stats = m_monitor->GetFlowStats();
+	// lost packets are only counted once checked
+	m_monitor->CheckForLostPackets();
+	const std::map<FlowId, FlowMonitor::FlowStats> & stats = m_monitor->GetFlowStats();
+
+	double now = Simulator::Now().GetSeconds();
+	double interval = now - m_lastSampleTime;
+	m_lastSampleTime = now;
 
 	uint32_t txPacketsum = 0;
 	uint32_t rxPacketsum = 0;
@@ -150,40 +208,111 @@ NetworkData::ProcessTraffic()
 
 	uint32_t flowCounter = 0;
 
-	for (std::map<FlowId, FlowMonitor::FlowStats>::iterator flow =
-			stats.begin(); flow != stats.end(); flow++) {
-//		NS_LOG_UNCOND("Flow exist");
-		if(!FlowIdExist(flow->first))
+	// the flow ids are handed out in increasing order, the flows above
+	// the last one seen are new since the previous sample
+	for (std::map<FlowId, FlowMonitor::FlowStats>::const_iterator flow =
+			stats.lower_bound(m_nextFlowId); flow != stats.end(); flow++) {
+		m_activeFlows.insert(flow->first);
+		m_knownFlows++;
+		m_nextFlowId = flow->first + 1;
+	}
+
+	// only the change of each active flow since the previous sample is used,
+	// flows without packets in the interval are skipped after a comparison
+	std::set<FlowId>::iterator active = m_activeFlows.begin();
+	while (active != m_activeFlows.end()) {
+		std::map<FlowId, FlowMonitor::FlowStats>::const_iterator flow = stats.find(*active);
+		if(flow == stats.end())
 		{
-			m_flows.push_back(flow->first);
+			m_activeFlows.erase(active++);
+			continue;
 		}
-		flowCounter++;
-
-
-//		Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow(flow->first);
-
-		txBytesSum += flow->second.txBytes;
-		rxBytesSum += flow->second.rxBytes;
-		txPacketsum += flow->second.txPackets;
-		rxPacketsum += flow->second.rxPackets;
-		lostPacketsum += flow->second.lostPackets;
-		dropPacketsum += flow->second.packetsDropped.size();
-
-//		lostPacketRatioSum += ((double) flow->second.txPackets - (double) flow->second.rxPackets) / (double) flow->second.txPackets;
+		if(flow->first >= m_flowSnapshots.size())
+		{
+			FlowSnapshot_s empty = {0, 0, 0, 0, 0, 0, 0, 0};
+			m_flowSnapshots.resize(flow->first + 1, empty);
+		}
+		FlowSnapshot_s & prev = m_flowSnapshots[flow->first];
+		const FlowMonitor::FlowStats & fs = flow->second;
 
-		lostPacketRatioSum += ((lostPacketsum / txPacketsum) * 100);
+		uint32_t dropped = 0;
+		for(uint32_t i = 0; i < fs.packetsDropped.size(); i++)
+		{
+			dropped += fs.packetsDropped[i];
+		}
+		// every packet sent is accounted for, nothing more will change
+		bool finished = fs.txPackets == fs.rxPackets + fs.lostPackets + dropped;
 
-		packetDeliverySum += ((rxPacketsum/txPacketsum) * 100);
+		if(fs.txPackets == prev.txPackets && fs.rxPackets == prev.rxPackets
+				&& fs.lostPackets == prev.lostPackets && dropped == prev.dropped)
+		{
+			if(finished)
+			{
+				m_activeFlows.erase(active++);
+			}
+			else
+			{
+				active++;
+			}
+			continue;
+		}
 
-		throughputSum += (flow->second.rxBytes * 8.0 / (flow->second.timeLastRxPacket.GetSeconds()-flow->second.timeFirstTxPacket.GetSeconds())/(1024*1024));
+		uint32_t tx = fs.txPackets - prev.txPackets;
+		uint32_t rx = fs.rxPackets - prev.rxPackets;
+		uint32_t lost = fs.lostPackets - prev.lostPackets;
+		uint64_t rxBytes = fs.rxBytes - prev.rxBytes;
+		double delay = fs.delaySum.GetSeconds() - prev.delaySum;
+		double jitter = fs.jitterSum.GetSeconds() - prev.jitterSum;
 
-		meanDelaySum += (flow->second.delaySum.GetSeconds() / flow->second.rxPackets);
+		flowCounter++;
+		txBytesSum += fs.txBytes - prev.txBytes;
+		rxBytesSum += rxBytes;
+		txPacketsum += tx;
+		rxPacketsum += rx;
+		lostPacketsum += lost;
+		dropPacketsum += dropped - prev.dropped;
+
+		if(tx > 0)
+		{
+			lostPacketRatioSum += (static_cast<double>(lost) / tx) * 100;
+			packetDeliverySum += (static_cast<double>(rx) / tx) * 100;
+		}
+		if(interval > 0)
+		{
+			throughputSum += (rxBytes * 8.0 / interval / (1024*1024));
+		}
+		if(rx > 0)
+		{
+			meanDelaySum += delay / rx;
+			meanJitterSum += jitter / rx;
+		}
 
-		meanJitterSum += (flow->second.jitterSum.GetSeconds()
-						/ (flow->second.rxPackets));
+		prev.txPackets = fs.txPackets;
+		prev.rxPackets = fs.rxPackets;
+		prev.lostPackets = fs.lostPackets;
+		prev.dropped = dropped;
+		prev.txBytes = fs.txBytes;
+		prev.rxBytes = fs.rxBytes;
+		prev.delaySum = fs.delaySum.GetSeconds();
+		prev.jitterSum = fs.jitterSum.GetSeconds();
 
+		if(finished)
+		{
+			m_activeFlows.erase(active++);
+		}
+		else
+		{
+			active++;
+		}
 	}
 
+	m_txPacketsum += txPacketsum;
+	m_rxPacketsum += rxPacketsum;
+	m_dropPacketsum += dropPacketsum;
+	m_lostPacketsum += lostPacketsum;
+	m_txBytesSum += txBytesSum;
+	m_rxBytesSum += rxBytesSum;
+
 	// calculating averages
 
 	CalculateAverage(txPacketsum,
@@ -197,8 +326,6 @@ NetworkData::ProcessTraffic()
 			throughputSum,
 			meanDelaySum, meanJitterSum, flowCounter);
 
-	Simulator::Schedule(Seconds(m_timeInterval), &NetworkData::ProcessTraffic, this);
-
 }
 
 
@@ -223,19 +350,6 @@ NetworkData::PhyRxDrop(Ptr<const Packet> p)
 	m_phyRxDrop++;
 }
 
-bool
-NetworkData::FlowIdExist(FlowId id)
-{
-	for(uint32_t i = 0; i < m_flows.size(); i++)
-	{
-		if(id == m_flows[i])
-		{
-			return true;
-		}
-	}
-	return false;
-}
-
 void
 NetworkData::CalculateAverage(uint32_t txPacketsum,
 		uint32_t rxPacketsum,
@@ -253,7 +367,7 @@ NetworkData::CalculateAverage(uint32_t txPacketsum,
 	{
 //		NS_LOG_UNCOND("Mean Delay Sum" << m_meanDelaySum);
 		s.numOfFlows = flowCounter;
-		s.avgDropPacket = meanDelaySum / s.numOfFlows;
+		s.avgDropPacket = dropPacketsum / s.numOfFlows;
 		s.avgLostPacket = lostPacketsum / s.numOfFlows;
 		s.avgLostPacketRatio = (lostPacketRatioSum / s.numOfFlows);
 		s.avgMeanDelay = meanDelaySum / s.numOfFlows;
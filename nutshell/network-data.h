@@ -26,6 +26,7 @@
 #define SCRATCH_NUTSHELL_NETWORK_DATA_H_
 
 #include <vector>
+#include <set>
 #include "ns3/core-module.h"
 #include "ns3/flow-monitor-module.h"
 #include "nutshell-data-collector.h"
@@ -39,6 +40,10 @@ public:
 	/**
 	 * \brief Process network traffic data
 	 *
+	 * The statistics of each record cover the flows that sent, received,
+	 * lost or dropped packets since the previous record. Only the active
+	 * flows are visited, a flow stops being active once each of its sent
+	 * packets is received, lost or dropped.
 	 */
 	void ProcessTraffic();
 private:
@@ -73,7 +78,24 @@ private:
 	uint32_t m_phyTxDrop; //!< Physical layer Tx drop counter
 	uint32_t m_phyRxDrop; //!< Physical layer Rx drop counter
 
-	std::vector<FlowId> m_flows; //!< Keeps list of flow IDs
+	/**
+	 * \brief The counters of a flow at the previous sample
+	 */
+	struct FlowSnapshot_s {
+		uint32_t txPackets;
+		uint32_t rxPackets;
+		uint32_t lostPackets;
+		uint32_t dropped;
+		uint64_t txBytes;
+		uint64_t rxBytes;
+		double delaySum;
+		double jitterSum;
+	};
+	std::vector<FlowSnapshot_s> m_flowSnapshots; //!< Flow counters at previous sample, indexed by FlowId
+	uint32_t m_knownFlows; //!< The number of flows seen so far
+	FlowId m_nextFlowId; //!< The lowest FlowId not seen yet
+	std::set<FlowId> m_activeFlows; //!< Flows with packets still in flight
+	double m_lastSampleTime; //!< The time of previous sample
 
 
 	uint32_t m_txPacketsum; //!< Sum of transmitted packets
@@ -90,6 +112,14 @@ private:
 
 	virtual void AttachTraceSink();
 	virtual void ExportData();
+	/**
+	 * \brief Exports the drop counters and network stats as tables
+	 */
+	virtual void ExportBinary(ColumnarWriter & writer);
+	/**
+	 * \brief Processes the traffic, on the ticks of sampling clock
+	 */
+	virtual void Sample();
 
 	/**
 	 * \brief Counts MAC transmitted packet drop
@@ -105,12 +135,6 @@ private:
 	 * \brief Counts Physical layer received packet drop
 	 */
 	void PhyRxDrop(Ptr<const Packet> p);
-	/**
-	 * \brief Checks if flow is counted
-	 * \param id FlowId
-	 * \return True if id exist, false otherwise.
-	 */
-	bool FlowIdExist(FlowId id);
 	/**
 	 * \brief Calculate average and add to list
 	 */
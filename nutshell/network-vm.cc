@@ -119,13 +119,20 @@ NetworkVm::GetTypeId()
 										TimeValue(MilliSeconds(12)),
 										MakeTimeAccessor(&NetworkVm::m_hddAccTime),
 										MakeTimeChecker())
+						.AddAttribute("FlowNetwork",
+										"The flow network to transfer data as flows, packets are sent when not set",
+										PointerValue(),
+										MakePointerAccessor(&NetworkVm::m_flowNetwork),
+										MakePointerChecker<FlowNetwork>())
 						;
 	return tid;
 }
 
 NetworkVm::NetworkVm()
 	: m_dataSize("0"),
-	  m_vmTransmissionRate("100Kbps")
+	  m_vmTransmissionRate("100Kbps"),
+	  m_flowId(0),
+	  m_flowBound(false)
 {
 	NS_LOG_FUNCTION(this);
 	m_mtu = 1500;
@@ -165,6 +172,12 @@ NetworkVm::GetPeerPort() const
 	return m_peerPort;
 }
 
+uint16_t
+NetworkVm::GetListeningPort() const
+{
+	return m_listeningPort;
+}
+
 void
 NetworkVm::SetVmTransmissionRate(const DataRate & transRate)
 {
@@ -213,6 +226,24 @@ NetworkVm::SetSocketType(std::string t)
 	m_tid = TypeId::LookupByName (t);;
 }
 
+void
+NetworkVm::SetSocketType(TypeId tid)
+{
+	m_tid = tid;
+}
+
+
+void
+NetworkVm::SetFlowNetwork(Ptr<FlowNetwork> network)
+{
+	m_flowNetwork = network;
+}
+
+bool
+NetworkVm::IsFlowLevel() const
+{
+	return m_flowNetwork != 0;
+}
 
 void
 NetworkVm::SetUseLocalDataProcessing(bool v)
@@ -293,11 +324,45 @@ void
 NetworkVm::DoDispose()
 {
 	NS_LOG_FUNCTION(this);
+	Simulator::Cancel(m_sendEvent);
+	Simulator::Cancel(m_requestEvent);
+	// a closed TCP socket lives on until its close handshake is done,
+	// it must not call back into a disposed VM
+	DetachSocket(m_socket);
+	DetachSocket(m_listeningSocket);
+	while(!m_socketList.empty())
+	{
+		DetachSocket(m_socketList.front());
+		m_socketList.pop_front();
+	}
+	while(!m_closedSockets.empty())
+	{
+		DetachSocket(m_closedSockets.front());
+		m_closedSockets.pop_front();
+	}
+	m_controlStream.Clear();
 	m_socket = 0;
 	m_listeningSocket = 0;
+	m_flowNetwork = 0;
 	VirtualMachine::DoDispose();
 }
 
+void
+NetworkVm::DetachSocket(Ptr<Socket> socket)
+{
+	if(socket == 0)
+	{
+		return;
+	}
+	socket->SetRecvCallback(MakeNullCallback<void, Ptr<Socket> >());
+	socket->SetCloseCallbacks(MakeNullCallback<void, Ptr<Socket> >(),
+			MakeNullCallback<void, Ptr<Socket> >());
+	socket->SetConnectCallback(MakeNullCallback<void, Ptr<Socket> >(),
+			MakeNullCallback<void, Ptr<Socket> >());
+	socket->SetAcceptCallback(MakeNullCallback<bool, Ptr<Socket>, const Address &>(),
+			MakeNullCallback<void, Ptr<Socket>, const Address &>());
+}
+
 /*---------------------------------------- Socket area -------------------------*/
 
 void
@@ -366,13 +431,21 @@ NetworkVm::CloseListeningSocket()
 		Ptr<Socket> acceptedSocket = m_socketList.front();
 		m_socketList.pop_front();
 		acceptedSocket->Close();
+		m_controlStream.Remove(acceptedSocket);
+		m_closedSockets.push_back(acceptedSocket);
 	}
 	if (m_listeningSocket)
 	{
 		m_listeningSocket->Close();
 		m_listeningSocket->SetRecvCallback(MakeNullCallback<void, Ptr<Socket> >());
+		m_closedSockets.push_back(m_listeningSocket);
 		m_listeningSocket = 0;
 	}
+	if(m_flowBound)
+	{
+		m_flowNetwork->Unbind(GetNode(), m_listeningPort);
+		m_flowBound = false;
+	}
 }
 
 void
@@ -381,8 +454,18 @@ NetworkVm::CloseTransmittingSocket()
 	if(m_socket != 0)
 	{
 		m_socket->Close();
+		m_controlStream.Remove(m_socket);
+		m_closedSockets.push_back(m_socket);
 		m_socket = 0;
 	}
+	else if(m_flowNetwork != 0)
+	{
+		if(m_flowId != 0)
+		{
+			m_flowNetwork->CancelFlow(m_flowId);
+			m_flowId = 0;
+		}
+	}
 	else
 	{
 		NS_LOG_WARN ("VM found null socket to close in StopApplication");
@@ -402,23 +485,56 @@ NetworkVm::CloseSocket()
 
 
 void
-NetworkVm::RetransmitRequest(std::string s, Ptr<Socket> socket)
+NetworkVm::RetransmitRequest(const VmControlHeader & control, Ptr<Socket> socket)
 {
-
-	ScheduleReTransmit(socket, Storage(ExtractData(s)));
+	NS_LOG_FUNCTION(this);
+	ScheduleReTransmit(socket, Storage(control.GetDataAmount()));
 }
 
 /*---------------------------------------- end Handlers  --------------------*/
 
-std::string
-NetworkVm::GetPacketString(Ptr<Packet> packet)
+bool
+NetworkVm::ReadControl(Ptr<Socket> socket, VmControlHeader & control)
 {
-	std::ostringstream *os = new std::ostringstream();
-	packet->CopyData(os, (packet->GetSize() - 1));
-	std::string s = os->str();
-	 //first splitting the string in half to access rate and required data
-	NS_LOG_INFO("String received: " << s);
-	return s;
+	NS_LOG_FUNCTION(this);
+	if(!m_controlStream.Next(socket, control))
+	{
+		return false;
+	}
+	NS_LOG_INFO("Control received: " << control);
+	return true;
+}
+
+void
+NetworkVm::BindFlowReceiver(FlowNetwork::ReceiveCallback cb)
+{
+	NS_LOG_FUNCTION(this);
+	m_flowNetwork->Bind(GetNode(), m_listeningPort, cb);
+	m_flowBound = true;
+}
+
+void
+NetworkVm::RequestFlow(uint64_t bytes)
+{
+	NS_LOG_FUNCTION(this << bytes);
+	m_flowNetwork->Request(GetNode(), m_listeningPort, Ipv4Address::ConvertFrom(m_remoteAddress),
+			m_peerPort, bytes, m_vmTransmissionRate);
+}
+
+void
+NetworkVm::FlowSent()
+{
+	NS_LOG_FUNCTION(this);
+	m_flowId = 0;
+	m_sentBytes = m_dataSize;
+	TransmissionCompleted();
+}
+
+void
+NetworkVm::TransmissionCompleted()
+{
+	NS_LOG_FUNCTION(this);
+	ScheduleStop(0.0);
 }
 
 void
@@ -444,14 +560,11 @@ NetworkVm::ConnectionFailed(Ptr<Socket> socket)
 }
 
 Ptr<Packet>
-NetworkVm::CreatePacket(std::string fill)
-{
-	NS_LOG_FUNCTION(this << fill);
-	uint32_t dataSize = fill.size() + 1;
-	uint8_t *packetData = new uint8_t[dataSize];
-	memcpy(packetData, fill.c_str(), dataSize);
-	Ptr<Packet> p;
-	p = Create<Packet>(packetData, dataSize);
+NetworkVm::CreateControlPacket(VmControlHeader::Type_e type, uint64_t dataAmount)
+{
+	NS_LOG_FUNCTION(this << type << dataAmount);
+	Ptr<Packet> p = Create<Packet>();
+	p->AddHeader(VmControlHeader(type, dataAmount, m_vmTransmissionRate));
 	return p;
 }
 
@@ -483,7 +596,7 @@ NetworkVm::ScheduleReTransmit(Ptr<Socket> socket, Storage reqData)
 	if(reqData.GetStorage() > 0)
 	{
 		double delay = (m_mtu * 8)/static_cast<double>(m_vmTransmissionRate.GetBitRate ());
-		Simulator::Schedule(Seconds(delay), &NetworkVm::SendRt, this, socket, reqData);
+		m_requestEvent = Simulator::Schedule(Seconds(delay), &NetworkVm::SendRt, this, socket, reqData);
 	}
 }
 
@@ -492,7 +605,30 @@ NetworkVm::BeginTransmission()
 {
 	NS_LOG_FUNCTION(this);
 
-	if(m_connected)
+	if(m_flowNetwork != 0)
+	{
+		/*
+		 * The whole data is a single flow, its completion
+		 * is reported by FlowSent.
+		 */
+		if(m_flowId == 0 && m_sentBytes < m_dataSize)
+		{
+			Ptr<Node> dst = m_flowNetwork->GetNode(Ipv4Address::ConvertFrom(m_remoteAddress));
+			if(dst == 0)
+			{
+				NS_LOG_ERROR(this << "Cannot begin transmission, no node has the destination address");
+				return;
+			}
+			Storage bytesLeft = m_dataSize - m_sentBytes;
+			m_flowId = m_flowNetwork->StartFlow(GetNode(), dst, m_peerPort, bytesLeft.GetStorage(),
+					m_vmTransmissionRate, MakeCallback(&NetworkVm::FlowSent, this));
+		}
+		else if(m_flowId == 0)
+		{
+			TransmissionCompleted();
+		}
+	}
+	else if(m_connected)
 	{
 		if(m_sentBytes < m_dataSize)
 		{
@@ -536,7 +672,7 @@ void
 NetworkVm::ScheduleStop(double delay)
 {
 	NS_LOG_FUNCTION(this);
-	Simulator::Schedule(Seconds(delay), &NetworkVm::StopApplication, this);
+	m_finishEvent = Simulator::Schedule(Seconds(delay), &NetworkVm::StopApplication, this);
 }
 void
 NetworkVm::Send(Ptr<Packet> packet)
@@ -602,20 +738,6 @@ NetworkVm::SendRt(Ptr<Socket> socket, Storage reqData)
 	}
 }
 
-uint64_t
-NetworkVm::ExtractData(std::string s)
-{
-	NS_LOG_FUNCTION(this);
-	std::string::size_type n = s.find_first_of("0123456789.");
-	std::istringstream iss;
-	iss.str(s.substr(n, std::string::npos));
-	NS_LOG_INFO("Extracted Value: " << s.substr(n, std::string::npos));
-	double r;
-	iss >> r;
-	return (uint64_t)r;
-}
-
-
 Ptr<Socket>
 NetworkVm::GetSocket() const
 {
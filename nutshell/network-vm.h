@@ -10,6 +10,8 @@
 
 #include "storage-util.h"
 #include "virtual-machine.h"
+#include "flow-network.h"
+#include "vm-control-header.h"
 #include "ns3/application.h"
 #include "ns3/address.h"
 #include "ns3/event-id.h"
@@ -37,6 +39,16 @@ public:
 	void SetDataSize(const Storage & dataSize);
 	void SetMtu(uint32_t mtu);
 	void SetSocketType(std::string t);
+	/**
+	 * \brief Set the socket type without looking the name up
+	 * \param tid The TypeId of socket factory
+	 */
+	void SetSocketType(TypeId tid);
+	/**
+	 * \brief Set the flow network, the VM transfers data as flows instead of packets
+	 * \param network The flow network of datacenter, 0 for packet transfer
+	 */
+	void SetFlowNetwork(Ptr<FlowNetwork> network);
 
 	void SetUseLocalDataProcessing(bool v);
 
@@ -49,10 +61,18 @@ public:
 
 	Address GetRemoteAddress() const;
 	uint16_t GetPeerPort() const;
+	/**
+	 * \return The port the VM listens on, 0 if none
+	 */
+	uint16_t GetListeningPort() const;
 	DataRate GetVmTransmissionRate() const;
 	Storage GetDataSize() const;
 	bool GetConnectionStatus() const;
 	uint32_t GetMtu() const;
+	/**
+	 * \return true if the VM transfers data as flows
+	 */
+	bool IsFlowLevel() const;
 
 	bool IsUseLocalDataProcessingEnabled() const;
 	Storage GetHddRwRate() const;
@@ -77,7 +97,13 @@ protected:
 	virtual void ConnectionSucceeded(Ptr<Socket> socket);
 	virtual void ConnectionFailed(Ptr<Socket> socket);
 
-	virtual Ptr<Packet> CreatePacket(std::string fill);
+	/**
+	 * \brief Creates a packet carrying a control message
+	 * \param type The type of message
+	 * \param dataAmount The amount of data requested in bytes
+	 * \return The packet, the rate of message is the transmission rate of VM
+	 */
+	virtual Ptr<Packet> CreateControlPacket(VmControlHeader::Type_e type, uint64_t dataAmount);
 	virtual Ptr<Packet> CreatePacket(Storage dataSize);
 	virtual Ptr<Packet> CreatePacket(uint32_t dataSize);
 
@@ -99,15 +125,39 @@ protected:
 	Storage GetSentBytes() const;
 	void SetSentBytes(Storage s);
 
-	void RetransmitRequest(std::string s, Ptr<Socket> socket);
+	void RetransmitRequest(const VmControlHeader & control, Ptr<Socket> socket);
 
-	std::string GetPacketString(Ptr<Packet> packet);
+	/**
+	 * \brief Removes the next control message received on a socket
+	 *
+	 * The received bytes are first handed to m_controlStream, a message
+	 * split across reads is returned once its remaining bytes arrive.
+	 *
+	 * \param socket The socket the message was received on
+	 * \param control The header to fill
+	 * \return false if the socket holds no complete message
+	 */
+	bool ReadControl(Ptr<Socket> socket, VmControlHeader & control);
 
 	/**
-	* \brief Extract data from string i.e. extract Required Data and Rate of VM Request
-	* \param s a string value of specific format
-	*/
-	uint64_t ExtractData(std::string s);
+	 * \brief Binds the listening port of VM on the flow network
+	 * \param cb The callback receiving the bytes of each delivered flow
+	 */
+	void BindFlowReceiver(FlowNetwork::ReceiveCallback cb);
+	/**
+	 * \brief Requests data from the remote server over the flow network
+	 *
+	 * The data is delivered to the listening port bound by BindFlowReceiver.
+	 *
+	 * \param bytes The amount of data requested
+	 */
+	void RequestFlow(uint64_t bytes);
+	/**
+	 * \brief Called when the data sent as a flow is delivered
+	 *
+	 * The default stops the VM, as the consumer acknowledging the data would.
+	 */
+	virtual void TransmissionCompleted();
 
 	TypeId				m_tid;
 	Ptr<Socket>			m_socket;
@@ -134,16 +184,24 @@ protected:
 
 
 	std::list<Ptr<Socket> > m_socketList; //!< the accepted sockets
+	EventId				m_sendEvent; //!< The scheduled transmission
 
 private:
+	/**
+	 * \brief Clears the callbacks of a socket so it no longer calls the VM
+	 * \param socket The socket to detach
+	 */
+	void DetachSocket(Ptr<Socket> socket);
+
+	std::list<Ptr<Socket> > m_closedSockets; //!< Closed sockets, their callbacks are cleared on dispose
+	VmControlStream m_controlStream; //!< Control messages not yet complete per socket
 
 	Storage				m_dataSize;
 	Storage				m_sentBytes;
 
 
 	DataRate			m_vmTransmissionRate;
-	EventId				m_requestEvent;
-	EventId				m_sendEvent;
+	EventId				m_requestEvent; //!< The scheduled retransmission of requested data
 	bool 				m_connected;
 	uint32_t			m_mtu;
 
@@ -157,6 +215,15 @@ private:
 	Time				m_memAccTime;
 	Time				m_hddAccTime;
 
+	Ptr<FlowNetwork>	m_flowNetwork; //!< The flow network, 0 for packet transfer
+	uint64_t			m_flowId; //!< The flow being sent, 0 if none
+	bool				m_flowBound; //!< true if the listening port is bound on flow network
+
+	/**
+	 * \brief Completion callback of the flow being sent
+	 */
+	void FlowSent();
+
 
 	// inherited from Application base class.
 	virtual void StartApplication (void);    // Called at time specified by Start
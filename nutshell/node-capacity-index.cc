@@ -0,0 +1,227 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *
+ * node-capacity-index.cc
+ *
+ *  Created on: Mar 2, 2017
+ *      Author: ubaid
+ *       Email: u.ur.rahman@gmail.com
+ */
+
+#include <algorithm>
+
+#include "ns3/log.h"
+#include "ns3/callback.h"
+
+#include "computational-node.h"
+#include "node-capacity-index.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("NodeCapacityIndex");
+
+NS_OBJECT_ENSURE_REGISTERED (NodeCapacityIndex);
+
+TypeId
+NodeCapacityIndex::GetTypeId ()
+{
+	static TypeId tid = TypeId("ns3::NodeCapacityIndex")
+		.SetParent (Object::GetTypeId())
+		.AddConstructor<NodeCapacityIndex> ()
+		;
+	return tid;
+}
+
+NodeCapacityIndex::NodeCapacityIndex()
+	: m_count (0),
+	  m_leaves (0)
+{
+	NS_LOG_FUNCTION(this);
+}
+
+NodeCapacityIndex::~NodeCapacityIndex()
+{
+	NS_LOG_FUNCTION(this);
+}
+
+void
+NodeCapacityIndex::DoDispose()
+{
+	NS_LOG_FUNCTION(this);
+	for(uint32_t i = 0; i < m_count; i++)
+	{
+		m_nodes.Get(i)->TraceDisconnectWithoutContext("ResourcesChanged",
+				MakeCallback(&NodeCapacityIndex::Update, this));
+	}
+	m_nodes = ComputationalNodeContainer();
+	m_tree.clear();
+	m_nodeIndex.clear();
+	m_count = 0;
+	Object::DoDispose();
+}
+
+void
+NodeCapacityIndex::Build(ComputationalNodeContainer nodes, uint32_t count)
+{
+	NS_LOG_FUNCTION(this << count);
+	NS_ASSERT(count <= nodes.GetN());
+
+	m_nodes = nodes;
+	m_count = count;
+
+	m_leaves = 1;
+	while(m_leaves < m_count)
+	{
+		m_leaves <<= 1;
+	}
+
+	Capacity_s empty = {0, 0, 0, 0, 0};
+	m_tree.assign(2 * m_leaves, empty);
+	m_nodeIndex.clear();
+
+	for(uint32_t i = 0; i < m_count; i++)
+	{
+		Ptr<ComputationalNode> n = m_nodes.Get(i);
+		if(n->GetId() >= m_nodeIndex.size())
+		{
+			m_nodeIndex.resize(n->GetId() + 1, -1);
+		}
+		m_nodeIndex[n->GetId()] = i;
+
+		m_tree[m_leaves + i] = MakeCapacity(n->GetProcessingPower(), n->GetPrimaryStorage(),
+				n->GetSecondaryStorage(), n->GetNicDataRate());
+
+		n->TraceConnectWithoutContext("ResourcesChanged", MakeCallback(&NodeCapacityIndex::Update, this));
+	}
+
+	for(uint32_t pos = m_leaves - 1; pos > 0; pos--)
+	{
+		const Capacity_s & l = m_tree[2 * pos];
+		const Capacity_s & r = m_tree[2 * pos + 1];
+		Capacity_s & c = m_tree[pos];
+		c.flops = std::max(l.flops, r.flops);
+		c.mips = std::max(l.mips, r.mips);
+		c.primary = std::max(l.primary, r.primary);
+		c.secondary = std::max(l.secondary, r.secondary);
+		c.nic = std::max(l.nic, r.nic);
+	}
+}
+
+int32_t
+NodeCapacityIndex::FindFirstFit(ProcessingPower p, Storage ps, Storage ss, DataRate r, uint32_t from)
+{
+	NS_LOG_FUNCTION(this << from);
+	if(m_count == 0 || from >= m_count)
+	{
+		return -1;
+	}
+	Capacity_s req = MakeCapacity(p, ps, ss, r);
+	return Search(1, 0, m_leaves, from, req, p, ps, ss, r);
+}
+
+void
+NodeCapacityIndex::Update(uint32_t nodeId)
+{
+	if(nodeId < m_nodeIndex.size() && m_nodeIndex[nodeId] >= 0)
+	{
+		UpdateLeaf(m_nodeIndex[nodeId]);
+	}
+}
+
+uint32_t
+NodeCapacityIndex::GetN() const
+{
+	return m_count;
+}
+
+NodeCapacityIndex::Capacity_s
+NodeCapacityIndex::MakeCapacity(ProcessingPower p, Storage ps, Storage ss, DataRate r) const
+{
+	Capacity_s c;
+	c.flops = p.IsFlops() ? p.GetProcessingPower() : 0;
+	c.mips = p.IsMips() ? p.GetProcessingPower() : 0;
+	c.primary = ps.GetStorage();
+	c.secondary = ss.GetStorage();
+	c.nic = r.GetBitRate();
+	return c;
+}
+
+bool
+NodeCapacityIndex::MayFit(const Capacity_s & c, const Capacity_s & req, bool flops) const
+{
+	/*
+	 * Same strict comparison as ComputationalNode, a request
+	 * fits only if it is less than the remaining amount.
+	 */
+	bool processing = flops ? (req.flops < c.flops) : (req.mips < c.mips);
+	return processing &&
+			req.primary < c.primary &&
+			req.secondary < c.secondary &&
+			req.nic < c.nic;
+}
+
+void
+NodeCapacityIndex::UpdateLeaf(uint32_t index)
+{
+	Ptr<ComputationalNode> n = m_nodes.Get(index);
+	uint32_t pos = m_leaves + index;
+	m_tree[pos] = MakeCapacity(n->GetProcessingPower(), n->GetPrimaryStorage(),
+			n->GetSecondaryStorage(), n->GetNicDataRate());
+
+	for(pos >>= 1; pos > 0; pos >>= 1)
+	{
+		const Capacity_s & l = m_tree[2 * pos];
+		const Capacity_s & r = m_tree[2 * pos + 1];
+		Capacity_s & c = m_tree[pos];
+		c.flops = std::max(l.flops, r.flops);
+		c.mips = std::max(l.mips, r.mips);
+		c.primary = std::max(l.primary, r.primary);
+		c.secondary = std::max(l.secondary, r.secondary);
+		c.nic = std::max(l.nic, r.nic);
+	}
+}
+
+int32_t
+NodeCapacityIndex::Search(uint32_t pos, uint32_t lo, uint32_t hi, uint32_t from, const Capacity_s & req,
+		ProcessingPower & p, Storage & ps, Storage & ss, DataRate & r)
+{
+	if(hi <= from || lo >= m_count || !MayFit(m_tree[pos], req, p.IsFlops()))
+	{
+		return -1;
+	}
+	if(pos >= m_leaves)
+	{
+		/*
+		 * The maxima of a range may come from different nodes,
+		 * so the leaf is confirmed by the node itself.
+		 */
+		if(m_nodes.Get(lo)->CheckAvailability(p, ps, ss, r))
+		{
+			return lo;
+		}
+		return -1;
+	}
+	uint32_t mid = lo + (hi - lo) / 2;
+	int32_t found = Search(2 * pos, lo, mid, from, req, p, ps, ss, r);
+	if(found < 0)
+	{
+		found = Search(2 * pos + 1, mid, hi, from, req, p, ps, ss, r);
+	}
+	return found;
+}
+
+} /* namespace ns3 */
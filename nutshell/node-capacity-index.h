@@ -0,0 +1,142 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *
+ * node-capacity-index.h
+ *
+ *  Created on: Mar 2, 2017
+ *      Author: ubaid
+ *       Email: u.ur.rahman@gmail.com
+ */
+
+#ifndef NUTSHELL_NODE_CAPACITY_INDEX_H
+#define NUTSHELL_NODE_CAPACITY_INDEX_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+#include "ns3/data-rate.h"
+
+#include "processing-power-util.h"
+#include "storage-util.h"
+#include "computational-node-container.h"
+
+namespace ns3 {
+
+/**
+ * \brief Capacity index over a range of computational nodes
+ *
+ * The index is a segment tree keeping, for every range of nodes, the
+ * maximum remaining processing power (separately for FLOPS and MIPS
+ * nodes), primary storage, secondary storage and NIC rate. A range
+ * whose maxima can not fit a request is skipped as a whole, so the
+ * first node that fits is found without checking every node.
+ *
+ * Ranges are visited from left to right and each candidate is confirmed
+ * with ComputationalNode::CheckAvailability, hence the node returned is
+ * exactly the one a linear first-fit walk over the container would pick.
+ *
+ * The index follows the nodes through their "ResourcesChanged" trace,
+ * every reservation or release updates a single leaf in O(log n).
+ */
+class NodeCapacityIndex : public Object {
+public:
+	/**
+	* \brief Get the type ID.
+	* \return the object TypeId
+	*/
+	static TypeId GetTypeId (void);
+	NodeCapacityIndex();
+	virtual ~NodeCapacityIndex();
+
+	/**
+	 * \brief Builds the index over the first nodes of a container
+	 *
+	 * \param nodes The container of computational nodes
+	 * \param count The number of nodes, from the start of container, to index
+	 */
+	void Build(ComputationalNodeContainer nodes, uint32_t count);
+
+	/**
+	 * \brief Finds the first node that can host the requested resources
+	 *
+	 * \param p The processing power requested
+	 * \param ps The primary storage requested
+	 * \param ss The secondary storage requested
+	 * \param r The NIC data rate requested
+	 * \param from The index of node to begin the search from
+	 * \return The index of node in container, -1 if no node fits
+	 */
+	int32_t FindFirstFit(ProcessingPower p, Storage ps, Storage ss, DataRate r, uint32_t from = 0);
+
+	/**
+	 * \brief Refreshes the entry of a node from its remaining resources
+	 *
+	 * \param nodeId The ID of the computational node
+	 */
+	void Update(uint32_t nodeId);
+
+	/**
+	 * \brief Get the number of indexed nodes
+	 * \return The number of nodes
+	 */
+	uint32_t GetN() const;
+
+protected:
+	virtual void DoDispose(void);
+
+private:
+	/**
+	 * \brief The remaining capacity of a node or the maximum of a range
+	 */
+	struct Capacity_s {
+		uint64_t flops, mips;
+		uint64_t primary, secondary;
+		uint64_t nic;
+	};
+
+	/**
+	 * \brief Converts the resources to index capacity
+	 */
+	Capacity_s MakeCapacity(ProcessingPower p, Storage ps, Storage ss, DataRate r) const;
+	/**
+	 * \brief Checks if a capacity may hold the request
+	 * \param flops true if the request is in FLOPS, false for MIPS
+	 */
+	bool MayFit(const Capacity_s & c, const Capacity_s & req, bool flops) const;
+	/**
+	 * \brief Sets the leaf of a node and updates its ranges
+	 * \param index The index of node in container
+	 */
+	void UpdateLeaf(uint32_t index);
+	/**
+	 * \brief Recursive first fit search over a range [lo, hi)
+	 */
+	int32_t Search(uint32_t pos, uint32_t lo, uint32_t hi, uint32_t from, const Capacity_s & req,
+			ProcessingPower & p, Storage & ps, Storage & ss, DataRate & r);
+
+	ComputationalNodeContainer m_nodes; //!< The indexed nodes
+	uint32_t m_count; //!< The number of indexed nodes
+	uint32_t m_leaves; //!< The number of leaves, power of two
+	std::vector<Capacity_s> m_tree; //!< The tree, root at 1 and leaves from m_leaves
+	std::vector<int32_t> m_nodeIndex; //!< Maps node ID to index in container
+};
+
+} /* namespace ns3 */
+
+#endif /* NUTSHELL_NODE_CAPACITY_INDEX_H */
@@ -31,15 +31,23 @@
 #include "ns3/log.h"
 #include "ns3/simulator.h"
 #include "ns3/nstime.h"
+#include "ns3/node-list.h"
 
 
 #include "node-data.h"
+#include "columnar-writer.h"
 
 namespace ns3 {
 
 NodeData::NodeData()
-	: NutshellDataCollector()
+	: NutshellDataCollector(),
+	  m_isExportIndividualNodeData(false),
+	  m_streaming(false),
+	  m_utilizedNodes(0)
 {
+	m_utilizationSum.processing = 0;
+	m_utilizationSum.primaryStorage = 0;
+	m_utilizationSum.secondaryStorage = 0;
 }
 
 void
@@ -57,7 +65,12 @@ NodeData::AttachTraceSink()
 {
 //	NS_LOG_UNCOND("Attaching sink: " <<&NodeData::UtilizationSink);
 	Config::ConnectWithoutContext("/NodeList/*/$ns3::NodeUtilization/UtilizedResources", MakeCallback(&NodeData::UtilizationSink, this));
+	Resize(NodeList::GetNNodes());
+}
 
+void
+NodeData::Sample()
+{
 	MapUtilization();
 }
 
@@ -79,21 +92,24 @@ NodeData::ExportData()
 	file.close();
 	if(m_isExportIndividualNodeData)
 	{
-		std::map<uint32_t, std::vector<MappedUtilization_s> >::iterator it;
-		for(it = m_nodeUtilization.begin(); it != m_nodeUtilization.end(); it++)
+		for(uint32_t nodeId = 0; nodeId < m_nodeUtilization.size(); nodeId++)
 		{
+			if(m_nodeUtilization[nodeId].empty())
+			{
+				continue;
+			}
 			std::fstream f;
-			std::string fname = MakeFileName(it->first, ".csv");
+			std::string fname = MakeFileName(nodeId, ".csv");
 			fname = StringConcat(m_simulationPrefix, fname);
 			f.open(fname.c_str(), std::fstream::out);
 
 			f << "Time, Node ID, Processing Power, Primary Storage, Secondary Storage\n";
 
-			std::vector<MappedUtilization_s> wnu = it->second;
+			const std::vector<MappedUtilization_s> & wnu = m_nodeUtilization[nodeId];
 			for(uint32_t i = 0; i < wnu.size(); i++) {
 				MappedUtilization_s mnu = wnu[i];
 
-				f << mnu.seconds << "," << it->first << "," << mnu.utilization.processing << ","
+				f << mnu.seconds << "," << nodeId << "," << mnu.utilization.processing << ","
 						<< mnu.utilization.primaryStorage << "," << mnu.utilization.secondaryStorage << "\n";
 
 			}
@@ -105,7 +121,75 @@ NodeData::ExportData()
 
 }
 
+void
+NodeData::ExportBinary(ColumnarWriter & writer)
+{
+	uint32_t avg = writer.AddTable("avg_node_utilization");
+	writer.AddColumn(avg, "time", ColumnarWriter::TYPE_F64);
+	writer.AddColumn(avg, "utilized_nodes", ColumnarWriter::TYPE_U32);
+	writer.AddColumn(avg, "processing", ColumnarWriter::TYPE_F64);
+	writer.AddColumn(avg, "primary_storage", ColumnarWriter::TYPE_F64);
+	writer.AddColumn(avg, "secondary_storage", ColumnarWriter::TYPE_F64);
+	for(uint32_t i = 0; i < m_avgUtilization.size(); i++)
+	{
+		const AvgUtilization_s & au = m_avgUtilization[i];
+		writer.PutDouble(avg, 0, au.seconds);
+		writer.PutUint(avg, 1, au.total_nodes);
+		writer.PutDouble(avg, 2, au.utilization.processing);
+		writer.PutDouble(avg, 3, au.utilization.primaryStorage);
+		writer.PutDouble(avg, 4, au.utilization.secondaryStorage);
+		writer.EndRow(avg);
+	}
+
+	if(!m_isExportIndividualNodeData)
+	{
+		return;
+	}
+	// all nodes in one table instead of a file per node
+	uint32_t nodes = writer.AddTable("node_utilization");
+	writer.AddColumn(nodes, "time", ColumnarWriter::TYPE_F64);
+	writer.AddColumn(nodes, "node_id", ColumnarWriter::TYPE_U32);
+	writer.AddColumn(nodes, "processing", ColumnarWriter::TYPE_F64);
+	writer.AddColumn(nodes, "primary_storage", ColumnarWriter::TYPE_F64);
+	writer.AddColumn(nodes, "secondary_storage", ColumnarWriter::TYPE_F64);
+	for(uint32_t nodeId = 0; nodeId < m_nodeUtilization.size(); nodeId++)
+	{
+		for(uint32_t i = 0; i < m_nodeUtilization[nodeId].size(); i++)
+		{
+			const MappedUtilization_s & mnu = m_nodeUtilization[nodeId][i];
+			writer.PutDouble(nodes, 0, mnu.seconds);
+			writer.PutUint(nodes, 1, nodeId);
+			writer.PutDouble(nodes, 2, mnu.utilization.processing);
+			writer.PutDouble(nodes, 3, mnu.utilization.primaryStorage);
+			writer.PutDouble(nodes, 4, mnu.utilization.secondaryStorage);
+			writer.EndRow(nodes);
+		}
+	}
+}
+
+void
+NodeData::StartStreaming()
+{
+	std::string fileName = MakeFileName("avg-node-utilization-data", ".csv");
+	m_avgStream.Open(StringConcat(m_simulationPrefix, fileName),
+			"Time,Utilized Nodes, Average Processing Power, Average Primary Storage, Average Secondary Storage", 5);
+	if(m_isExportIndividualNodeData)
+	{
+		// all nodes in one file instead of a file per node
+		fileName = MakeFileName("node-utilization-data", ".csv");
+		m_nodeStream.Open(StringConcat(m_simulationPrefix, fileName),
+				"Time, Node ID, Processing Power, Primary Storage, Secondary Storage", 5);
+	}
+	m_streaming = true;
+}
 
+void
+NodeData::StopStreaming()
+{
+	m_avgStream.Close();
+	m_nodeStream.Close();
+	m_streaming = false;
+}
 
 void
 NodeData::UtilizationSink(double p, double ps, double ss, uint32_t nodeId)
@@ -121,9 +205,62 @@ NodeData::UtilizationSink(double p, double ps, double ss, uint32_t nodeId)
 			t, nu
 	};
 
-	m_nodeUtilization[nodeId].push_back(utilization);
-	m_currentNodeUtilization[nodeId] = nu;
+	if(nodeId >= m_currentNodeUtilization.size())
+	{
+		Resize(nodeId + 1);
+	}
+	if(!m_streaming)
+	{
+		m_nodeUtilization[nodeId].push_back(utilization);
+	}
+	else if(m_isExportIndividualNodeData)
+	{
+		double row[5] = {t, static_cast<double>(nodeId), p, ps, ss};
+		m_nodeStream.Append(row);
+	}
+
+	// replace the node in the running sums
+	NodeUtilization_s & current = m_currentNodeUtilization[nodeId];
+	if(IsUtilized(current))
+	{
+		m_utilizationSum.processing -= current.processing;
+		m_utilizationSum.primaryStorage -= current.primaryStorage;
+		m_utilizationSum.secondaryStorage -= current.secondaryStorage;
+		m_utilizedNodes--;
+	}
+	if(IsUtilized(nu))
+	{
+		m_utilizationSum.processing += nu.processing;
+		m_utilizationSum.primaryStorage += nu.primaryStorage;
+		m_utilizationSum.secondaryStorage += nu.secondaryStorage;
+		m_utilizedNodes++;
+	}
+	if(m_utilizedNodes == 0)
+	{
+		// drops the rounding error left by the subtractions
+		m_utilizationSum.processing = 0;
+		m_utilizationSum.primaryStorage = 0;
+		m_utilizationSum.secondaryStorage = 0;
+	}
+	current = nu;
+}
+
+bool
+NodeData::IsUtilized(const NodeUtilization_s & nu)
+{
+	return nu.primaryStorage != 0 && nu.secondaryStorage != 0 && nu.processing != 0;
+}
 
+void
+NodeData::Resize(uint32_t nodes)
+{
+	if(nodes <= m_currentNodeUtilization.size())
+	{
+		return;
+	}
+	NodeUtilization_s idle = {0, 0, 0};
+	m_currentNodeUtilization.resize(nodes, idle);
+	m_nodeUtilization.resize(nodes);
 }
 
 void
@@ -132,44 +269,29 @@ NodeData::MapUtilization()
 //	NS_LOG_UNCOND("Map Utilization Called" << Simulator::Now().GetSeconds());
 
 	double t = Simulator::Now().GetSeconds();
-	double sumP = 0;
-	double sumPs = 0;
-	double sumSs = 0;
-	uint32_t count = 0;
-
-	// calculate average and mapp it.
-	std::map<uint32_t, NodeUtilization_s >::iterator it;
-	for(it = m_currentNodeUtilization.begin(); it != m_currentNodeUtilization.end(); it++)
-	{
-		NodeUtilization_s nu = it->second;
-		if(nu.primaryStorage != 0 && nu.secondaryStorage != 0 && nu.processing != 0)
-		{
-			sumP += nu.processing;
-			sumPs += nu.primaryStorage;
-			sumSs += nu.secondaryStorage;
-			count++;
-		}
-	}
+	uint32_t count = m_utilizedNodes;
 
+	// the average of running sums, kept by UtilizationSink
 	if(count > 0)
 	{
 		NodeUtilization_s avgNu;
 
-		avgNu.processing = sumP/count;
-		avgNu.primaryStorage = sumPs/count;
-		avgNu.secondaryStorage = sumSs/count;
+		avgNu.processing = m_utilizationSum.processing/count;
+		avgNu.primaryStorage = m_utilizationSum.primaryStorage/count;
+		avgNu.secondaryStorage = m_utilizationSum.secondaryStorage/count;
 
+		if(m_streaming)
+		{
+			double row[5] = {t, static_cast<double>(count), avgNu.processing,
+					avgNu.primaryStorage, avgNu.secondaryStorage};
+			m_avgStream.Append(row);
+			return;
+		}
 		AvgUtilization_s au = {
 				count, t, avgNu
 		};
 		m_avgUtilization.push_back(au);
 	}
-
-
-
-	Simulator::Schedule(Seconds(m_timeInterval), &NodeData::MapUtilization, this);
-
-
 }
 
 } /* namespace ns3 */
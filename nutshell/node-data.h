@@ -26,9 +26,9 @@
 #define NUTSHELL_DATA_COLLECTOR_NODE_DATA_H
 
 #include <vector>
-#include <map>
 
 #include "nutshell-data-collector.h"
+#include "streaming-csv-writer.h"
 #include "ns3/nstime.h"
 #include "ns3/core-module.h"
 #include "ns3/log.h"
@@ -97,6 +97,10 @@ private:
 	 * counted and traced.
 	 */
 	void MapUtilization();
+	/**
+	 * \brief Samples the utilization, on the ticks of sampling clock
+	 */
+	virtual void Sample();
 	/**
 	 * \brief Attach a trace sink to trace source
 	 *
@@ -112,12 +116,39 @@ private:
 	 * child class.
 	 */
 	virtual void ExportData();
+	/**
+	 * \brief Exports the average and, if enabled, individual utilization tables
+	 */
+	virtual void ExportBinary(ColumnarWriter & writer);
+	/**
+	 * \brief Opens the average and, if enabled, individual utilization streams
+	 */
+	virtual void StartStreaming();
+	/**
+	 * \brief Closes the utilization streams
+	 */
+	virtual void StopStreaming();
+
 
+	/**
+	 * \brief Checks if a node counts in the average utilization
+	 */
+	static bool IsUtilized(const NodeUtilization_s & nu);
+	/**
+	 * \brief Grows the per node vectors to hold the nodes
+	 * \param nodes The number of nodes
+	 */
+	void Resize(uint32_t nodes);
 
-	std::map<uint32_t, std::vector<MappedUtilization_s> > m_nodeUtilization;
-	std::map<uint32_t, NodeUtilization_s > m_currentNodeUtilization;
+	std::vector<std::vector<MappedUtilization_s> > m_nodeUtilization; //!< Utilization history, indexed by node id
+	std::vector<NodeUtilization_s> m_currentNodeUtilization; //!< Current utilization, indexed by node id
 	std::vector<AvgUtilization_s> m_avgUtilization;
 	bool m_isExportIndividualNodeData;
+	bool m_streaming; //!< Records go to the streams instead of memory
+	StreamingCsvWriter m_avgStream; //!< Stream of average utilization
+	StreamingCsvWriter m_nodeStream; //!< Stream of individual node utilization
+	NodeUtilization_s m_utilizationSum; //!< Running sums over the utilized nodes
+	uint32_t m_utilizedNodes; //!< The number of utilized nodes
 };
 
 } /* namespace ns3 */
@@ -26,7 +26,9 @@
 #include <sstream>
 
 #include "ns3/log.h"
+#include "ns3/simulator.h"
 #include "nutshell-data-collector.h"
+#include "columnar-writer.h"
 
 namespace ns3 {
 
@@ -37,12 +39,17 @@ NutshellDataCollector::Test(std::string t)
 }
 
 NutshellDataCollector::NutshellDataCollector(void)
+	: m_samplingPeriod(Seconds(1)),
+	  m_decimation(0),
+	  m_ticks(0),
+	  m_exportFormat(EXPORT_CSV)
 {
 	m_timeInterval = 5;
 }
 
 NutshellDataCollector::~NutshellDataCollector()
 {
+	Simulator::Cancel(m_clockEvent);
 }
 
 void
@@ -57,7 +64,66 @@ NutshellDataCollector::AttachSinks()
 	for(uint32_t i = 0; i < m_collectors.size(); i++)
 	{
 		m_collectors[i]->AttachTraceSink();
+		if(m_exportFormat == EXPORT_STREAM)
+		{
+			m_collectors[i]->SetSimulationPrefix(m_simulationPrefix);
+			m_collectors[i]->StartStreaming();
+		}
 	}
+	if(!m_collectors.empty())
+	{
+		m_ticks = 0;
+		m_clockEvent = Simulator::ScheduleNow(&NutshellDataCollector::Tick, this);
+	}
+}
+
+void
+NutshellDataCollector::Tick()
+{
+	for(uint32_t i = 0; i < m_collectors.size(); i++)
+	{
+		if(m_ticks % m_collectors[i]->GetDecimation(m_samplingPeriod) == 0)
+		{
+			m_collectors[i]->Sample();
+		}
+	}
+	m_ticks++;
+
+	// the clock is the only event left, nothing more to sample
+	if(!Simulator::IsFinished())
+	{
+		m_clockEvent = Simulator::Schedule(m_samplingPeriod, &NutshellDataCollector::Tick, this);
+	}
+}
+
+uint32_t
+NutshellDataCollector::GetDecimation(Time period) const
+{
+	if(m_decimation > 0)
+	{
+		return m_decimation;
+	}
+	uint64_t d = (Seconds(m_timeInterval).GetNanoSeconds() + period.GetNanoSeconds() / 2)
+			/ period.GetNanoSeconds();
+	return d > 0 ? d : 1;
+}
+
+void
+NutshellDataCollector::Sample()
+{
+}
+
+void
+NutshellDataCollector::SetSamplingPeriod(Time period)
+{
+	NS_ASSERT_MSG(period.IsStrictlyPositive(), "The sampling period must be positive");
+	m_samplingPeriod = period;
+}
+
+void
+NutshellDataCollector::SetDecimation(uint32_t factor)
+{
+	m_decimation = factor;
 }
 
 void
@@ -74,6 +140,26 @@ NutshellDataCollector::AttachTraceSink(){
 void
 NutshellDataCollector::Export()
 {
+	if(m_exportFormat == EXPORT_BINARY)
+	{
+		ColumnarWriter writer;
+		writer.Open(MakeFileName(m_simulationPrefix + "_collected_data", ".nscd"));
+		for(uint32_t i = 0; i < m_collectors.size(); i++)
+		{
+			m_collectors[i]->SetSimulationPrefix(m_simulationPrefix);
+			m_collectors[i]->ExportBinary(writer);
+		}
+		writer.Close();
+		return;
+	}
+	if(m_exportFormat == EXPORT_STREAM)
+	{
+		for(uint32_t i = 0; i < m_collectors.size(); i++)
+		{
+			m_collectors[i]->StopStreaming();
+		}
+		return;
+	}
 	for(uint32_t i = 0; i < m_collectors.size(); i++)
 	{
 		m_collectors[i]->SetSimulationPrefix(m_simulationPrefix);
@@ -81,6 +167,12 @@ NutshellDataCollector::Export()
 	}
 }
 
+void
+NutshellDataCollector::SetExportFormat(ExportFormat_e format)
+{
+	m_exportFormat = format;
+}
+
 std::string
 NutshellDataCollector::MakeFileName(std::string name, std::string extension)
 {
@@ -112,6 +204,23 @@ NutshellDataCollector::ExportData(){
 	NS_LOG_UNCOND("parent export data");
 }
 
+void
+NutshellDataCollector::ExportBinary(ColumnarWriter & writer)
+{
+	ExportData();
+}
+
+void
+NutshellDataCollector::StartStreaming()
+{
+}
+
+void
+NutshellDataCollector::StopStreaming()
+{
+	ExportData();
+}
+
 std::string
 NutshellDataCollector::StringConcat(std::vector< std::string > s)
 {
@@ -29,6 +29,8 @@
 
 namespace ns3 {
 
+class ColumnarWriter;
+
 /**
  * \brief The class is a bird eye view for data collection and exporting
  *
@@ -39,6 +41,14 @@ namespace ns3 {
 class NutshellDataCollector {
 
 public:
+	/**
+	 * \brief Formats of exported data
+	 */
+	enum ExportFormat_e {
+		EXPORT_CSV = 0, //!< A CSV file per data set, default
+		EXPORT_BINARY, //!< A single columnar binary file, see ColumnarWriter
+		EXPORT_STREAM //!< CSV files written during the run, see StreamingCsvWriter
+	};
 
 	void Test(std::string t);
 
@@ -63,15 +73,26 @@ public:
 	/**
 	 * \brief Attach sinks
 	 *
-	 * Loops through the data collector list and call their function AttachTraceSink().
+	 * Loops through the data collector list and call their function AttachTraceSink(),
+	 * and StartStreaming() for the stream format.
 	 */
 	void AttachSinks();
 	/**
 	 * \brief Exports data.
 	 *
-	 * Loops through the data collector list, and call their function ExportData().
+	 * Loops through the data collector list, and call their function ExportData(),
+	 * or ExportBinary() into a single file for the binary format, or
+	 * StopStreaming() for the stream format.
 	 */
 	void Export();
+	/**
+	 * \brief Set the format of exported data
+	 *
+	 * The binary file is converted to CSV files with ColumnarWriter::ConvertToCsv.
+	 *
+	 * \param format The format, CSV by default
+	 */
+	void SetExportFormat(ExportFormat_e format);
 
 	virtual ~NutshellDataCollector();
 
@@ -81,6 +102,22 @@ public:
 	 * \param t the time interval in Seconds, a Uint32_t value
 	 */
 	void SetTimeInterval(uint16_t t);
+	/**
+	 * \brief Set the sampling clock period, shared by all collectors
+	 *
+	 * The collector holding the list ticks once per period and every
+	 * collector samples each decimation factor ticks. The clock stops
+	 * when no other event is left or at Simulator::Stop.
+	 *
+	 * \param period The period of clock, 1 second by default
+	 */
+	void SetSamplingPeriod(Time period);
+	/**
+	 * \brief Set the number of clock ticks between two samples
+	 *
+	 * \param factor The decimation factor, 0 derives it from the time interval
+	 */
+	void SetDecimation(uint32_t factor);
 	/**
 	 * \brief Set the simulation prefix for file names
 	 * \param s The prefix name
@@ -116,6 +153,22 @@ protected:
 	std::string m_simulationPrefix; //!< Simulation Prefix
 private:
 
+	/**
+	 * \brief Samples the collected data, called on the ticks of sampling clock
+	 */
+	virtual void Sample();
+
+	/**
+	 * \brief Get the ticks between two samples of the collector
+	 * \param period The period of sampling clock
+	 */
+	uint32_t GetDecimation(Time period) const;
+
+	/**
+	 * \brief A tick of the sampling clock, fans out to the collectors due
+	 */
+	void Tick();
+
 	/**
 	 * \brief Attach a trace sink to trace source
 	 *
@@ -132,8 +185,36 @@ private:
 	 */
 	virtual void ExportData();
 
+	/**
+	 * \brief Exports collected data as tables of the columnar file
+	 *
+	 * Collectors without binary export fall back to ExportData().
+	 *
+	 * \param writer The writer of open file
+	 */
+	virtual void ExportBinary(ColumnarWriter & writer);
+
+	/**
+	 * \brief Opens the streams the collected data is written to during the run
+	 *
+	 * Collectors that stream keep only bounded buffers in memory.
+	 */
+	virtual void StartStreaming();
+	/**
+	 * \brief Writes the remaining data and closes the streams
+	 *
+	 * Collectors without streaming fall back to ExportData().
+	 */
+	virtual void StopStreaming();
+
 	std::vector< NutshellDataCollector* > m_collectors; //!< Data collector classes pointer
 
+	Time m_samplingPeriod; //!< The period of sampling clock
+	uint32_t m_decimation; //!< Ticks between samples, 0 to derive from the time interval
+	uint64_t m_ticks; //!< Ticks of the sampling clock so far
+	EventId m_clockEvent; //!< The next tick
+	ExportFormat_e m_exportFormat; //!< The format of exported data
+
 };
 
 } /* namespace ns3 */
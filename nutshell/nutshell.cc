@@ -7,6 +7,7 @@
 
 
 #include <vector>
+#include <sstream>
 #include "ns3/netanim-module.h"
 #include "ns3/core-module.h"
 #include "ns3/network-module.h"
@@ -17,6 +18,9 @@
 #include "ns3/random-variable-stream.h"
 #include "ns3/flow-monitor-module.h"
 #include "ns3/gtk-config-store.h"
+#ifdef NS3_MPI
+#include "ns3/mpi-interface.h"
+#endif
 
 #include "computational-local-data-vm.h"
 #include "virtual-machine-helper.h"
@@ -41,6 +45,7 @@
 #include "fat-tree-ipv4-routing-header.h"
 #include "fat-tree-ipv4-routing-protocol-helper.h"
 #include "fat-tree-ipv4-routing-protocol.h"
+#include "fat-tree-ipv4-arithmetic-routing-helper.h"
 #include "fat-tree-ipv4-rte.h"
 
 #include "virtual-machine-helper.h"
@@ -54,6 +59,8 @@
 #include "queue-data.h"
 #include "network-data.h"
 #include "sjf-first-fit-vm-scheduler.h"
+#include "columnar-writer.h"
+#include "batch-runner.h"
 
 
 
@@ -63,14 +70,168 @@ using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE ("NutshellExperiment");
 
+/**
+ * \brief A run of the batch, the configuration of main with the parameters of run
+ */
+static int
+RunScenario (const BatchRun_s & run, std::string prefix)
+{
+	RngSeedManager::SetRun (run.seed);
+
+	NutshellDataCollector collector;
+	collector.SetSimulationPrefix (prefix);
+	collector.SetExportFormat (NutshellDataCollector::EXPORT_BINARY);
+
+	NodeData nd;
+	nd.SetTimeInterval (6);
+	NetworkData netStat;
+	netStat.SetTimeInterval (6);
+	VmData vmd;
+
+	SjfFirstFitVmScheduler sjf;
+	FcfsFirstFitVmScheduler fcfs;
+	VmScheduler * sch = &sjf;
+	if (run.scheduler == "fcfs")
+	{
+		sch = &fcfs;
+	}
+	else if (run.scheduler != "sjf")
+	{
+		NS_LOG_UNCOND ("Unknown scheduler " << run.scheduler);
+		return 1;
+	}
+	vmd.SetScheduler (*sch);
+
+	collector.AddDataCollector (nd);
+	collector.AddDataCollector (netStat);
+	collector.AddDataCollector (vmd);
+
+	if (run.topology == "fattree")
+	{
+		PointToPointHelper p2p;
+		p2p.SetDeviceAttribute ("DataRate", StringValue ("1Gbps"));
+		p2p.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+		FatTreeConfig conf;
+		conf.ConfigureNode ("500TFLOPS", "1000TFLOPS", "10GB", "30GB", "1TB", "10TB");
+		conf.ConfigureVmGeneral (run.vms, "200TFLOPS", "800TFLOPS", "10GB", "20GB", "500GB", "1TB", "5000TFLOP", "10000TFLOP");
+		conf.ConfigureVmDataReq (true, 2, DatacenterConfig::RANDOM,"50MB","1GB", "300MB", "300MB", "9600MB", "9600MB",
+					50, 300, 70.0, 80.0, MilliSeconds (12), MicroSeconds (12), NanoSeconds (100), NanoSeconds (100));
+		conf.ConfigureVmSplits (true, run.splits);
+		conf.ConfigureVmArrivals (Seconds (2.0), Seconds (25.0));
+		conf.ConfigureVmNetwork (1500, "ns3::TcpSocketFactory", "100Mbps");
+		conf.ConfigureStorageServer (5);
+		conf.SetBaseNetwork ("10.0.0.0", "255.255.255.0");
+		conf.SetLink (p2p);
+		conf.SetPods (run.pods);
+		conf.SetVmScheuler (*sch);
+		conf.EnableTracing (collector);
+
+		FatTree fat (conf);
+		Simulator::Stop (run.stopTime);
+		Simulator::Run ();
+		Simulator::Destroy ();
+	}
+	else if (run.topology == "threetier")
+	{
+		PointToPointHelper nTacP2p, acTagP2p, agTcP2p;
+		nTacP2p.SetDeviceAttribute ("DataRate", StringValue ("1Gbps"));
+		nTacP2p.SetChannelAttribute ("Delay", StringValue ("2ms"));
+		acTagP2p.SetDeviceAttribute ("DataRate", StringValue ("1Gbps"));
+		acTagP2p.SetChannelAttribute ("Delay", StringValue ("2ms"));
+		agTcP2p.SetDeviceAttribute ("DataRate", StringValue ("1Gbps"));
+		agTcP2p.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+		ThreeTierConfig conf;
+		conf.ConfigureNode ("50TFLOPS", "100TFLOPS", "10GB", "30GB", "1TB", "10TB");
+		conf.ConfigureVmGeneral (run.vms, "20TFLOPS", "40TFLOPS", "10GB", "20GB", "500GB", "1TB", "5000TFLOP", "10000TFLOP");
+		conf.ConfigureVmDataReq (true, 2, DatacenterConfig::RANDOM,"1GB","10GB", "300MB", "300MB", "9600MB", "9600MB",
+					50, 300, 70.0, 80.0, MilliSeconds (12), MicroSeconds (12), NanoSeconds (100), NanoSeconds (100));
+		conf.ConfigureVmSplits (true, run.splits);
+		conf.ConfigureVmArrivals (Seconds (2.0), Seconds (25.0));
+		conf.ConfigureVmNetwork (1500, "ns3::TcpSocketFactory", "100Mbps");
+		conf.ConfigureStorageServer (5);
+		// the switches of the example configuration, 12, 8 and 4 for 4 pods
+		conf.SetNodesPerAccessSwitch (2);
+		conf.SetSwitchesNumber (3 * run.pods, 2 * run.pods, run.pods);
+		conf.SetPods (run.pods);
+		conf.SetNetwork ("10.0.0.0", "255.255.255.0");
+		conf.SetLinks (nTacP2p, acTagP2p, agTcP2p);
+		conf.SetVmScheuler (*sch);
+		conf.EnableTracing (collector);
+
+		ThreeTier tt (conf);
+		Simulator::Stop (run.stopTime);
+		Simulator::Run ();
+		Simulator::Destroy ();
+	}
+	else
+	{
+		NS_LOG_UNCOND ("Unknown topology " << run.topology);
+		return 1;
+	}
+
+	collector.Export ();
+	return 0;
+}
+
 
 int
 main ( int argc, char** argv )
 {
 
 //	Config::SetDefault ("ns3::Ipv4GlobalRouting::RandomEcmpRouting", BooleanValue (true));
+//	Config::SetDefault ("ns3::FatTreeIpv4RoutingProtocol::FlowHashEcmp", BooleanValue (true));
+//	Config::SetDefault ("ns3::FatTreeIpv4RoutingProtocol::FlowletTimeout", TimeValue (MicroSeconds (500)));
     Time::SetResolution (Time::NS);
 
+    std::string convert;
+    bool batch = false;
+    std::string topologies, pods, vms, splits, schedulers, seeds;
+    std::string out = "nutshell-batch";
+    uint32_t jobs = 0;
+    double stop = 10;
+    bool distributed = false;
+    bool arithmetic = false;
+    CommandLine cmd;
+    cmd.AddValue ("convert", "Convert a binary export file to CSV files and exit", convert);
+    cmd.AddValue ("batch", "Run a sweep of scenarios in parallel processes", batch);
+    cmd.AddValue ("topologies", "Batch topologies, e.g fattree,threetier", topologies);
+    cmd.AddValue ("pods", "Batch pods, e.g 4,8", pods);
+    cmd.AddValue ("vms", "Batch VM counts, e.g 100,700", vms);
+    cmd.AddValue ("splits", "Batch split ratios, e.g 3:2:1,1:1", splits);
+    cmd.AddValue ("schedulers", "Batch schedulers, e.g sjf,fcfs", schedulers);
+    cmd.AddValue ("seeds", "Batch seeds, e.g 1-20", seeds);
+    cmd.AddValue ("jobs", "Batch parallel processes, 0 for all cores", jobs);
+    cmd.AddValue ("out", "Batch output directory", out);
+    cmd.AddValue ("stop", "Batch simulation stop time in seconds", stop);
+    cmd.AddValue ("distributed", "Partition the fat-tree pods onto the MPI processes", distributed);
+    cmd.AddValue ("arithmetic", "Route the fat-tree from the address layout, without routing tables", arithmetic);
+    cmd.Parse (argc, argv);
+    if (!convert.empty ())
+    {
+    	uint32_t tables = ColumnarWriter::ConvertToCsv (convert, convert + "_");
+    	NS_LOG_UNCOND ("Converted " << tables << " tables of " << convert);
+    	return 0;
+    }
+    if (batch)
+    {
+    	BatchRunner runner;
+    	runner.SetScenario (&RunScenario);
+    	runner.SetOutputDirectory (out);
+    	runner.SetJobs (jobs);
+    	runner.SetStopTime (Seconds (stop));
+    	runner.SetSpec ("topologies", topologies);
+    	runner.SetSpec ("pods", pods);
+    	runner.SetSpec ("vms", vms);
+    	runner.SetSpec ("splits", splits);
+    	runner.SetSpec ("schedulers", schedulers);
+    	runner.SetSpec ("seeds", seeds);
+    	uint32_t failed = runner.Run ();
+    	NS_LOG_UNCOND (failed << " runs failed");
+    	return failed > 0 ? 1 : 0;
+    }
+
 //    LogComponentEnable("VirtualMachine", LOG_LEVEL_INFO);
 //    LogComponentEnable("ProducerVm", LOG_LEVEL_INFO);
 //    LogComponentEnable("ConsumerProducerVm", LOG_LEVEL_INFO);
@@ -91,8 +252,26 @@ main ( int argc, char** argv )
 //    ConfigStore config;
 //    config.ConfigureDefaults ();
 
+    uint32_t partitions = 1;
+    std::string prefix = "FatTree";
+    if (distributed)
+    {
+#ifdef NS3_MPI
+    	GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::DistributedSimulatorImpl"));
+    	MpiInterface::Enable (&argc, &argv);
+    	partitions = MpiInterface::GetSize ();
+    	std::stringstream ss;
+    	ss << prefix << "_rank" << MpiInterface::GetSystemId () << "_";
+    	prefix = ss.str ();
+#else
+    	NS_FATAL_ERROR ("Distributed simulation requires ns-3 built with MPI");
+#endif
+    }
+
     NutshellDataCollector collector;
-    collector.SetSimulationPrefix("FatTree");
+    collector.SetSimulationPrefix(prefix);
+//    collector.SetExportFormat(NutshellDataCollector::EXPORT_BINARY);
+//    collector.SetExportFormat(NutshellDataCollector::EXPORT_STREAM);
 
 //
 //    NodeData nd;
@@ -117,9 +296,17 @@ main ( int argc, char** argv )
 	conf.ConfigureVmArrivals(Seconds(2.0), Seconds(25.0));
 	conf.ConfigureVmNetwork(1500, "ns3::TcpSocketFactory", "100Mbps");
 	conf.ConfigureStorageServer(5);
+//	conf.ConfigureTransferMode(DatacenterConfig::TRANSFER_FLOW);
     conf.SetBaseNetwork("10.0.0.0", "255.255.255.0");
 	conf.SetLink(p2p);
 	conf.SetPods(8);
+	conf.SetPartitions(partitions);
+	// the address arithmetic is only right for the pods actually built
+	FatTreeIpv4ArithmeticRoutingHelper arithmeticRouting(conf.GetPods());
+	if (arithmetic)
+	{
+		conf.SetRouting(arithmeticRouting);
+	}
 
 	SjfFirstFitVmScheduler sch;
 	conf.SetVmScheuler(sch);
@@ -188,6 +375,12 @@ main ( int argc, char** argv )
     Simulator::Destroy ();
     collector.Export();
 //    collector2.Export();
+#ifdef NS3_MPI
+    if (distributed)
+    {
+    	MpiInterface::Disable ();
+    }
+#endif
 
 
     return 0;
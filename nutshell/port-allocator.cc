@@ -0,0 +1,96 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * port-allocator.cc
+ *
+ *  Created on: Apr 14, 2017
+ *      Author: ubaid
+ *       Email: u.ur.rahman@gmail.com
+ */
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+
+#include "port-allocator.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PortAllocator");
+
+PortAllocator::PortAllocator(uint16_t first, uint16_t last)
+	: m_first(first),
+	  m_last(last),
+	  m_next(first),
+	  m_allocated(0)
+{
+	NS_ASSERT_MSG(first > 0 && first <= last, "Invalid port range " << first << "-" << last);
+}
+
+PortAllocator::~PortAllocator()
+{
+}
+
+uint16_t
+PortAllocator::Allocate()
+{
+	uint16_t port = 0;
+	while(m_next <= m_last && m_reserved.find(m_next) != m_reserved.end())
+	{
+		m_next++;
+	}
+	if(m_next <= m_last)
+	{
+		port = m_next++;
+	}
+	else if(!m_free.empty())
+	{
+		port = m_free.front();
+		m_free.pop_front();
+	}
+	else
+	{
+		NS_LOG_WARN("No free port in " << m_first << "-" << m_last);
+		return 0;
+	}
+	m_allocated++;
+	NS_LOG_LOGIC("Allocated port " << port);
+	return port;
+}
+
+void
+PortAllocator::Reserve(uint16_t port)
+{
+	NS_ASSERT_MSG(port >= m_next || port < m_first, "Port " << port << " is handed out already");
+	m_reserved.insert(port);
+}
+
+void
+PortAllocator::Release(uint16_t port)
+{
+	NS_ASSERT_MSG(port >= m_first && port < m_next && m_allocated > 0
+			&& m_reserved.find(port) == m_reserved.end(), "Port " << port << " was not allocated");
+	NS_LOG_LOGIC("Released port " << port);
+	m_free.push_back(port);
+	m_allocated--;
+}
+
+uint32_t
+PortAllocator::GetNAllocated() const
+{
+	return m_allocated;
+}
+
+} /* namespace ns3 */
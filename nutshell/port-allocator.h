@@ -0,0 +1,89 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * port-allocator.h
+ *
+ *  Created on: Apr 14, 2017
+ *      Author: ubaid
+ *       Email: u.ur.rahman@gmail.com
+ */
+
+#ifndef NUTSHELL_PORT_ALLOCATOR_H
+#define NUTSHELL_PORT_ALLOCATOR_H
+
+#include <stdint.h>
+#include <deque>
+#include <set>
+
+namespace ns3 {
+
+/**
+ * \brief Allocates the listening ports of VMs on a node
+ *
+ * Ports of the range are handed out in order until the range is used
+ * once, afterwards the released ports are reused, oldest release first
+ * so a port is not bound again right after its socket is closed. Both
+ * allocation and release take constant time, and the memory is
+ * proportional to the ports released and not yet reused. Ports of the
+ * range used by other applications, e.g. the storage server port, are
+ * reserved and never handed out.
+ */
+class PortAllocator {
+public:
+	/**
+	 * \brief Class constructor
+	 * \param first The first port of the range
+	 * \param last The last port of the range
+	 */
+	PortAllocator(uint16_t first = 2048, uint16_t last = 65535);
+	virtual ~PortAllocator();
+
+	/**
+	 * \brief Allocates a free port
+	 * \return The port, 0 if every port of the range is allocated
+	 */
+	uint16_t Allocate();
+	/**
+	 * \brief Keeps a port of the range from being allocated
+	 *
+	 * The port must not have been handed out yet.
+	 *
+	 * \param port The port
+	 */
+	void Reserve(uint16_t port);
+	/**
+	 * \brief Returns a port to the allocator
+	 * \param port The port allocated before
+	 */
+	void Release(uint16_t port);
+	/**
+	 * \brief Get the number of ports allocated and not released
+	 * \return The number of ports
+	 */
+	uint32_t GetNAllocated() const;
+
+private:
+	uint16_t m_first; //!< The first port of the range
+	uint16_t m_last; //!< The last port of the range
+	uint32_t m_next; //!< The next port never allocated before
+	uint32_t m_allocated; //!< The number of ports in use
+	std::deque<uint16_t> m_free; //!< The released ports, in order of release
+	std::set<uint16_t> m_reserved; //!< The ports never handed out
+};
+
+} /* namespace ns3 */
+
+#endif /* NUTSHELL_PORT_ALLOCATOR_H */
@@ -0,0 +1,207 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *
+ * processor-sharing-cpu.cc
+ *
+ *  Created on: Mar 9, 2017
+ *      Author: ubaid
+ *       Email: u.ur.rahman@gmail.com
+ */
+
+#include <vector>
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include "processor-sharing-cpu.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ProcessorSharingCpu");
+
+NS_OBJECT_ENSURE_REGISTERED (ProcessorSharingCpu);
+
+TypeId
+ProcessorSharingCpu::GetTypeId ()
+{
+	static TypeId tid = TypeId("ns3::ProcessorSharingCpu")
+		.SetParent (Object::GetTypeId())
+		.AddConstructor<ProcessorSharingCpu> ()
+		;
+	return tid;
+}
+
+ProcessorSharingCpu::ProcessorSharingCpu()
+	: m_capacity (0),
+	  m_virtualTime (0),
+	  m_weightSum (0),
+	  m_nextId (1)
+{
+	NS_LOG_FUNCTION(this);
+}
+
+ProcessorSharingCpu::~ProcessorSharingCpu()
+{
+	NS_LOG_FUNCTION(this);
+}
+
+void
+ProcessorSharingCpu::DoDispose()
+{
+	NS_LOG_FUNCTION(this);
+	Simulator::Cancel(m_completion);
+	m_jobs.clear();
+	m_finish.clear();
+	Object::DoDispose();
+}
+
+void
+ProcessorSharingCpu::SetCapacity(double capacity)
+{
+	NS_LOG_FUNCTION(this << capacity);
+	Advance();
+	m_capacity = capacity;
+	Reschedule();
+}
+
+double
+ProcessorSharingCpu::GetCapacity() const
+{
+	return m_capacity;
+}
+
+uint64_t
+ProcessorSharingCpu::Submit(double work, double weight, Callback<void> done)
+{
+	NS_LOG_FUNCTION(this << work << weight);
+	if(weight <= 0)
+	{
+		NS_FATAL_ERROR("Processor sharing job requires a positive weight " << this);
+	}
+	Advance();
+
+	Job_s job;
+	job.finish = m_virtualTime + (work / weight);
+	job.weight = weight;
+	job.done = done;
+
+	uint64_t id = m_nextId++;
+	m_jobs[id] = job;
+	m_finish.insert(std::make_pair(job.finish, id));
+	m_weightSum += weight;
+
+	Reschedule();
+	return id;
+}
+
+void
+ProcessorSharingCpu::Cancel(uint64_t id)
+{
+	NS_LOG_FUNCTION(this << id);
+	std::map<uint64_t, Job_s>::iterator it = m_jobs.find(id);
+	if(it == m_jobs.end())
+	{
+		return;
+	}
+	Advance();
+	m_finish.erase(std::make_pair(it->second.finish, id));
+	m_weightSum -= it->second.weight;
+	m_jobs.erase(it);
+	if(m_jobs.empty())
+	{
+		m_weightSum = 0;
+	}
+	Reschedule();
+}
+
+uint32_t
+ProcessorSharingCpu::GetNJobs() const
+{
+	return m_jobs.size();
+}
+
+void
+ProcessorSharingCpu::Advance()
+{
+	Time now = Simulator::Now();
+	if(m_weightSum > 0)
+	{
+		m_virtualTime += (now - m_lastUpdate).GetSeconds() * m_capacity / m_weightSum;
+	}
+	m_lastUpdate = now;
+}
+
+void
+ProcessorSharingCpu::Reschedule()
+{
+	Simulator::Cancel(m_completion);
+	if(m_finish.empty() || m_capacity <= 0)
+	{
+		return;
+	}
+	double remaining = m_finish.begin()->first - m_virtualTime;
+	if(remaining < 0)
+	{
+		remaining = 0;
+	}
+	double delay = remaining * m_weightSum / m_capacity;
+	m_completion = Simulator::Schedule(Seconds(delay), &ProcessorSharingCpu::Complete, this);
+}
+
+void
+ProcessorSharingCpu::Complete()
+{
+	NS_LOG_FUNCTION(this);
+	Advance();
+
+	/*
+	 * Take out every job finished by now before invoking callbacks,
+	 * a callback may submit or cancel work on this CPU.
+	 */
+	std::vector<Callback<void> > done;
+	/*
+	 * Less than a nanosecond of service left rounds to a zero delay, such
+	 * a job is finished now, as the completion would not advance the clock.
+	 */
+	double tolerance = m_virtualTime * 1e-12;
+	if(m_weightSum > 0)
+	{
+		tolerance += m_capacity / m_weightSum * 1e-9;
+	}
+	while(!m_finish.empty() &&
+			m_finish.begin()->first <= m_virtualTime + tolerance)
+	{
+		uint64_t id = m_finish.begin()->second;
+		m_finish.erase(m_finish.begin());
+		std::map<uint64_t, Job_s>::iterator it = m_jobs.find(id);
+		m_weightSum -= it->second.weight;
+		done.push_back(it->second.done);
+		m_jobs.erase(it);
+	}
+	if(m_jobs.empty())
+	{
+		m_weightSum = 0;
+	}
+	Reschedule();
+
+	for(uint32_t i = 0; i < done.size(); i++)
+	{
+		done[i]();
+	}
+}
+
+} /* namespace ns3 */
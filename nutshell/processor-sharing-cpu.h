@@ -0,0 +1,135 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *
+ * processor-sharing-cpu.h
+ *
+ *  Created on: Mar 9, 2017
+ *      Author: ubaid
+ *       Email: u.ur.rahman@gmail.com
+ */
+
+#ifndef NUTSHELL_PROCESSOR_SHARING_CPU_H
+#define NUTSHELL_PROCESSOR_SHARING_CPU_H
+
+#include <stdint.h>
+#include <set>
+#include <map>
+#include <utility>
+
+#include "ns3/object.h"
+#include "ns3/callback.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * \brief A weighted processor sharing model of node CPU
+ *
+ * Work submitted to the CPU is processed concurrently, the capacity
+ * of CPU is divided among the running jobs in proportion to their
+ * weights, so a job running alone uses the whole CPU and slows down
+ * as other jobs arrive.
+ *
+ * The CPU keeps a virtual time that advances at capacity / sum of weights,
+ * a job finishes when the virtual time reaches its virtual finish time,
+ * which is fixed on arrival. Jobs are kept ordered by virtual finish time
+ * and only the earliest completion is scheduled, so an arrival, completion
+ * or cancellation costs O(log k) for k running jobs.
+ */
+class ProcessorSharingCpu : public Object {
+public:
+	/**
+	* \brief Get the type ID.
+	* \return the object TypeId
+	*/
+	static TypeId GetTypeId (void);
+	ProcessorSharingCpu();
+	virtual ~ProcessorSharingCpu();
+
+	/**
+	 * \brief Set the processing capacity of CPU
+	 * \param capacity The amount of work processed per second
+	 */
+	void SetCapacity(double capacity);
+	/**
+	 * \brief Get the processing capacity of CPU
+	 * \return The amount of work processed per second
+	 */
+	double GetCapacity() const;
+
+	/**
+	 * \brief Submits work to the CPU
+	 *
+	 * \param work The amount of work, in the units of capacity
+	 * \param weight The share of job, relative to other jobs
+	 * \param done The callback invoked when the work is complete
+	 * \return The ID of job, never 0
+	 */
+	uint64_t Submit(double work, double weight, Callback<void> done);
+	/**
+	 * \brief Removes a job before it completes
+	 * \param id The ID of job
+	 */
+	void Cancel(uint64_t id);
+	/**
+	 * \brief Get the number of running jobs
+	 * \return The number of jobs
+	 */
+	uint32_t GetNJobs() const;
+
+protected:
+	virtual void DoDispose(void);
+
+private:
+	/**
+	 * \brief A job running on CPU
+	 */
+	struct Job_s {
+		double finish; //!< The virtual finish time
+		double weight; //!< The share of job
+		Callback<void> done; //!< Invoked on completion
+	};
+
+	typedef std::set<std::pair<double, uint64_t> > FinishSet;
+
+	/**
+	 * \brief Advances the virtual time to current time
+	 */
+	void Advance();
+	/**
+	 * \brief Schedules the completion of earliest job
+	 */
+	void Reschedule();
+	/**
+	 * \brief Completes the jobs finished at current time
+	 */
+	void Complete();
+
+	double m_capacity; //!< Work processed per second
+	double m_virtualTime; //!< The virtual time
+	double m_weightSum; //!< The sum of weights of running jobs
+	Time m_lastUpdate; //!< The time virtual time was last advanced
+	uint64_t m_nextId; //!< The ID of next job
+	std::map<uint64_t, Job_s> m_jobs; //!< Running jobs
+	FinishSet m_finish; //!< Running jobs ordered by virtual finish time
+	EventId m_completion; //!< The completion of earliest job
+};
+
+} /* namespace ns3 */
+
+#endif /* NUTSHELL_PROCESSOR_SHARING_CPU_H */
@@ -131,14 +131,18 @@ ProducerVm::HandleRead(Ptr<Socket> socket)
 
 		}
 		m_rxTrace(packet, from);
-		std::string s = GetPacketString(packet);
-		if(s == "Done" || s == "done" || s == "don")
+		m_controlStream.Receive(socket, packet);
+		VmControlHeader control;
+		while(ReadControl(socket, control))
 		{
-			ScheduleStop(0.0);
-		}
-		else
-		{
-			RetransmitRequest(s, socket);
+			if(control.GetType() == VmControlHeader::DONE)
+			{
+				ScheduleStop(0.0);
+			}
+			else if(control.GetType() == VmControlHeader::RETRANSMIT)
+			{
+				RetransmitRequest(control, socket);
+			}
 		}
 
 	}
@@ -172,7 +176,7 @@ void
 ProducerVm::ScheduleTransmit(double delay)
 {
 	NS_LOG_FUNCTION(this);
-	Simulator::Schedule(Seconds(delay), &ProducerVm::BeginTransmission, this);
+	m_sendEvent = Simulator::Schedule(Seconds(delay), &ProducerVm::BeginTransmission, this);
 }
 void
 ProducerVm::BeginTransmission()
@@ -184,10 +188,16 @@ ProducerVm::BeginTransmission()
 	NetworkVm::BeginTransmission();
 }
 void
+ProducerVm::ProcessingCompleted()
+{
+	NS_LOG_FUNCTION(this);
+	ScheduleTransmit(0.0);
+}
+void
 ProducerVm::ScheduleStop(double delay)
 {
 	NS_LOG_FUNCTION(this);
-	Simulator::Schedule(Seconds(delay), &ProducerVm::StopApplication, this);
+	m_finishEvent = Simulator::Schedule(Seconds(delay), &ProducerVm::StopApplication, this);
 }
 
 void
@@ -196,10 +206,12 @@ ProducerVm::StartApplication(void)
 	NS_LOG_FUNCTION(this);
 	if(ReserveResources() && GetCompNode()->ReserveNicRate(GetVmTransmissionRate()))
 	{
-		double delay = this->CalculateProcessingTime();
 		NS_LOG_INFO("Producer VM "<< this << " Started its application execution");
-		CreateSocket();
-		ScheduleTransmit(delay);
+		if(!IsFlowLevel())
+		{
+			CreateSocket();
+		}
+		ScheduleProcessing(0.0);
 	}
 	else
 	{
@@ -37,6 +37,7 @@ protected:
 	virtual void ScheduleTransmit(double delay);
 	virtual void BeginTransmission();
 	virtual void ScheduleStop(double delay);
+	virtual void ProcessingCompleted();
 
 private:
 
@@ -24,7 +24,9 @@
 
 #include <fstream>
 #include <vector>
+#include <cstdlib>
 #include "queue-data.h"
+#include "columnar-writer.h"
 #include "ns3/core-module.h"
 #include "ns3/network-module.h"
 #include "ns3/internet-module.h"
@@ -35,20 +37,13 @@
 namespace ns3 {
 
 QueueData::QueueData()
-	: NutshellDataCollector(), m_mapEvent ()
+	: NutshellDataCollector()
 {
-	m_enqueue = false;
-	m_enqueuePcap = false;
-
-	m_dequeue = false;
-	m_dequeuePcap = false;
-
-	m_drop = false;
-	m_dropPcap = false;
-
-	m_totalPacketDrop = 0;
-	m_totalPacketEnqueue = 0;
-	m_totalPacketDequeue = 0;
+	for(uint32_t c = 0; c < COUNTER_N; c++)
+	{
+		m_enabled[c] = false;
+		m_pcap[c] = false;
+	}
 }
 
 QueueData::~QueueData()
@@ -58,134 +53,172 @@ QueueData::~QueueData()
 void
 QueueData::EnableQueueTracePacketDrop(bool pcap)
 {
-	if(pcap)
-	{
-		m_dropPcap = true;
-		PcapHelper pcapHelper;
-		std::string fileName = MakeFileName("queue_packet_drop", ".pcap");
-		fileName = StringConcat(m_simulationPrefix, fileName);
-		m_packetDrop = pcapHelper.CreateFile (fileName, std::ios::out, PcapHelper::DLT_PPP);
-	}
-	m_drop = true;
+	EnableCounter(COUNTER_DROP, pcap, "queue_packet_drop");
 }
 
 void
 QueueData::EnableQueueTraceDequeue(bool pcap)
 {
-	if(pcap)
-	{
-		m_dequeuePcap = true;
-		PcapHelper pcapHelper;
-		std::string fileName = MakeFileName("queue_dequeue_packet", ".pcap");
-		fileName = StringConcat(m_simulationPrefix, fileName);
-		m_packetDequeue = pcapHelper.CreateFile (fileName, std::ios::out, PcapHelper::DLT_PPP);
-	}
-	m_dequeue = true;
+	EnableCounter(COUNTER_DEQUEUE, pcap, "queue_dequeue_packet");
 }
 
 void
 QueueData::EnableQueueTraceEnqueue(bool pcap)
+{
+	EnableCounter(COUNTER_ENQUEUE, pcap, "queue_enqueue_packet");
+}
+
+void
+QueueData::EnableCounter(Counter_e c, bool pcap, std::string name)
 {
 	if(pcap)
 	{
-		m_enqueuePcap = true;
+		m_pcap[c] = true;
 		PcapHelper pcapHelper;
-		std::string fileName = MakeFileName("queue_enqueue_packet", ".pcap");
+		std::string fileName = MakeFileName(name, ".pcap");
 		fileName = StringConcat(m_simulationPrefix, fileName);
-		m_packetEnqueue = pcapHelper.CreateFile (fileName, std::ios::out, PcapHelper::DLT_PPP);
+		m_pcapFile[c] = pcapHelper.CreateFile (fileName, std::ios::out, PcapHelper::DLT_PPP);
 	}
-	m_enqueue = true;
+	m_enabled[c] = true;
 }
 
 void
 QueueData::AttachTraceSink()
 {
-	if(m_drop)
+	if(!m_enabled[COUNTER_DROP] && !m_enabled[COUNTER_ENQUEUE] && !m_enabled[COUNTER_DEQUEUE])
 	{
-		Config::ConnectWithoutContext(StringConcat(m_conString, "/Drop"), MakeCallback(&QueueData::PacketDropSink, this));
-		MapPacketDrop();
+		return;
 	}
 
-	if(m_enqueue)
+	/*
+	 * the queues are resolved once and each is connected with its own
+	 * counters bound to the sinks, so a traced packet costs an increment
+	 */
+	if(!m_queues.empty())
 	{
-		Config::ConnectWithoutContext(StringConcat(m_conString, "/Enqueue"), MakeCallback(&QueueData::PacketDropSink, this));
-		MapPacketEnqueue();
+		// the sinks are connected already, connecting again counts twice
+		return;
 	}
-
-	if(m_dequeue)
+	Config::MatchContainer matches = Config::LookupMatches(m_conString);
+	m_queues.reserve(matches.GetN());
+	for(uint32_t i = 0; i < matches.GetN(); i++)
 	{
-		Config::ConnectWithoutContext(StringConcat(m_conString, "/Dequeue"), MakeCallback(&QueueData::PacketDropSink, this));
-		MapPacketDequeue();
+		QueueCounters_s q;
+		std::string path = matches.GetMatchedPath(i);
+		std::string::size_type n = path.find("/NodeList/");
+		q.node = (n == std::string::npos) ? i : std::strtoul(path.c_str() + n + 10, 0, 10);
+		n = path.find("/DeviceList/");
+		q.device = (n == std::string::npos) ? 0 : std::strtoul(path.c_str() + n + 12, 0, 10);
+		for(uint32_t c = 0; c < COUNTER_N; c++)
+		{
+			q.count[c] = 0;
+		}
+		m_queues.push_back(q);
+		QueueSink_s sink = {this, i};
+
+		Ptr<Object> queue = matches.Get(i);
+		if(m_enabled[COUNTER_DROP])
+		{
+			queue->TraceConnectWithoutContext("Drop", MakeBoundCallback(&QueueData::PacketDropSink, sink));
+		}
+		if(m_enabled[COUNTER_ENQUEUE])
+		{
+			queue->TraceConnectWithoutContext("Enqueue", MakeBoundCallback(&QueueData::EnqueueSink, sink));
+		}
+		if(m_enabled[COUNTER_DEQUEUE])
+		{
+			queue->TraceConnectWithoutContext("Dequeue", MakeBoundCallback(&QueueData::DequeueSink, sink));
+		}
 	}
-
 }
 
 void
 QueueData::ExportData()
 {
-	if(m_drop)
+	if(m_enabled[COUNTER_DROP])
 	{
-		ExportPacketDrop();
+		ExportCounter(COUNTER_DROP, "packet_drop_hisory", "Packet Drop");
 	}
-	if(m_enqueue)
+	if(m_enabled[COUNTER_ENQUEUE])
 	{
-		ExportPacketEnqueue();
+		ExportCounter(COUNTER_ENQUEUE, "packet_enqueue_hisory", "Packet Enqueue");
 	}
-	if(m_dequeue)
+	if(m_enabled[COUNTER_DEQUEUE])
 	{
-		ExportPacketDequeue();
+		ExportCounter(COUNTER_DEQUEUE, "packet_dequeue_hisory", "Packet Dequeue");
 	}
 }
 
 void
-QueueData::ExportPacketDrop()
+QueueData::ExportCounter(Counter_e c, std::string name, std::string title)
 {
 	std::fstream file;
-	std::string fileName = MakeFileName("packet_drop_hisory", ".csv");
+	std::string fileName = MakeFileName(name, ".csv");
 	fileName = StringConcat(m_simulationPrefix, fileName);
 	file.open(fileName.c_str(), std::fstream::out);
 
-	file << "Time,Total Packet Drop\n";
-	for(uint32_t i = 0; i < m_packetDropMap.size(); i++)
+	file << "Time,Total " << title << "\n";
+	for(uint32_t i = 0; i < m_sampleTimes.size(); i++)
 	{
-
-		file << m_packetDropMap[i].time << "," << m_packetDropMap[i].count << "\n";
+		uint64_t total = 0;
+		for(uint32_t q = 0; q < m_queues.size(); q++)
+		{
+			total += m_queues[q].history[c][i];
+		}
+		file << m_sampleTimes[i] << "," << total << "\n";
 	}
 	file.close();
-}
 
-void
-QueueData::ExportPacketEnqueue()
-{
-	std::fstream file;
-	std::string fileName = MakeFileName("packet_enqueue_hisory", ".csv");
+	fileName = MakeFileName(StringConcat(name, "_per_device"), ".csv");
 	fileName = StringConcat(m_simulationPrefix, fileName);
 	file.open(fileName.c_str(), std::fstream::out);
 
-	file << "Time,Total Packet Enqueue\n";
-	for(uint32_t i = 0; i < m_packetEnqueueMap.size(); i++)
+	file << "Time,Node,Device," << title << "\n";
+	for(uint32_t i = 0; i < m_sampleTimes.size(); i++)
 	{
-
-		file << m_packetEnqueueMap[i].time << "," << m_packetEnqueueMap[i].count << "\n";
+		for(uint32_t q = 0; q < m_queues.size(); q++)
+		{
+			file << m_sampleTimes[i] << "," << m_queues[q].node << "," << m_queues[q].device
+					<< "," << m_queues[q].history[c][i] << "\n";
+		}
 	}
 	file.close();
 }
 
 void
-QueueData::ExportPacketDequeue()
+QueueData::ExportBinary(ColumnarWriter & writer)
 {
-	std::fstream file;
-	std::string fileName = MakeFileName("packet_dequeue_hisory", ".csv");
-	fileName = StringConcat(m_simulationPrefix, fileName);
-	file.open(fileName.c_str(), std::fstream::out);
-
-	file << "Time,Total Packet Dequeue\n";
-	for(uint32_t i = 0; i < m_packetDequeueMap.size(); i++)
+	static const char * names[COUNTER_N] = {"packet_drop", "packet_enqueue", "packet_dequeue"};
+
+	uint32_t table = writer.AddTable("queue_counters");
+	writer.AddColumn(table, "time", ColumnarWriter::TYPE_F64);
+	writer.AddColumn(table, "node_id", ColumnarWriter::TYPE_U32);
+	writer.AddColumn(table, "device", ColumnarWriter::TYPE_U32);
+	uint32_t column[COUNTER_N];
+	for(uint32_t c = 0; c < COUNTER_N; c++)
 	{
-
-		file << m_packetDequeueMap[i].time << "," << m_packetDequeueMap[i].count << "\n";
+		if(m_enabled[c])
+		{
+			column[c] = writer.AddColumn(table, names[c], ColumnarWriter::TYPE_U64);
+		}
+	}
+	for(uint32_t i = 0; i < m_sampleTimes.size(); i++)
+	{
+		for(uint32_t q = 0; q < m_queues.size(); q++)
+		{
+			writer.PutDouble(table, 0, m_sampleTimes[i]);
+			writer.PutUint(table, 1, m_queues[q].node);
+			writer.PutUint(table, 2, m_queues[q].device);
+			for(uint32_t c = 0; c < COUNTER_N; c++)
+			{
+				if(m_enabled[c])
+				{
+					writer.PutUint(table, column[c], m_queues[q].history[c][i]);
+				}
+			}
+			writer.EndRow(table);
+		}
 	}
-	file.close();
 }
 
 void
@@ -195,67 +228,47 @@ QueueData::SetTargetConnection(std::string con)
 }
 
 void
-QueueData::PacketDropSink(Ptr<const Packet> p)
+QueueData::PacketDropSink(QueueSink_s q, Ptr<const Packet> p)
 {
-	m_totalPacketDrop++;
-	if(m_dropPcap)
-	{
-		m_packetDrop->Write(Simulator::Now(), p);
-	}
-	MapPacketDrop();
-
+	q.owner->Count(q.index, COUNTER_DROP, p);
 }
 
 void
-QueueData::EnqueueSink(Ptr<const Packet> p)
+QueueData::EnqueueSink(QueueSink_s q, Ptr<const Packet> p)
 {
-	m_totalPacketEnqueue++;
-	if(m_enqueuePcap)
-	{
-		m_packetEnqueue->Write(Simulator::Now(), p);
-	}
-	MapPacketEnqueue();
-}
-
-void
-QueueData::DequeueSink(Ptr<const Packet> p)
-{
-	m_totalPacketEnqueue++;
-	if(m_enqueuePcap)
-	{
-		m_packetEnqueue->Write(Simulator::Now(), p);
-	}
-	MapPacketDequeue();
+	q.owner->Count(q.index, COUNTER_ENQUEUE, p);
 }
 
 void
-QueueData::MapPacketDrop()
+QueueData::DequeueSink(QueueSink_s q, Ptr<const Packet> p)
 {
-	CounterMap_s c = {
-			Simulator::Now().GetSeconds(), m_totalPacketDrop
-	};
-	m_packetDropMap.push_back(c);
-	Simulator::Schedule(Seconds(m_timeInterval), &QueueData::MapPacketDrop, this);
+	q.owner->Count(q.index, COUNTER_DEQUEUE, p);
 }
 
 void
-QueueData::MapPacketEnqueue()
+QueueData::Count(uint32_t q, Counter_e c, Ptr<const Packet> p)
 {
-	CounterMap_s c = {
-			Simulator::Now().GetSeconds(), m_totalPacketEnqueue
-	};
-	m_packetEnqueueMap.push_back(c);
-	Simulator::Schedule(Seconds(m_timeInterval), &QueueData::MapPacketEnqueue, this);
+	m_queues[q].count[c]++;
+	if(m_pcap[c])
+	{
+		m_pcapFile[c]->Write(Simulator::Now(), p);
+	}
 }
 
 void
-QueueData::MapPacketDequeue()
+QueueData::Sample()
 {
-	CounterMap_s c = {
-			Simulator::Now().GetSeconds(), m_totalPacketDequeue
-	};
-	m_packetDequeueMap.push_back(c);
-	Simulator::Schedule(Seconds(m_timeInterval), &QueueData::MapPacketDequeue, this);
+	m_sampleTimes.push_back(Simulator::Now().GetSeconds());
+	for(uint32_t q = 0; q < m_queues.size(); q++)
+	{
+		for(uint32_t c = 0; c < COUNTER_N; c++)
+		{
+			if(m_enabled[c])
+			{
+				m_queues[q].history[c].push_back(m_queues[q].count[c]);
+			}
+		}
+	}
 }
 
 } /* namespace ns3 */
@@ -89,76 +89,91 @@ public:
 
 	virtual ~QueueData();
 private:
-	struct CounterMap_s {
-		double time;
-		uint64_t count;
+	/**
+	 * \brief The traced queue events
+	 */
+	enum Counter_e {
+		COUNTER_DROP = 0,
+		COUNTER_ENQUEUE,
+		COUNTER_DEQUEUE,
+		COUNTER_N
+	};
+	/**
+	 * \brief The counters and their history of a queue
+	 */
+	struct QueueCounters_s {
+		uint32_t node; //!< The node of queue
+		uint32_t device; //!< The device of queue on node
+		uint64_t count[COUNTER_N]; //!< The running counters
+		std::vector<uint64_t> history[COUNTER_N]; //!< The counters at each sample
+	};
+	/**
+	 * \brief The argument bound to the sinks of a queue
+	 *
+	 * The queue is bound by its index in m_queues, a pointer into the
+	 * vector would not outlive a reallocation.
+	 */
+	struct QueueSink_s {
+		QueueData * owner; //!< The collector of queue
+		uint32_t index; //!< The index of queue in m_queues
 	};
-	EventId m_mapEvent; //!< Keep track of scheduled event
-	bool m_enqueuePcap; //!< Flag to enable or disable .pacp for packet enqueue
-	bool m_dequeuePcap; //!< Flag to enable or disable .pcap for packet dequeue
-	bool m_dropPcap; //!< Flag to enable or disable .pcap for packet drop
 
-	bool m_enqueue; //!< Flag to enable or disable data collection for packet enqueue
-	bool m_dequeue; //!< Flag to enable or disable data collection for packet dequeue
-	bool m_drop; //!< Flag to enable or disable data collection for packet drop
+	bool m_pcap[COUNTER_N]; //!< Flags to enable or disable .pcap per event
+	bool m_enabled[COUNTER_N]; //!< Flags to enable or disable data collection per event
 
 	std::string m_conString; //!< Connection string to a queue of NetDevice
 
-	uint64_t m_totalPacketDrop; //!< Packet drop counter
-	uint64_t m_totalPacketEnqueue; //!< Packet enqueue counter
-	uint64_t m_totalPacketDequeue; //!< Packet dequeue counter
-
+	Ptr<PcapFileWrapper> m_pcapFile[COUNTER_N]; //!< The pcap writer per event
 
-	 Ptr<PcapFileWrapper> m_packetDrop; //!< Packet drop pcap writer
-	 Ptr<PcapFileWrapper> m_packetEnqueue; //!< Packet enqueue pcap writer
-	 Ptr<PcapFileWrapper> m_packetDequeue; //!< Packet dequeue pcap writer
-
-	 std::vector<CounterMap_s> m_packetDropMap; //!< Holds counter history for packet drop
-	 std::vector<CounterMap_s> m_packetEnqueueMap; //!< Holds counter history for packet enqueue
-	 std::vector<CounterMap_s> m_packetDequeueMap; //!< Holds counter history for packet dequeue
+	std::vector<QueueCounters_s> m_queues; //!< The traced queues, one per NetDevice
+	std::vector<double> m_sampleTimes; //!< The time of each sample
 
+	/**
+	 * \brief Exports the enabled counters of each device as one table
+	 */
+	virtual void ExportBinary(ColumnarWriter & writer);
 
 	/**
 	 * \brief Callback to catch the traced packet drop
+	 * \param q The collector and index of queue
 	 * \param p The packet dropped by queue
 	 */
-	void PacketDropSink(Ptr<const Packet> p);
+	static void PacketDropSink(QueueSink_s q, Ptr<const Packet> p);
 	/**
 	 * \brief Callback to catch the enqueued packet
+	 * \param q The collector and index of queue
 	 * \param p The packet enqueued
 	 */
-	void EnqueueSink(Ptr<const Packet> p);
+	static void EnqueueSink(QueueSink_s q, Ptr<const Packet> p);
 	/**
-	 * \brief Callback to catch the enqueued packet
+	 * \brief Callback to catch the dequeued packet
+	 * \param q The collector and index of queue
 	 * \param p The packet dequeued
 	 */
-	void DequeueSink(Ptr<const Packet> p);
+	static void DequeueSink(QueueSink_s q, Ptr<const Packet> p);
 
 	/**
-	 * \brief Maps the packet drop history
-	 */
-	void MapPacketDrop();
-	/**
-	 * \brief Maps the packet enqueue history
-	 */
-	void MapPacketEnqueue();
-	/**
-	 * \brief Maps the packet dequeue history
+	 * \brief Counts a traced event and writes the packet to pcap if enabled
 	 */
-	void MapPacketDequeue();
+	void Count(uint32_t q, Counter_e c, Ptr<const Packet> p);
 
 	/**
-	 * \brief Export Packet drop data
+	 * \brief Enables the data collection of an event
 	 */
-	void ExportPacketDrop();
+	void EnableCounter(Counter_e c, bool pcap, std::string name);
+
 	/**
-	 * \brief Export Packet enqueue data
+	 * \brief Snapshots the counters of all queues, on the ticks of sampling clock
 	 */
-	void ExportPacketEnqueue();
+	virtual void Sample();
+
 	/**
-	 * \brief Export Packet dequeue data
+	 * \brief Exports the history of an event, in total and per device
+	 * \param c The event
+	 * \param name The file name
+	 * \param title The column title
 	 */
-	void ExportPacketDequeue();
+	void ExportCounter(Counter_e c, std::string name, std::string title);
 
 };
 
@@ -79,75 +79,23 @@ SjfFirstFitVmScheduler::~SjfFirstFitVmScheduler() {
 	// TODO Auto-generated destructor stub
 }
 
-void
-SjfFirstFitVmScheduler::SortVmList()
+bool
+SjfFirstFitVmScheduler::CompareVm(const VmProperties & a, const VmProperties & b) const
 {
-	NS_LOG_INFO(this);
-	NS_LOG_UNCOND("Sorting SJF");
-		for(uint32_t i = 0; i < m_vmList.size(); i++)
-		{
-			VmProperties tmp;
-			for(uint32_t j = i + 1; j < m_vmList.size(); j++)
-			{
-				if(m_vmList[j].arrivalTime <= m_vmList[i].arrivalTime)
-				{
-					if(m_vmList[j].arrivalTime == m_vmList[i].arrivalTime)
-					{
-						uint32_t i_vmScore = 0;
-						uint32_t j_vmScore = 0;
-						if(m_vmList[i].dataAmount <= m_vmList[j].dataAmount)
-						{
-							i_vmScore += 10;
-							j_vmScore += 5;
-						}
-						else
-						{
-							i_vmScore += 5;
-							j_vmScore += 10;
-						}
-
-						if(m_vmList[i].appSize <= m_vmList[j].appSize)
-						{
-							i_vmScore += 10;
-							j_vmScore += 5;
-						}
-						else
-						{
-							i_vmScore += 5;
-							j_vmScore += 10;
-						}
-
-						if(m_vmList[i].processing < m_vmList[j].processing)
-						{
-							i_vmScore += 5;
-							j_vmScore += 10;
-						}
-						else
-						{
-							i_vmScore += 10;
-							j_vmScore += 5;
-						}
-						// greater score = shortest job
-						if(i_vmScore < j_vmScore)
-						{
-							// swap i <-> j
-							tmp = m_vmList[i];
-							m_vmList[i] = m_vmList[j];
-							m_vmList[j] = tmp;
-						}
-					}
-					else
-					{
-						tmp = m_vmList[i];
-						m_vmList[i] = m_vmList[j];
-						m_vmList[j] = tmp;
-					}
-
-				}
-			}
-		}
+	if(a.arrivalTime != b.arrivalTime)
+	{
+		return a.arrivalTime < b.arrivalTime;
+	}
+	// on equal arrival the shortest job goes first
+	if(a.dataAmount != b.dataAmount)
+	{
+		return a.dataAmount < b.dataAmount;
+	}
+	if(a.appSize.GetApplicationSize() != b.appSize.GetApplicationSize())
+	{
+		return a.appSize.GetApplicationSize() < b.appSize.GetApplicationSize();
+	}
+	return a.processing.GetProcessingPower() > b.processing.GetProcessingPower();
 }
 
-
-
 } /* namespace ns3 */
@@ -66,7 +66,13 @@ public:
 	virtual ~SjfFirstFitVmScheduler();
 
 protected:
-	virtual void SortVmList();
+	/**
+	 * \brief Orders VMs by arrival, shortest job first on equal arrival
+	 *
+	 * VMs arriving together are ordered by smaller data amount, then
+	 * smaller application size, then larger processing power.
+	 */
+	virtual bool CompareVm(const VmProperties & a, const VmProperties & b) const;
 
 };
 
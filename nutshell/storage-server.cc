@@ -23,6 +23,7 @@
 #include "ns3/data-rate.h"
 
 #include "storage-util.h"
+#include "vm-control-header.h"
 
 
 namespace ns3 {
@@ -109,12 +110,21 @@ StorageServer::GetMtu()
 	return m_mtu;
 }
 
+void
+StorageServer::SetFlowNetwork(Ptr<FlowNetwork> network)
+{
+	NS_LOG_FUNCTION(this);
+	m_flowNetwork = network;
+}
+
 void
 StorageServer::DoDispose()
 {
 	NS_LOG_FUNCTION (this);
 	m_socket = 0;
+	m_flowNetwork = 0;
 	m_socketList.clear ();
+	m_controlStream.Clear ();
 	Application::DoDispose ();
 }
 
@@ -125,6 +135,12 @@ StorageServer::StartApplication (void)
   // Create the socket if not already
 //  	  m_tid = TypeId::LookupByName ("ns3::TcpSocketFactory");
 //  	  NS_LOG_INFO("local: " << m_local);
+	if (m_flowNetwork)
+	{
+		m_flowNetwork->BindServer(GetNode(), InetSocketAddress::ConvertFrom(m_local).GetPort(),
+				MakeCallback(&StorageServer::HandleFlowRequest, this));
+		return;
+	}
 	if (!m_socket)
 	{
 		m_socket = Socket::CreateSocket(GetNode(), m_tid);
@@ -157,10 +173,15 @@ void
 StorageServer::StopApplication ()
 {
   NS_LOG_FUNCTION (this);
+	if (m_flowNetwork)
+	{
+		m_flowNetwork->Unbind(GetNode(), InetSocketAddress::ConvertFrom(m_local).GetPort());
+	}
 	while (!m_socketList.empty()) //these are accepted sockets, close them
 	{
 		Ptr<Socket> acceptedSocket = m_socketList.front();
 		m_socketList.pop_front();
+		m_controlStream.Remove(acceptedSocket);
 		acceptedSocket->Close();
 	}
 	if (m_socket) {
@@ -198,16 +219,17 @@ StorageServer::HandleRead (Ptr<Socket> socket)
 		}
 		m_rxTrace(packet, from);
 
-		std::ostringstream *os = new std::ostringstream();
-		packet->CopyData(os, packet->GetSize());
-		std::string s = os->str();
-		 //first splitting the string in half to access rate and required data
-		NS_LOG_INFO("String received: " << s);
-		std::string::size_type n = s.find_first_of("|");
-		std::string firstPart = s.substr(0, n);
-		std::string secondPart = s.substr(n, std::string::npos);
-//		socket->Connect(from);
-		ScheduleSend(socket, Storage(ExtractData(firstPart)), DataRate(ExtractData(secondPart)));
+		// a request may be split over two reads, keep the partial bytes
+		m_controlStream.Receive(socket, packet);
+		VmControlHeader control;
+		while(m_controlStream.Next(socket, control))
+		{
+			NS_LOG_INFO("Control received: " << control);
+			if(control.GetType() == VmControlHeader::REQUEST)
+			{
+				ScheduleSend(socket, Storage(control.GetDataAmount()), control.GetRate());
+			}
+		}
 	}
 
 
@@ -235,18 +257,6 @@ StorageServer::HandleAccept (Ptr<Socket> s, const Address& from)
   m_socketList.push_back (s);
 }
 
-uint64_t
-StorageServer::ExtractData(std::string s)
-{
-	std::string::size_type n = s.find_first_of("0123456789.");
-	std::istringstream iss;
-	iss.str(s.substr(n, std::string::npos));
-	NS_LOG_INFO("Extracted Value: " << s.substr(n, std::string::npos));
-	double r;
-	iss >> r;
-	return (uint64_t)r;
-}
-
 void
 StorageServer::ScheduleSend(Ptr<Socket> socket, const Storage& reqData, const DataRate& rate)
 {
@@ -286,8 +296,19 @@ StorageServer::Send(Ptr<Socket> socket, Storage& reqData, const DataRate& rate)
 	else
 	{
 		m_socketList.remove(socket);
+		m_controlStream.Remove(socket);
 		socket->Close();
 	}
 }
 
+void
+StorageServer::HandleFlowRequest(Ptr<Node> client, uint16_t port, uint64_t bytes, DataRate rate)
+{
+	NS_LOG_FUNCTION(this << client->GetId() << port << bytes);
+	if(bytes > 0)
+	{
+		m_flowNetwork->StartFlow(GetNode(), client, port, bytes, rate, MakeNullCallback<void>());
+	}
+}
+
 } /* namespace ns3 */
@@ -16,6 +16,8 @@
 #include "ns3/data-rate.h"
 
 #include "storage-util.h"
+#include "flow-network.h"
+#include "vm-control-header.h"
 
 namespace ns3 {
 
@@ -58,6 +60,12 @@ public:
 	  void SetMtu(const uint16_t mtu);
 	  uint16_t GetMtu();
 
+	  /**
+	   * \brief Set the flow network, requests are then served as flows instead of packets
+	   * \param network The flow network of datacenter, 0 for packet transfer
+	   */
+	  void SetFlowNetwork(Ptr<FlowNetwork> network);
+
 protected:
 	virtual void DoDispose (void);
 private:
@@ -87,12 +95,6 @@ private:
 	   */
 	  void HandlePeerError (Ptr<Socket> socket);
 
-	  /**
-	   * \brief Extract data from string i.e. extract Required Data and Rate of VM Request
-	   * \param s a string value of specific format
-	   */
-	  uint64_t ExtractData(std::string s);
-
 	  /**
 	   * \brief
 	   */
@@ -103,14 +105,25 @@ private:
 	   */
 	  void Send(Ptr<Socket> socket, Storage& reqData, const DataRate& rate);
 
+	  /**
+	   * \brief Handle a request received over the flow network
+	   * \param client the node of requesting VM
+	   * \param port the port to deliver the data to
+	   * \param bytes the amount of data requested
+	   * \param rate the rate at which the VM receives data
+	   */
+	  void HandleFlowRequest(Ptr<Node> client, uint16_t port, uint64_t bytes, DataRate rate);
+
 	  // In the case of TCP, each socket accept returns a new socket, so the
 	  // listening socket is stored separately from the accepted sockets
 	  Ptr<Socket>     m_socket;       //!< Listening socket
 	  std::list<Ptr<Socket> > m_socketList; //!< the accepted sockets
+	  VmControlStream m_controlStream; //!< Requests not yet complete per accepted socket
 
 	  Address         	m_local;        //!< Local address to bind to
 	  TypeId          	m_tid;          //!< Protocol TypeId
 	  uint16_t			m_mtu;
+	  Ptr<FlowNetwork>	m_flowNetwork;	//!< The flow network, 0 for packet transfer
 
 	  /// Traced Callback: received packets, source address.
 	  TracedCallback<Ptr<const Packet>, const Address &> m_rxTrace;
@@ -0,0 +1,191 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *
+ * streaming-csv-writer.cc
+ *
+ *  Created on: Apr 5, 2017
+ *      Author: ubaid
+ *       Email: u.ur.rahman@gmail.com
+ */
+
+#include "ns3/log.h"
+#include "ns3/fatal-error.h"
+#include "ns3/callback.h"
+
+#include "streaming-csv-writer.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("StreamingCsvWriter");
+
+StreamingCsvWriter::StreamingCsvWriter()
+	: m_columns(0),
+	  m_capacity(8192),
+	  m_flushPeriod(1000),
+	  m_head(0),
+	  m_count(0),
+	  m_closing(false)
+{
+}
+
+StreamingCsvWriter::~StreamingCsvWriter()
+{
+	Close();
+}
+
+void
+StreamingCsvWriter::Open(std::string fileName, std::string header, uint32_t columns)
+{
+	NS_LOG_FUNCTION(this << fileName);
+	Close();
+	m_file.open(fileName.c_str(), std::fstream::out);
+	if(!m_file.is_open())
+	{
+		NS_FATAL_ERROR("Unable to create export file " << fileName);
+	}
+	m_file.precision(12);
+	m_file << header << "\n";
+
+	m_columns = columns;
+	m_ring.assign(static_cast<size_t>(m_capacity) * m_columns, 0);
+	m_head = 0;
+	m_count = 0;
+	m_closing = false;
+	m_dataReady.SetCondition(false);
+	m_spaceReady.SetCondition(true);
+	m_thread = Create<SystemThread>(MakeCallback(&StreamingCsvWriter::Run, this));
+	m_thread->Start();
+}
+
+void
+StreamingCsvWriter::Close()
+{
+	if(m_thread == 0)
+	{
+		return;
+	}
+	m_mutex.Lock();
+	m_closing = true;
+	m_mutex.Unlock();
+	m_dataReady.SetCondition(true);
+	m_dataReady.Signal();
+	m_thread->Join();
+	m_thread = 0;
+
+	m_file.close();
+	m_ring.clear();
+}
+
+bool
+StreamingCsvWriter::IsOpen() const
+{
+	return m_thread != 0;
+}
+
+void
+StreamingCsvWriter::SetCapacity(uint32_t rows)
+{
+	NS_ASSERT_MSG(m_thread == 0, "The capacity is set before Open");
+	m_capacity = rows > 1 ? rows : 2;
+}
+
+void
+StreamingCsvWriter::SetFlushPeriod(uint32_t ms)
+{
+	m_flushPeriod = ms;
+}
+
+void
+StreamingCsvWriter::Append(const double * values)
+{
+	NS_ASSERT_MSG(m_thread != 0, "Append to a closed stream");
+	m_mutex.Lock();
+	while(m_count == m_capacity)
+	{
+		// the writer sets it back once the buffer is drained
+		m_spaceReady.SetCondition(false);
+		m_mutex.Unlock();
+		m_dataReady.SetCondition(true);
+		m_dataReady.Signal();
+		m_spaceReady.TimedWait(static_cast<uint64_t>(m_flushPeriod) * 1000000);
+		m_mutex.Lock();
+	}
+	uint32_t tail = (m_head + m_count) % m_capacity;
+	std::copy(values, values + m_columns, m_ring.begin() + static_cast<size_t>(tail) * m_columns);
+	m_count++;
+	bool wake = m_count == m_capacity / 2;
+	m_mutex.Unlock();
+
+	if(wake)
+	{
+		m_dataReady.SetCondition(true);
+		m_dataReady.Signal();
+	}
+}
+
+/*
+ * ------------- private methods -------------
+ */
+
+void
+StreamingCsvWriter::Run()
+{
+	// the conditions are only cleared by their waiter, a signal sent
+	// before the wait is not lost
+	do
+	{
+		m_dataReady.TimedWait(static_cast<uint64_t>(m_flushPeriod) * 1000000);
+		m_dataReady.SetCondition(false);
+	}
+	while(Drain());
+}
+
+bool
+StreamingCsvWriter::Drain()
+{
+	// the rows are copied out, so Append is blocked only for the copy
+	m_mutex.Lock();
+	uint32_t rows = m_count;
+	bool closing = m_closing;
+	m_drained.resize(static_cast<size_t>(rows) * m_columns);
+	for(uint32_t r = 0; r < rows; r++)
+	{
+		uint32_t slot = (m_head + r) % m_capacity;
+		std::copy(m_ring.begin() + static_cast<size_t>(slot) * m_columns,
+				m_ring.begin() + static_cast<size_t>(slot + 1) * m_columns,
+				m_drained.begin() + static_cast<size_t>(r) * m_columns);
+	}
+	m_head = (m_head + rows) % m_capacity;
+	m_count = 0;
+	m_mutex.Unlock();
+	m_spaceReady.SetCondition(true);
+	m_spaceReady.Broadcast();
+
+	for(uint32_t r = 0; r < rows; r++)
+	{
+		const double * row = &m_drained[static_cast<size_t>(r) * m_columns];
+		for(uint32_t c = 0; c < m_columns; c++)
+		{
+			m_file << (c > 0 ? "," : "") << row[c];
+		}
+		m_file << "\n";
+	}
+	m_file.flush();
+	return !closing;
+}
+
+} /* namespace ns3 */
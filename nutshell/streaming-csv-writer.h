@@ -0,0 +1,115 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *
+ * streaming-csv-writer.h
+ *
+ *  Created on: Apr 5, 2017
+ *      Author: ubaid
+ *       Email: u.ur.rahman@gmail.com
+ */
+
+#ifndef NUTSHELL_STREAMING_CSV_WRITER_H
+#define NUTSHELL_STREAMING_CSV_WRITER_H
+
+#include <stdint.h>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "ns3/ptr.h"
+#include "ns3/system-thread.h"
+#include "ns3/system-mutex.h"
+#include "ns3/system-condition.h"
+
+namespace ns3 {
+
+/**
+ * \brief Writes rows of a CSV file from a background thread
+ *
+ * Rows of numeric columns are appended to a bounded ring buffer, a writer
+ * thread drains the buffer to the file when it is half full or after the
+ * flush period, so the memory used by a long simulation stays flat and the
+ * rows written so far survive a crash. When the buffer is full, Append
+ * waits for the writer thread.
+ */
+class StreamingCsvWriter {
+public:
+	StreamingCsvWriter();
+	virtual ~StreamingCsvWriter();
+
+	/**
+	 * \brief Creates the file, writes the header and starts the writer thread
+	 * \param fileName The path of file
+	 * \param header The header line, without new line
+	 * \param columns The number of columns of each row
+	 */
+	void Open(std::string fileName, std::string header, uint32_t columns);
+	/**
+	 * \brief Writes the remaining rows, stops the writer thread and closes the file
+	 */
+	void Close();
+	/**
+	 * \return true if the file is open
+	 */
+	bool IsOpen() const;
+	/**
+	 * \brief Set the number of rows held by the ring buffer, before Open
+	 * \param rows The capacity of buffer
+	 */
+	void SetCapacity(uint32_t rows);
+	/**
+	 * \brief Set the wall clock time after which buffered rows are written
+	 * \param ms The period in milliseconds
+	 */
+	void SetFlushPeriod(uint32_t ms);
+	/**
+	 * \brief Appends a row to the buffer
+	 * \param values The values of the row, one per column
+	 */
+	void Append(const double * values);
+
+private:
+	/**
+	 * \brief The writer thread, drains the buffer until closed
+	 */
+	void Run();
+	/**
+	 * \brief Writes the buffered rows to the file
+	 * \return false once the writer is closed and nothing is left
+	 */
+	bool Drain();
+
+	std::fstream m_file; //!< The output file
+	uint32_t m_columns; //!< Columns per row
+	uint32_t m_capacity; //!< Rows held by the buffer
+	uint32_t m_flushPeriod; //!< Flush period in milliseconds
+
+	std::vector<double> m_ring; //!< The buffered rows
+	uint32_t m_head; //!< The oldest buffered row
+	uint32_t m_count; //!< The number of buffered rows
+	bool m_closing; //!< Set to stop the writer thread
+	std::vector<double> m_drained; //!< Rows taken from the buffer by the writer
+
+	Ptr<SystemThread> m_thread; //!< The writer thread
+	SystemMutex m_mutex; //!< Guards the buffer
+	SystemCondition m_dataReady; //!< Signalled when rows are waiting
+	SystemCondition m_spaceReady; //!< Signalled when the buffer is drained
+};
+
+} /* namespace ns3 */
+
+#endif /* NUTSHELL_STREAMING_CSV_WRITER_H */
@@ -214,7 +214,7 @@ ThreeTier::CreateAccessNetwork()
 		st.Install(accNodes);
 		m_accessNetworks[i].SetIntenetStack(st);
 		m_accessNetworks[i].SetChannel(p2p);
-		m_accessNetworks[i].SetNetwork(m_addrScheme->GetNetwork(i), m_addrScheme->GetSubnet(i));
+		m_accessNetworks[i].SetNetwork(m_addrScheme->GetNetworkAddress(i), m_addrScheme->GetNetworkMask(i));
 		m_accessNetworks[i].SetNodes(accNodes);
 		m_accessNetworks[i].CreateNetwork();
 		m_nodesInterfaces.Add(m_accessNetworks[i].GetTerminalInterfaces());
@@ -278,8 +278,8 @@ ThreeTier::ConnectAggToAcc()
 		// now connecting the selected agg switch to all access switches of the pod
 //		NS_LOG_UNCOND(m_addrScheme->GetNetwork(m_ipsCovered) << "Ip Coverd: " << m_ipsCovered);
 		connect.ConnectDevicesLayer3(aggSwitch, accSwitches, p2pAccAgg,
-										m_addrScheme->GetNetwork(m_ipsCovered),
-										m_addrScheme->GetSubnet(m_ipsCovered));
+										m_addrScheme->GetNetworkAddress(m_ipsCovered),
+										m_addrScheme->GetNetworkMask(m_ipsCovered));
 
 		m_ipsCovered++;
 //		NS_LOG_UNCOND("i = " << i << " | Pod Begin: " << podBegin << " | Pod End: " << podEnd);
@@ -307,16 +307,16 @@ ThreeTier::ConnectAggToAgg()
 			Ptr<Node> nextAggSw = m_aggSwitches.Get(aggCount+1);
 			// establishing a forward link
 			ch.ConnectDevicesLayer3(currentAggSw, nextAggSw, aggTaggP2p,
-									m_addrScheme->GetNetwork(m_ipsCovered),
-									m_addrScheme->GetSubnet(m_ipsCovered));
+									m_addrScheme->GetNetworkAddress(m_ipsCovered),
+									m_addrScheme->GetNetworkMask(m_ipsCovered));
 //			NS_LOG_UNCOND("Forward: " << m_addrScheme.GetNetwork(m_ipsCovered));
 			m_ipsCovered++;
 
 			// establishing a backward link
 
 			ch.ConnectDevicesLayer3(nextAggSw, currentAggSw, aggTaggP2p,
-									m_addrScheme->GetNetwork(m_ipsCovered),
-									m_addrScheme->GetSubnet(m_ipsCovered));
+									m_addrScheme->GetNetworkAddress(m_ipsCovered),
+									m_addrScheme->GetNetworkMask(m_ipsCovered));
 
 			m_ipsCovered++;
 
@@ -336,8 +336,8 @@ ThreeTier::ConnectCoreToAgg()
 	{
 		Ptr<Node> curCore = m_coreSwitches.Get(i);
 		ch.ConnectDevicesLayer3(curCore, m_aggSwitches, aggTcore,
-								m_addrScheme->GetNetwork(m_ipsCovered),
-								m_addrScheme->GetSubnet(m_ipsCovered));
+								m_addrScheme->GetNetworkAddress(m_ipsCovered),
+								m_addrScheme->GetNetworkMask(m_ipsCovered));
 		m_ipsCovered++;
 	}
 }
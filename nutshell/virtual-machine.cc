@@ -68,10 +68,13 @@ VirtualMachine::VirtualMachine()
 	: m_processingPower("1GFLOPS"),
 	  m_primaryStorage("8GB"),
 	  m_secondaryStorage("500GB"),
-	  m_applicationSize("10MFLOP")
+	  m_applicationSize("10MFLOP"),
+	  m_cpuWork(0),
+	  m_adoptedReservation(false)
 {
 	NS_LOG_FUNCTION(this);
 	m_cnode = 0;
+	m_reservedResources = false;
 }
 
 VirtualMachine::VirtualMachine(const ProcessingPower& power,
@@ -81,9 +84,12 @@ VirtualMachine::VirtualMachine(const ProcessingPower& power,
 	: m_processingPower(power),
 	  m_primaryStorage(pStorage),
 	  m_secondaryStorage(sStorage),
-	  m_applicationSize(appSize)
+	  m_applicationSize(appSize),
+	  m_cpuWork(0),
+	  m_adoptedReservation(false)
 {
 	NS_LOG_FUNCTION(this);
+	m_reservedResources = false;
 }
 
 VirtualMachine::~VirtualMachine()
@@ -155,6 +161,20 @@ VirtualMachine::IsResourcesReserved() const
 	return m_reservedResources;
 }
 
+void
+VirtualMachine::AdoptReservation()
+{
+	NS_LOG_FUNCTION(this);
+	m_adoptedReservation = true;
+	m_reservedResources = true;
+}
+
+void
+VirtualMachine::SetReleaseCallback(Callback<void, Ptr<VirtualMachine> > cb)
+{
+	m_releaseCallback = cb;
+}
+
 /*
  * ----------------- end of setter and getters section -----
  */
@@ -182,6 +202,10 @@ void
 VirtualMachine::DoDispose()
 {
 	NS_LOG_FUNCTION(this);
+	CancelProcessing();
+	Simulator::Cancel(m_finishEvent);
+	m_releaseCallback = MakeNullCallback<void, Ptr<VirtualMachine> >();
+	m_cnode = 0;
 //	Application::DoDispose();
 }
 
@@ -189,7 +213,7 @@ void
 VirtualMachine::ScheduleStop(double time)
 {
 	NS_LOG_FUNCTION(this);
-	Simulator::Schedule(Seconds(time), &VirtualMachine::StopApplication, this);
+	m_finishEvent = Simulator::Schedule(Seconds(time), &VirtualMachine::StopApplication, this);
 }
 
 bool
@@ -197,6 +221,11 @@ VirtualMachine::ReserveResources()
 {
 	NS_LOG_FUNCTION(this);
 
+	if(m_adoptedReservation)
+	{
+		// reserved by the scheduler before the VM was installed
+		return true;
+	}
 	if(m_cnode != 0)
 	{
 		if(m_cnode->ReserveResources(m_processingPower, m_primaryStorage, m_secondaryStorage))
@@ -220,7 +249,37 @@ void
 VirtualMachine::ReleaseResources()
 {
 	NS_LOG_FUNCTION(this);
+	CancelProcessing();
 	m_cnode->ReleaseResources(m_processingPower, m_primaryStorage, m_secondaryStorage);
+	// released once, a later stop finds nothing to release
+	m_reservedResources = false;
+	if(!m_releaseCallback.IsNull())
+	{
+		m_releaseCallback(this);
+	}
+}
+
+void
+VirtualMachine::ScheduleProcessing(double delay)
+{
+	NS_LOG_FUNCTION(this << delay);
+	if(m_cnode != 0 && m_cnode->IsProcessorSharing())
+	{
+		m_processingEvent = Simulator::Schedule(Seconds(delay), &VirtualMachine::SubmitProcessing, this);
+	}
+	else
+	{
+		double processingTime = CalculateProcessingTime();
+		m_processingEvent = Simulator::Schedule(Seconds(delay + processingTime),
+				&VirtualMachine::ProcessingCompleted, this);
+	}
+}
+
+void
+VirtualMachine::ProcessingCompleted()
+{
+	NS_LOG_FUNCTION(this);
+	ScheduleStop(0.0);
 }
 
 /*
@@ -237,8 +296,7 @@ VirtualMachine::StartApplication()
 	NS_LOG_FUNCTION(this);
 	if(ReserveResources())
 	{
-		double stopTime = CalculateProcessingTime();
-		ScheduleStop(stopTime);
+		ScheduleProcessing(0.0);
 	}
 	else
 	{
@@ -257,6 +315,35 @@ VirtualMachine::StopApplication()
 	}
 }
 
+void
+VirtualMachine::SubmitProcessing()
+{
+	NS_LOG_FUNCTION(this);
+	m_cpuWork = m_cnode->SubmitWork(m_applicationSize.GetApplicationSize(),
+			m_processingPower.GetProcessingPower(),
+			MakeCallback(&VirtualMachine::WorkCompleted, this));
+}
+
+void
+VirtualMachine::WorkCompleted()
+{
+	NS_LOG_FUNCTION(this);
+	m_cpuWork = 0;
+	ProcessingCompleted();
+}
+
+void
+VirtualMachine::CancelProcessing()
+{
+	NS_LOG_FUNCTION(this);
+	Simulator::Cancel(m_processingEvent);
+	if(m_cpuWork != 0)
+	{
+		m_cnode->CancelWork(m_cpuWork);
+		m_cpuWork = 0;
+	}
+}
+
 /*
  * ------------end of private methods
  */
@@ -15,6 +15,7 @@
 #include "ns3/ptr.h"
 #include "ns3/data-rate.h"
 #include "ns3/traced-callback.h"
+#include "ns3/callback.h"
 
 #include "application-size-util.h"
 #include "processing-power-util.h"
@@ -50,6 +51,19 @@ public:
 	ApplicationSize GetApplicationSize(void) const;
 	Ptr<ComputationalNode> GetCompNode() const;
 	bool IsResourcesReserved() const;
+	/**
+	 * \brief Takes over the resources already reserved for the VM on its node
+	 *
+	 * The VM does not reserve again when it starts and releases the
+	 * resources when it stops.
+	 */
+	void AdoptReservation();
+	/**
+	 * \brief Sets the callback invoked once the VM has released its resources
+	 *
+	 * \param cb The callback, with the VM stopped
+	 */
+	void SetReleaseCallback(Callback<void, Ptr<VirtualMachine> > cb);
 
 	double CalculateProcessingTime();
 
@@ -60,13 +74,51 @@ protected:
 	bool ReserveResources();
 	void ReleaseResources();
 
+	/**
+	 * \brief Schedules the processing of application
+	 *
+	 * The application is processed after the delay, e.g. the time to fetch
+	 * data, and ProcessingCompleted is called when done. On a node with
+	 * processor sharing the application size is submitted to the node CPU and
+	 * the VM shares the node processing power with co-located VMs, weighted
+	 * by its own processing power. Otherwise processing takes
+	 * CalculateProcessingTime at the reserved processing power.
+	 *
+	 * \param delay the time in seconds before processing begins
+	 */
+	void ScheduleProcessing(double delay);
+	/**
+	 * \brief Called when the application has been processed
+	 *
+	 * The default stops the VM, VMs transmitting their results override it.
+	 */
+	virtual void ProcessingCompleted();
+
 	bool					m_reservedResources;
+	EventId					m_finishEvent; //!< The scheduled stop of VM
 private:
+	/**
+	 * \brief Submits the application to the processor sharing CPU of node
+	 */
+	void SubmitProcessing();
+	/**
+	 * \brief Completion callback of processor sharing CPU
+	 */
+	void WorkCompleted();
+	/**
+	 * \brief Cancels processing that has not completed yet
+	 */
+	void CancelProcessing();
+
 	ProcessingPower 		m_processingPower;
 	Storage					m_primaryStorage;
 	Storage					m_secondaryStorage;
 	ApplicationSize			m_applicationSize;
 	Ptr<ComputationalNode>	m_cnode;
+	EventId					m_processingEvent; //!< Processing completion or submission
+	uint64_t				m_cpuWork; //!< ID of work on processor sharing CPU, 0 if none
+	bool					m_adoptedReservation; //!< The resources were reserved by the scheduler
+	Callback<void, Ptr<VirtualMachine> > m_releaseCallback; //!< Called when resources are released
 
 
 
@@ -0,0 +1,210 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *
+ * vm-control-header.cc
+ *
+ *  Created on: Mar 20, 2017
+ *      Author: ubaid
+ *       Email: u.ur.rahman@gmail.com
+ */
+
+#include "vm-control-header.h"
+
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("VmControlHeader");
+
+NS_OBJECT_ENSURE_REGISTERED(VmControlHeader);
+
+VmControlHeader::VmControlHeader()
+	: m_type(0),
+	  m_dataAmount(0),
+	  m_rate(0)
+{
+}
+
+VmControlHeader::VmControlHeader(Type_e type, uint64_t dataAmount, const DataRate & rate)
+	: m_type(type),
+	  m_dataAmount(dataAmount),
+	  m_rate(rate.GetBitRate())
+{
+}
+
+VmControlHeader::~VmControlHeader()
+{
+}
+
+TypeId
+VmControlHeader::GetTypeId (void)
+{
+	static TypeId tid = TypeId ("ns3::VmControlHeader")
+		.SetParent<Header> ()
+		.AddConstructor<VmControlHeader> ();
+	return tid;
+}
+
+TypeId
+VmControlHeader::GetInstanceTypeId (void) const
+{
+	return GetTypeId ();
+}
+
+void
+VmControlHeader::Print (std::ostream & os) const
+{
+	switch(m_type)
+	{
+	case REQUEST:
+		os << "REQUEST";
+		break;
+	case RETRANSMIT:
+		os << "RETRANSMIT";
+		break;
+	case DONE:
+		os << "DONE";
+		break;
+	default:
+		os << "UNKNOWN(" << (uint32_t)m_type << ")";
+	}
+	os << " data " << m_dataAmount << " bytes rate " << m_rate << "bps";
+}
+
+uint32_t
+VmControlHeader::GetSerializedSize () const
+{
+	return 17;
+}
+
+void
+VmControlHeader::Serialize (Buffer::Iterator start) const
+{
+	Buffer::Iterator i = start;
+	i.WriteU8 (m_type);
+	i.WriteHtonU64 (m_dataAmount);
+	i.WriteHtonU64 (m_rate);
+}
+
+uint32_t
+VmControlHeader::Deserialize (Buffer::Iterator start)
+{
+	Buffer::Iterator i = start;
+	m_type = i.ReadU8 ();
+	m_dataAmount = i.ReadNtohU64 ();
+	m_rate = i.ReadNtohU64 ();
+	if (m_type < REQUEST || m_type > DONE)
+	{
+		// the type came off the network, let the caller discard the message
+		NS_LOG_WARN ("VmControlHeader received a message of unknown type " << (uint32_t) m_type);
+		m_type = 0;
+		return 0;
+	}
+	return GetSerializedSize ();
+}
+
+void
+VmControlHeader::SetType(Type_e type)
+{
+	m_type = type;
+}
+
+void
+VmControlHeader::SetDataAmount(uint64_t dataAmount)
+{
+	m_dataAmount = dataAmount;
+}
+
+void
+VmControlHeader::SetRate(const DataRate & rate)
+{
+	m_rate = rate.GetBitRate();
+}
+
+VmControlHeader::Type_e
+VmControlHeader::GetType() const
+{
+	return static_cast<Type_e>(m_type);
+}
+
+uint64_t
+VmControlHeader::GetDataAmount() const
+{
+	return m_dataAmount;
+}
+
+DataRate
+VmControlHeader::GetRate() const
+{
+	return DataRate(m_rate);
+}
+
+std::ostream & operator << (std::ostream & os, const VmControlHeader & h)
+{
+	h.Print (os);
+	return os;
+}
+
+void
+VmControlStream::Receive(Ptr<Socket> socket, Ptr<Packet> packet)
+{
+	std::map<Ptr<Socket>, Ptr<Packet> >::iterator it = m_buffers.find(socket);
+	if(it == m_buffers.end())
+	{
+		m_buffers[socket] = packet->Copy();
+	}
+	else
+	{
+		it->second->AddAtEnd(packet);
+	}
+}
+
+bool
+VmControlStream::Next(Ptr<Socket> socket, VmControlHeader & control)
+{
+	std::map<Ptr<Socket>, Ptr<Packet> >::iterator it = m_buffers.find(socket);
+	if(it == m_buffers.end() || it->second->GetSize() < control.GetSerializedSize())
+	{
+		// nothing or a partial message, wait for the rest
+		return false;
+	}
+	if(it->second->RemoveHeader(control) == 0)
+	{
+		NS_LOG_WARN("Malformed control message, discarding " << it->second->GetSize() << " bytes");
+		m_buffers.erase(it);
+		return false;
+	}
+	if(it->second->GetSize() == 0)
+	{
+		m_buffers.erase(it);
+	}
+	return true;
+}
+
+void
+VmControlStream::Remove(Ptr<Socket> socket)
+{
+	m_buffers.erase(socket);
+}
+
+void
+VmControlStream::Clear()
+{
+	m_buffers.clear();
+}
+
+} /* namespace ns3 */
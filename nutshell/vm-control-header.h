@@ -0,0 +1,170 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *
+ * vm-control-header.h
+ *
+ *  Created on: Mar 20, 2017
+ *      Author: ubaid
+ *       Email: u.ur.rahman@gmail.com
+ */
+
+#ifndef NUTSHELL_VM_CONTROL_HEADER_H
+#define NUTSHELL_VM_CONTROL_HEADER_H
+
+#include <stdint.h>
+#include <map>
+
+#include "ns3/header.h"
+#include "ns3/data-rate.h"
+#include "ns3/ptr.h"
+#include "ns3/packet.h"
+#include "ns3/socket.h"
+
+namespace ns3 {
+
+/**
+ * \brief The control message exchanged between VMs and storage servers
+ *
+ * A request asks a storage server for data at the rate of requesting VM,
+ * a retransmit asks a producer VM for data and done tells a producer the
+ * consumer has received all of its data. The fields have a fixed size, so
+ * a message is 17 bytes whatever it carries.
+ */
+class VmControlHeader: public Header
+{
+public:
+	enum Type_e {
+		REQUEST = 1, //!< Data request to a storage server
+		RETRANSMIT = 2, //!< Data request to a producer VM
+		DONE = 3 //!< All data received
+	};
+
+	VmControlHeader();
+	/**
+	* \brief Creates a message
+	* \param type The type of message
+	* \param dataAmount The amount of data requested in bytes
+	* \param rate The rate of requesting VM
+	*/
+	VmControlHeader(Type_e type, uint64_t dataAmount, const DataRate & rate);
+	virtual ~VmControlHeader();
+
+	/**
+	* \brief Get the type ID.
+	* \return the object TypeId
+	*/
+	static TypeId GetTypeId (void);
+
+	/**
+	* \brief Return the instance type identifier.
+	* \return instance type ID
+	*/
+	virtual TypeId GetInstanceTypeId (void) const;
+
+	virtual void Print (std::ostream& os) const;
+
+	/**
+	* \brief Get the serialized size of the packet.
+	* \return size
+	*/
+	virtual uint32_t GetSerializedSize (void) const;
+
+	/**
+	* \brief Serialize the packet.
+	* \param start Buffer iterator
+	*/
+	virtual void Serialize (Buffer::Iterator start) const;
+
+	/**
+	* \brief Deserialize the packet.
+	* \param start Buffer iterator
+	* \return size of the packet
+	*/
+	virtual uint32_t Deserialize (Buffer::Iterator start);
+
+	void SetType(Type_e type);
+	void SetDataAmount(uint64_t dataAmount);
+	void SetRate(const DataRate & rate);
+
+	Type_e GetType() const;
+	/**
+	* \return The amount of data requested in bytes
+	*/
+	uint64_t GetDataAmount() const;
+	/**
+	* \return The rate of requesting VM
+	*/
+	DataRate GetRate() const;
+
+private:
+	uint8_t m_type; //!< The type of message
+	uint64_t m_dataAmount; //!< The amount of data requested in bytes
+	uint64_t m_rate; //!< The rate of requesting VM in bits per second
+};
+
+/**
+ * \brief Stream insertion operator.
+ *
+ * \param os the reference to the output stream
+ * \param h the control header
+ * \returns the reference to the output stream
+ */
+std::ostream & operator << (std::ostream & os, const VmControlHeader & h);
+
+/**
+ * \brief Reassembles the control messages received on stream sockets
+ *
+ * TCP delivers bytes, a message may be split over two reads. The bytes
+ * of an incomplete message are kept per socket and the next read of the
+ * socket is appended to them.
+ */
+class VmControlStream
+{
+public:
+	/**
+	 * \brief Appends the bytes read from a socket
+	 * \param socket The socket
+	 * \param packet The bytes read
+	 */
+	void Receive(Ptr<Socket> socket, Ptr<Packet> packet);
+	/**
+	 * \brief Takes the next complete message received on a socket
+	 *
+	 * A malformed message discards the bytes buffered for the socket.
+	 *
+	 * \param socket The socket
+	 * \param control The header to fill
+	 * \return false if no complete message is buffered
+	 */
+	bool Next(Ptr<Socket> socket, VmControlHeader & control);
+	/**
+	 * \brief Drops the bytes buffered for a socket
+	 * \param socket The socket
+	 */
+	void Remove(Ptr<Socket> socket);
+	/**
+	 * \brief Drops the bytes buffered for all sockets
+	 */
+	void Clear();
+
+private:
+	std::map<Ptr<Socket>, Ptr<Packet> > m_buffers; //!< The bytes of incomplete messages per socket
+};
+
+} /* namespace ns3 */
+
+#endif /* NUTSHELL_VM_CONTROL_HEADER_H */
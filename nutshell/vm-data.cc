@@ -23,6 +23,7 @@
  */
 
 #include "vm-data.h"
+#include "columnar-writer.h"
 
 namespace ns3 {
 
@@ -149,7 +150,7 @@ VmData::ExportData()
 
 			std::vector<ExecutedVm_s> sevm_vec = sevm.splittedVm;
 
-			for (uint32_t j = 0; sevm_vec.size(); j++)
+			for (uint32_t j = 0; j < sevm_vec.size(); j++)
 			{
 				file << "\t+++++++++++++++++++++++++++++++++++++++++++++\n";
 				WriteExecutedVmToFile(file, sevm_vec[j], "\t");
@@ -185,4 +186,102 @@ VmData::ExportData()
 	file.close();
 }
 
+uint32_t
+VmData::AddVmColumns(ColumnarWriter & writer, uint32_t table)
+{
+	uint32_t first = writer.AddColumn(table, "arrival_time", ColumnarWriter::TYPE_F64);
+	writer.AddColumn(table, "processing", ColumnarWriter::TYPE_U64);
+	writer.AddColumn(table, "primary_storage", ColumnarWriter::TYPE_U64);
+	writer.AddColumn(table, "secondary_storage", ColumnarWriter::TYPE_U64);
+	writer.AddColumn(table, "app_size", ColumnarWriter::TYPE_U64);
+	writer.AddColumn(table, "require_data", ColumnarWriter::TYPE_U8);
+	writer.AddColumn(table, "data_source", ColumnarWriter::TYPE_U8);
+	writer.AddColumn(table, "data_amount", ColumnarWriter::TYPE_U64);
+	writer.AddColumn(table, "hdd_rw_rate", ColumnarWriter::TYPE_U64);
+	writer.AddColumn(table, "mem_rw_rate", ColumnarWriter::TYPE_U64);
+	writer.AddColumn(table, "proc_accesses", ColumnarWriter::TYPE_U32);
+	writer.AddColumn(table, "mem_access_time", ColumnarWriter::TYPE_F64);
+	writer.AddColumn(table, "hdd_access_time", ColumnarWriter::TYPE_F64);
+	writer.AddColumn(table, "mem_pdf", ColumnarWriter::TYPE_F64);
+	writer.AddColumn(table, "mtu", ColumnarWriter::TYPE_U32);
+	writer.AddColumn(table, "trans_rate", ColumnarWriter::TYPE_U64);
+	return first;
+}
+
+void
+VmData::PutVm(ColumnarWriter & writer, uint32_t table, uint32_t column, const VmProperties & p)
+{
+	writer.PutDouble(table, column++, p.arrivalTime.GetSeconds());
+	writer.PutUint(table, column++, p.processing.GetProcessingPower());
+	writer.PutUint(table, column++, p.primary.GetStorage());
+	writer.PutUint(table, column++, p.secondary.GetStorage());
+	writer.PutUint(table, column++, p.appSize.GetApplicationSize());
+	writer.PutUint(table, column++, p.requrieData ? 1 : 0);
+	writer.PutUint(table, column++, p.dataSource);
+	writer.PutUint(table, column++, p.dataAmount.GetStorage());
+	writer.PutUint(table, column++, p.hddRwRate.GetStorage());
+	writer.PutUint(table, column++, p.memRwRate.GetStorage());
+	writer.PutUint(table, column++, p.numOfProcAccesses);
+	writer.PutDouble(table, column++, p.memAccessTime.GetSeconds());
+	writer.PutDouble(table, column++, p.hddAccessTime.GetSeconds());
+	writer.PutDouble(table, column++, p.memPDF);
+	writer.PutUint(table, column++, p.mtu);
+	writer.PutUint(table, column++, p.transRate.GetBitRate());
+}
+
+void
+VmData::ExportBinary(ColumnarWriter & writer)
+{
+	m_executedVm = m_schedulerObj->GetExecutedVmList();
+	m_splitExecutedVm = m_schedulerObj->GetSplitExecutedVmList();
+	m_notExecutedVm = m_schedulerObj->GetNotExecutedVmList();
+
+	uint32_t executed = writer.AddTable("executed_vm");
+	writer.AddColumn(executed, "dispatched_time", ColumnarWriter::TYPE_F64);
+	writer.AddColumn(executed, "node_id", ColumnarWriter::TYPE_U32);
+	uint32_t eVm = AddVmColumns(writer, executed);
+	for(uint32_t i = 0; i < m_executedVm.size(); i++)
+	{
+		writer.PutDouble(executed, 0, m_executedVm[i].dispatched_time);
+		writer.PutUint(executed, 1, m_executedVm[i].nid);
+		PutVm(writer, executed, eVm, m_executedVm[i].vm);
+		writer.EndRow(executed);
+	}
+
+	// the splits refer to their VM by its row in split_vm
+	uint32_t split = writer.AddTable("split_vm");
+	writer.AddColumn(split, "split_id", ColumnarWriter::TYPE_U32);
+	writer.AddColumn(split, "dispatched_time", ColumnarWriter::TYPE_F64);
+	uint32_t sVm = AddVmColumns(writer, split);
+	uint32_t parts = writer.AddTable("split_vm_part");
+	writer.AddColumn(parts, "split_id", ColumnarWriter::TYPE_U32);
+	writer.AddColumn(parts, "dispatched_time", ColumnarWriter::TYPE_F64);
+	writer.AddColumn(parts, "node_id", ColumnarWriter::TYPE_U32);
+	uint32_t pVm = AddVmColumns(writer, parts);
+	for(uint32_t i = 0; i < m_splitExecutedVm.size(); i++)
+	{
+		const SplitExecutedVm_s & sevm = m_splitExecutedVm[i];
+		writer.PutUint(split, 0, i);
+		writer.PutDouble(split, 1, sevm.dispatched_time);
+		PutVm(writer, split, sVm, sevm.actualVm);
+		writer.EndRow(split);
+		for(uint32_t j = 0; j < sevm.splittedVm.size(); j++)
+		{
+			writer.PutUint(parts, 0, i);
+			writer.PutDouble(parts, 1, sevm.splittedVm[j].dispatched_time);
+			writer.PutUint(parts, 2, sevm.splittedVm[j].nid);
+			PutVm(writer, parts, pVm, sevm.splittedVm[j].vm);
+			writer.EndRow(parts);
+		}
+	}
+
+	uint32_t notExecuted = writer.AddTable("not_executed_vm");
+	uint32_t nVm = AddVmColumns(writer, notExecuted);
+	for(uint32_t i = 0; i < m_notExecutedVm.size(); i++)
+	{
+		PutVm(writer, notExecuted, nVm, m_notExecutedVm[i]);
+		writer.EndRow(notExecuted);
+	}
+}
+
 } /* namespace ns3 */
@@ -58,6 +58,19 @@ private:
 	 * child class.
 	 */
 	virtual void ExportData();
+	/**
+	 * \brief Exports executed, split and not executed VMs as tables
+	 */
+	virtual void ExportBinary(ColumnarWriter & writer);
+	/**
+	 * \brief Adds the columns of VM properties to a table
+	 * \return The index of first added column
+	 */
+	uint32_t AddVmColumns(ColumnarWriter & writer, uint32_t table);
+	/**
+	 * \brief Puts VM properties in the columns added by AddVmColumns
+	 */
+	void PutVm(ColumnarWriter & writer, uint32_t table, uint32_t column, const VmProperties & p);
 
 
 	std::vector<ExecutedVm_s> m_executedVm;
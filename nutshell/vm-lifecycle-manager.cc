@@ -0,0 +1,115 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * vm-lifecycle-manager.cc
+ *
+ *  Created on: Apr 17, 2017
+ *      Author: ubaid
+ *       Email: u.ur.rahman@gmail.com
+ */
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include "vm-lifecycle-manager.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("VmLifecycleManager");
+
+NS_OBJECT_ENSURE_REGISTERED (VmLifecycleManager);
+
+TypeId
+VmLifecycleManager::GetTypeId ()
+{
+	static TypeId tid = TypeId("ns3::VmLifecycleManager")
+		.SetParent (Object::GetTypeId())
+		.AddConstructor<VmLifecycleManager> ()
+		;
+	return tid;
+}
+
+VmLifecycleManager::VmLifecycleManager()
+	: m_retired (0)
+{
+	NS_LOG_FUNCTION(this);
+}
+
+VmLifecycleManager::~VmLifecycleManager()
+{
+	NS_LOG_FUNCTION(this);
+}
+
+void
+VmLifecycleManager::DoDispose()
+{
+	NS_LOG_FUNCTION(this);
+	for(std::set<Ptr<VirtualMachine> >::iterator it = m_running.begin(); it != m_running.end(); ++it)
+	{
+		(*it)->Dispose();
+	}
+	m_running.clear();
+	Object::DoDispose();
+}
+
+void
+VmLifecycleManager::Attach(Ptr<VirtualMachine> vm, Ptr<ComputationalNode> n)
+{
+	NS_LOG_FUNCTION(this << vm << n->GetId());
+	m_running.insert(vm);
+	vm->SetNode(n);
+	// the same initialization Node::AddApplication schedules
+	Simulator::ScheduleWithContext(n->GetId(), Seconds(0.0), &Application::Initialize, vm);
+}
+
+void
+VmLifecycleManager::Retire(Ptr<VirtualMachine> vm)
+{
+	NS_LOG_FUNCTION(this << vm);
+	if(m_running.find(vm) == m_running.end())
+	{
+		NS_LOG_WARN("VM " << vm << " is not attached or retired already");
+		return;
+	}
+	Simulator::ScheduleNow(&VmLifecycleManager::DisposeVm, this, vm);
+}
+
+uint32_t
+VmLifecycleManager::GetNRunning() const
+{
+	return m_running.size();
+}
+
+uint64_t
+VmLifecycleManager::GetNRetired() const
+{
+	return m_retired;
+}
+
+void
+VmLifecycleManager::DisposeVm(Ptr<VirtualMachine> vm)
+{
+	NS_LOG_FUNCTION(this << vm);
+	if(m_running.erase(vm) == 0)
+	{
+		return;
+	}
+	vm->Dispose();
+	m_retired++;
+	NS_LOG_INFO("Retired VM " << vm << ", running VMs: " << m_running.size());
+}
+
+} /* namespace ns3 */
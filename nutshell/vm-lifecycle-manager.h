@@ -0,0 +1,106 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * vm-lifecycle-manager.h
+ *
+ *  Created on: Apr 17, 2017
+ *      Author: ubaid
+ *       Email: u.ur.rahman@gmail.com
+ */
+
+#ifndef NUTSHELL_VM_LIFECYCLE_MANAGER_H
+#define NUTSHELL_VM_LIFECYCLE_MANAGER_H
+
+#include <stdint.h>
+#include <set>
+
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+
+#include "virtual-machine.h"
+#include "computational-node.h"
+
+namespace ns3 {
+
+/**
+ * \brief Keeps the VMs scheduled on computational nodes while they run
+ *
+ * A VM installed with Node::AddApplication stays in the application list
+ * of node until the end of simulation, with its sockets and callbacks.
+ * The manager attaches a VM to its node without adding it to that list
+ * and holds the only reference to it. Once the VM is retired, i.e. it has
+ * released its resources, it is disposed and freed, so the memory held by
+ * VMs is proportional to the VMs running at a time.
+ */
+class VmLifecycleManager : public Object {
+public:
+	/**
+	* \brief Get the type ID.
+	* \return the object TypeId
+	*/
+	static TypeId GetTypeId (void);
+	VmLifecycleManager();
+	virtual ~VmLifecycleManager();
+
+	/**
+	 * \brief Attaches the VM to a node and initializes it in the context of node
+	 *
+	 * The VM starts at its start time, as if it was added to the node.
+	 *
+	 * \param vm The VM to attach
+	 * \param n The node running the VM
+	 */
+	void Attach(Ptr<VirtualMachine> vm, Ptr<ComputationalNode> n);
+
+	/**
+	 * \brief Retires a stopped VM
+	 *
+	 * The VM may still be on the call stack, e.g. releasing its resources
+	 * in StopApplication, it is disposed by an event scheduled now.
+	 *
+	 * \param vm The VM to retire
+	 */
+	void Retire(Ptr<VirtualMachine> vm);
+
+	/**
+	 * \brief Get the number of VMs attached and not retired yet
+	 * \return The number of running VMs
+	 */
+	uint32_t GetNRunning() const;
+
+	/**
+	 * \brief Get the number of VMs disposed so far
+	 * \return The number of retired VMs
+	 */
+	uint64_t GetNRetired() const;
+
+protected:
+	virtual void DoDispose(void);
+
+private:
+	/**
+	 * \brief Disposes a retired VM and drops its reference
+	 * \param vm The VM to dispose
+	 */
+	void DisposeVm(Ptr<VirtualMachine> vm);
+
+	std::set<Ptr<VirtualMachine> > m_running; //!< The attached VMs not retired yet
+	uint64_t m_retired; //!< The number of disposed VMs
+};
+
+} /* namespace ns3 */
+
+#endif /* NUTSHELL_VM_LIFECYCLE_MANAGER_H */
@@ -22,15 +22,14 @@
  */
 
 #include <vector>
+#include <algorithm>
 #include <stdlib.h>
 #include <ctime>
+#include <cmath>
 
 #include "ns3/log.h"
 #include "ns3/simulator.h"
 #include "ns3/random-variable-stream.h"
-#include "ns3/uinteger.h"
-#include "ns3/boolean.h"
-#include "ns3/double.h"
 
 #include "processing-power-util.h"
 #include "storage-util.h"
@@ -47,7 +46,6 @@
 #include "consumer-producer-vm.h"
 #include "consumer-vm.h"
 #include "storage-server.h"
-#include "vm-container.h"
 
 #include "vm-scheduler.h"
 
@@ -76,12 +74,44 @@ TypeId VmScheduler::GetTypeId ()
 }
 
 VmScheduler::VmScheduler()
+	: m_vmListIndex (0),
+	  m_vmGenerated (0),
+	  m_serverDataSrcLeft (0),
+	  m_hasNextVm (false),
+	  m_partition (0),
+	  m_partitions (1),
+	  m_arrivalCount (0)
 {
+	m_vmManager = CreateObject<VmLifecycleManager>();
+	CreateRandomStreams();
 }
 
 VmScheduler::VmScheduler(DatacenterConfig config)
+	: m_vmListIndex (0),
+	  m_vmGenerated (0),
+	  m_serverDataSrcLeft (0),
+	  m_hasNextVm (false),
+	  m_partition (0),
+	  m_partitions (1),
+	  m_arrivalCount (0)
 {
 	m_config = config;
+	m_vmManager = CreateObject<VmLifecycleManager>();
+	CreateRandomStreams();
+}
+
+void
+VmScheduler::CreateRandomStreams()
+{
+	/*
+	 * VM properties are drawn from a stream of fixed number, separate from
+	 * the one used while dispatching, hence every logical process generates
+	 * the same VMs whichever VMs it dispatched.
+	 */
+	m_generationRv = CreateObject<UniformRandomVariable>();
+	m_generationRv->SetStream(VmScheduler::GENERATION_STREAM);
+	m_dispatchRv = CreateObject<UniformRandomVariable>();
+	m_dispatchRv->SetStream(VmScheduler::DISPATCH_STREAM);
 }
 
 void
@@ -101,43 +131,63 @@ VmScheduler::SetInterfaces(Ipv4InterfaceContainer iface)
 	m_dcNodesInterfaces = iface;
 }
 
+void
+VmScheduler::SetPartition(uint32_t index, uint32_t count)
+{
+	NS_ASSERT_MSG(index < count, "Partition " << index << " of " << count);
+	m_partition = index;
+	m_partitions = count;
+}
+
 void
 VmScheduler::BeginScheduling()
 {
 	NS_LOG_INFO(this);
-	if(m_vmList.size() == 0)
+	if(m_vmList.size() > 0)
 	{
-		CreateVmList();
 		SortVmList();
 	}
-	if(m_config.GetNumOfVmWithServerDataSrc() > 0 &&
+	if(m_ratio.size() == 0 &&
+			m_config.IsVmSplitAllowed())
+	{
+		ConvertRatio();
+	}
+	if(!m_config.GetVmWorkloadTrace().empty())
+	{
+		m_workload = CreateObject<VmWorkloadReader>();
+		m_workload->Open(m_config.GetVmWorkloadTrace());
+	}
+	if(m_config.GetTransferMode() == DatacenterConfig::TRANSFER_FLOW)
+	{
+		m_flowNetwork = CreateObject<FlowNetwork>();
+	}
+	if((m_config.GetNumOfVmWithServerDataSrc() > 0 || m_workload != 0) &&
 			m_config.GetNumOfStorageServer() > 0)
 	{
 		CreateStorageServers();
 	}
 
-	if(m_config.IsVmRequiredData())
-	{
-		if(DatacenterConfig::RANDOM == m_config.GetVmDistributionType())
-		{
-			for(uint32_t i = 0; i < m_config.GetNumOfVmWithServerDataSrc(); i++)
-			{
-				uint32_t ri = GetNumValue(0, m_config.GetNumOfVmToCreate());
-
-				if(m_vmList[ri].dataSource == STORAGE_SERVER)
-				{
-					ri = GetNumValue(0, m_config.GetNumOfVmToCreate());
-				}
-				m_vmList[ri].dataSource = STORAGE_SERVER;
-			}
-		}
-	}
-	while(m_vmList.size() > 0)
+	BuildCapacityIndex();
+
+	m_arrivalRv = CreateObject<UniformRandomVariable>();
+	m_arrivalRv->SetStream(VmScheduler::ARRIVAL_STREAM);
+	CreateRandomStreams();
+	m_vmListIndex = 0;
+	m_vmGenerated = 0;
+	// generated arrivals are drawn between whole seconds, as before
+	m_lastArrival = (m_workload != 0) ? Seconds(0) : Seconds((uint64_t) m_config.GetVmArrivalTimeMin().GetSeconds());
+	m_schedulingStart = Simulator::Now();
+	m_serverDataSrcLeft = 0;
+	m_arrivalCount = 0;
+	if(m_workload == 0 &&
+			m_config.IsVmRequiredData() &&
+			DatacenterConfig::RANDOM == m_config.GetVmDistributionType())
 	{
-		VmProperties vm = *m_vmList.begin();
-		m_vmList.erase(m_vmList.begin());
-		ScheduleVm(vm);
+		m_serverDataSrcLeft = m_config.GetNumOfVmWithServerDataSrc();
 	}
+
+	m_hasNextVm = GetNextVm(m_nextVm);
+	ScheduleNextArrival();
 }
 
 void
@@ -146,44 +196,170 @@ VmScheduler::CreateVmList()
 	for(uint32_t i = 0; i < m_config.GetNumOfVmToCreate(); i++)
 	{
 		VmProperties vm;
+		CreateVm(vm);
+		vm.arrivalTime = GetTimeValue(m_config.GetVmArrivalTimeMin(), m_config.GetVmArrivalTimeMax());
+		m_vmList.push_back(vm);
+	}
+}
 
-		/* ---------------------- General -----------------------*/
+void
+VmScheduler::CreateVm(VmProperties & vm)
+{
+	/* ---------------------- General -----------------------*/
+
+	vm.processing = GetProcessingValue(m_config.GetVmMinProcessing(), m_config.GetVmMaxProcessing());
+	vm.primary = GetStorageValue(m_config.GetVmMinPrimaryStorage(), m_config.GetVmMaxPrimaryStorage());
+	vm.secondary = GetStorageValue(m_config.GetVmMinSecondaryStorage(), m_config.GetVmMaxPrimaryStorage());
+	vm.appSize = GetApplicationSize(m_config.GetVmMinAppSize(), m_config.GetVmMaxAppSize());
+
+	/*----------------------- Data --------------------------*/
+	vm.requrieData = m_config.IsVmRequiredData();
+	if(vm.requrieData)
+	{
+		vm.dataAmount = GetStorageValue(m_config.GetVmDataAmountMin(), m_config.GetVmDataAmountMax());
+		vm.hddRwRate = GetStorageValue(m_config.GetVmHddRwRateMin(), m_config.GetVmHddRwRateMax());
+		vm.memRwRate = GetStorageValue(m_config.GetVmMemRwRateMin(), m_config.GetVmMemRwRateMax());
+		vm.numOfProcAccesses = GetNumValue(m_config.GetVmNumOfProcAccessMin(), m_config.GetVmNumOfProcAccessMax());
+		vm.memPDF = GetDoubleValue(m_config.GetVmMemPdfMin(), m_config.GetVmMemPdfMax());
+		vm.hddAccessTime = GetTimeValue(m_config.GetVmHddMinAccessTime(), m_config.GetVmHddMaxAccessTime());
+		vm.memAccessTime = GetTimeValue(m_config.GetVmMemMinAccessTime(), m_config.GetVmMemMaxAccessTime());
+		vm.dataSource = LOCAL_DISK;
+	}
 
-		vm.processing = GetProcessingValue(m_config.GetVmMinProcessing(), m_config.GetVmMaxProcessing());
-		vm.primary = GetStorageValue(m_config.GetVmMinPrimaryStorage(), m_config.GetVmMaxPrimaryStorage());
-		vm.secondary = GetStorageValue(m_config.GetVmMinSecondaryStorage(), m_config.GetVmMaxPrimaryStorage());
-		vm.appSize = GetApplicationSize(m_config.GetVmMinAppSize(), m_config.GetVmMaxAppSize());
+	/*---------------------- Network -----------------------*/
+	vm.transRate = GetDataRateValue(m_config.GetVmTransmissionRateMin(), m_config.GetVmTransmissionRateMax());
+	vm.cProtocolTid = m_config.GetVmProtocolType();
+	vm.mtu = m_config.GetVmMtu();
+}
 
-		/*----------------------- Data --------------------------*/
-		vm.requrieData = m_config.IsVmRequiredData();
-		if(vm.requrieData)
+bool
+VmScheduler::GetNextVm(VmProperties & vm)
+{
+	if(m_workload != 0)
+	{
+		// VMs are replayed from the trace, as they are
+		if(!m_workload->ReadNext(vm))
 		{
-			vm.dataAmount = GetStorageValue(m_config.GetVmDataAmountMin(), m_config.GetVmDataAmountMax());
-			vm.hddRwRate = GetStorageValue(m_config.GetVmHddRwRateMin(), m_config.GetVmHddRwRateMax());
-			vm.memRwRate = GetStorageValue(m_config.GetVmMemRwRateMin(), m_config.GetVmMemRwRateMax());
-			vm.numOfProcAccesses = GetNumValue(m_config.GetVmNumOfProcAccessMin(), m_config.GetVmNumOfProcAccessMax());
-			vm.memPDF = GetDoubleValue(m_config.GetVmMemPdfMin(), m_config.GetVmMemPdfMax());
-			vm.hddAccessTime = GetTimeValue(m_config.GetVmHddMinAccessTime(), m_config.GetVmHddMaxAccessTime());
-			vm.memAccessTime = GetTimeValue(m_config.GetVmMemMinAccessTime(), m_config.GetVmMemMaxAccessTime());
-			vm.dataSource = LOCAL_DISK;
+			return false;
 		}
-		/* ---------------------- Arrival -----------------------*/
-		vm.arrivalTime = GetTimeValue(m_config.GetVmArrivalTimeMin(), m_config.GetVmArrivalTimeMax());
-
-		/*---------------------- Network -----------------------*/
-		vm.transRate = GetDataRateValue(m_config.GetVmTransmissionRateMin(), m_config.GetVmTransmissionRateMax());
-		vm.cProtocolTid = m_config.GetVmProtocolType();
+		if(vm.arrivalTime < m_lastArrival)
+		{
+			NS_FATAL_ERROR("Workload trace " << m_config.GetVmWorkloadTrace() << " is not sorted by arrival, row "
+					<< m_workload->GetRowsRead());
+		}
+		m_lastArrival = vm.arrivalTime;
 		vm.mtu = m_config.GetVmMtu();
-
-		if(m_ratio.size() == 0 &&
-				m_config.IsVmSplitAllowed())
+		vm.cProtocolTid = m_config.GetVmProtocolType();
+		if(vm.dataSource == STORAGE_SERVER && m_storageServers.GetN() == 0)
+		{
+			NS_LOG_WARN("No storage server to fetch data from, VM uses local disk");
+			vm.dataSource = LOCAL_DISK;
+		}
+		return true;
+	}
+	if(m_vmList.size() > 0)
+	{
+		// a list was created before scheduling, dispatch it in order
+		if(m_vmListIndex >= m_vmList.size())
 		{
-			ConvertRatio();
+			return false;
 		}
+		vm = m_vmList[m_vmListIndex];
+		m_vmListIndex++;
+	}
+	else
+	{
+		if(m_vmGenerated >= m_config.GetNumOfVmToCreate())
+		{
+			return false;
+		}
+		CreateVm(vm);
+		vm.arrivalTime = GetNextArrivalTime();
+		m_vmGenerated++;
+	}
+	SelectDataSource(vm);
+	return true;
+}
 
-		m_vmList.push_back(vm);
+Time
+VmScheduler::GetNextArrivalTime()
+{
+	Time min = m_config.GetVmArrivalTimeMin();
+	Time max = m_config.GetVmArrivalTimeMax();
+	if(min == max)
+	{
+		return min;
 	}
+	/*
+	 * The minimum of k uniform samples in [a, b] is
+	 * a + (b - a) * (1 - U^(1/k)), drawing the minimum of the
+	 * remaining samples each time gives the sorted sequence.
+	 */
+	uint32_t remaining = m_config.GetNumOfVmToCreate() - m_vmGenerated;
+	double u = m_arrivalRv->GetValue(0.0, 1.0);
+	double last = m_lastArrival.GetSeconds();
+	double maxs = (uint64_t) max.GetSeconds();
+	double next = last + (maxs - last) * (1.0 - std::pow(u, 1.0 / remaining));
+	m_lastArrival = Seconds(next);
+	return m_lastArrival;
+}
 
+void
+VmScheduler::SelectDataSource(VmProperties & vm)
+{
+	if(m_serverDataSrcLeft == 0)
+	{
+		return;
+	}
+	uint32_t total = m_vmList.size() > 0 ? m_vmList.size() : m_config.GetNumOfVmToCreate();
+	uint32_t seen = m_vmList.size() > 0 ? m_vmListIndex - 1 : m_vmGenerated - 1;
+	double p = (double) m_serverDataSrcLeft / (double) (total - seen);
+	if(m_arrivalRv->GetValue(0.0, 1.0) < p)
+	{
+		vm.dataSource = STORAGE_SERVER;
+		m_serverDataSrcLeft--;
+	}
+}
+
+void
+VmScheduler::ScheduleNextArrival()
+{
+	m_arrivals.clear();
+	if(!m_hasNextVm)
+	{
+		return;
+	}
+	Time t = m_nextVm.arrivalTime;
+	VmComparator comparator(this);
+	while(m_hasNextVm && m_nextVm.arrivalTime == t)
+	{
+		// VMs arriving together are dispatched in the order of scheduler, each
+		// is inserted after its equals so the batch stays stable in place
+		m_arrivals.insert(std::upper_bound(m_arrivals.begin(), m_arrivals.end(), m_nextVm, comparator),
+				m_nextVm);
+		m_hasNextVm = GetNextVm(m_nextVm);
+	}
+
+	Time delay = m_schedulingStart + t - Simulator::Now();
+	if(delay.IsNegative())
+	{
+		delay = Seconds(0);
+	}
+	Simulator::Schedule(delay, &VmScheduler::DispatchArrivals, this);
+}
+
+void
+VmScheduler::DispatchArrivals()
+{
+	for(uint32_t i = 0; i < m_arrivals.size(); i++)
+	{
+		// the VMs of other partitions are dispatched by their logical process
+		if(m_arrivalCount++ % m_partitions == m_partition)
+		{
+			ScheduleVm(m_arrivals[i]);
+		}
+	}
+	ScheduleNextArrival();
 }
 
 void
@@ -205,88 +381,158 @@ VmScheduler::CreateStorageServers()
 		uint16_t mtu = (uint16_t ) m_config.GetVmMtu();
 		s->SetMtu(mtu);
 		s->SetProtocol(m_config.GetVmProtocolType());
+		s->SetFlowNetwork(m_flowNetwork);
 		n->AddApplication(s);
 
 		s->SetStartTime(Simulator::Now());
 	}
 }
 
+void
+VmScheduler::BuildCapacityIndex()
+{
+	NS_LOG_INFO(this);
+	if(m_capacityIndex != 0)
+	{
+		m_capacityIndex->Dispose();
+	}
+	m_capacityIndex = CreateObject<NodeCapacityIndex>();
+	m_capacityIndex->Build(m_dataCenterNodes, m_dataCenterNodes.GetN() - m_config.GetNumOfStorageServer());
+}
+
 void
 VmScheduler::SortVmList()
 {
 	NS_LOG_INFO(this);
+	// VMs have no key of their own, equal VMs keep the order of list only
+	// with a stable sort, its buffer is allocated once per list
+	std::stable_sort(m_vmList.begin(), m_vmList.end(), VmComparator(this));
+}
+
+bool
+VmScheduler::CompareVm(const VmProperties & a, const VmProperties & b) const
+{
+	return a.arrivalTime < b.arrivalTime;
+}
 
-	for(uint32_t i = 0; i < m_vmList.size(); i++)
+VmScheduler::VmComparator::VmComparator(const VmScheduler * scheduler)
+	: m_scheduler(scheduler)
+{
+}
+
+bool
+VmScheduler::VmComparator::operator() (const VmProperties & a, const VmProperties & b) const
+{
+	return m_scheduler->CompareVm(a, b);
+}
+
+Ptr<VirtualMachine>
+VmScheduler::CreateVm(const VmProperties & v, VirtualMachineHelper::VmType_e type)
+{
+	if(type == VirtualMachineHelper::COMPUTATIONAL_LOCAL_DATA)
 	{
-		VmProperties tmp;
-		for(uint32_t j = i + 1; j < m_vmList.size(); j++)
+		Ptr<ComputationalLocalDataVm> vm = CreateObject<ComputationalLocalDataVm>();
+		/*----------------------General ----------------------*/
+		vm->SetProcessingPower(v.processing);
+		vm->SetPrimaryStorage(v.primary);
+		vm->SetSecondaryStorage(v.secondary);
+		vm->SetApplicationSize(v.appSize);
+
+		/*-------------------- Data -----------------------*/
+		vm->SetRequiredData(v.requrieData);
+		if(v.requrieData)
 		{
-			if(m_vmList[j].arrivalTime < m_vmList[i].arrivalTime)
-			{
-				tmp = m_vmList[i];
-				m_vmList[i] = m_vmList[j];
-				m_vmList[j] = tmp;
-			}
+			vm->SetHddRwRate(v.hddRwRate);
+			vm->SetMemRwRate(v.memRwRate);
+			vm->SetNumOfAccesses(v.numOfProcAccesses);
+			vm->SetRamPDF(v.memPDF);
+			vm->SetMemAccTime(v.memAccessTime);
+			vm->SetHddAccTime(v.hddAccessTime);
+			vm->SetDataAmount(v.dataAmount);
 		}
+		return vm;
 	}
-}
 
-VirtualMachineHelper
-VmScheduler::InitializeVm(VmProperties v, VirtualMachineHelper::VmType_e type)
-{
-	VirtualMachineHelper vmh(type);
+	Ptr<NetworkVm> vm;
+	if(type == VirtualMachineHelper::PRODUCER)
+	{
+		vm = CreateObject<ProducerVm>();
+	}
+	else if(type == VirtualMachineHelper::CONSUMER_PRODUCER)
+	{
+		vm = CreateObject<ConsumerProducerVm>();
+	}
+	else
+	{
+		vm = CreateObject<ConsumerVm>();
+	}
 	/*----------------------General ----------------------*/
-	vmh.SetAttribute("ProcessingPower", ProcessingPowerValue(v.processing));
-	vmh.SetAttribute("PrimaryStorage", StorageValue(v.primary));
-	vmh.SetAttribute("SecondaryStorage", StorageValue(v.secondary));
-	vmh.SetAttribute("ApplicationSize", ApplicationSizeValue(v.appSize));
+	vm->SetProcessingPower(v.processing);
+	vm->SetPrimaryStorage(v.primary);
+	vm->SetSecondaryStorage(v.secondary);
+	vm->SetApplicationSize(v.appSize);
 
 	/*-------------------- Data -----------------------*/
 	if(v.requrieData)
 	{
-
-		vmh.SetAttribute("HddRwRate", StorageValue(v.hddRwRate));
-		vmh.SetAttribute("MemRwRate", StorageValue(v.memRwRate));
-		vmh.SetAttribute("NumOfAccesses", UintegerValue(v.numOfProcAccesses));
-		vmh.SetAttribute("RamPercentageForData", DoubleValue(v.memPDF));
-		vmh.SetAttribute("MemoryAccessTime", TimeValue(v.memAccessTime));
-		vmh.SetAttribute("HddAccessTime", TimeValue(v.hddAccessTime));
-
-		if(type == VirtualMachineHelper::COMPUTATIONAL_LOCAL_DATA)
-		{
-			vmh.SetAttribute("RequireData", BooleanValue(v.requrieData));
-			vmh.SetAttribute("DataAmount", StorageValue(v.dataAmount));
-		}
-		else if(type == VirtualMachineHelper::CONSUMER_PRODUCER ||
+		vm->SetHddRwRate(v.hddRwRate);
+		vm->SetMemRwRate(v.memRwRate);
+		vm->SetNumOfAccesses(v.numOfProcAccesses);
+		vm->SetRamPDF(v.memPDF);
+		vm->SetMemAccTime(v.memAccessTime);
+		vm->SetHddAccTime(v.hddAccessTime);
+
+		if(type == VirtualMachineHelper::CONSUMER_PRODUCER ||
 				type == VirtualMachineHelper::CONSUMER)
 		{
-			vmh.SetAttribute("UseLocalDataProcessing", BooleanValue(v.requrieData));
-			vmh.SetAttribute("DataSize", StorageValue(v.dataAmount));
+			vm->SetUseLocalDataProcessing(v.requrieData);
+			vm->SetDataSize(v.dataAmount);
 		}
 	}
-	else
+
+	/* ------------------ Network --------------*/
+	vm->SetSocketType(GetSocketTypeId(v.cProtocolTid));
+	vm->SetMtu(v.mtu);
+	vm->SetVmTransmissionRate(v.transRate);
+	if(m_flowNetwork != 0)
 	{
-		vmh.SetAttribute("RequireData", BooleanValue(v.requrieData));
+		vm->SetFlowNetwork(m_flowNetwork);
 	}
+	return vm;
+}
 
-	/* ------------------ Network --------------*/
-	if(type == VirtualMachineHelper::PRODUCER ||
-			type == VirtualMachineHelper::CONSUMER_PRODUCER ||
-				type == VirtualMachineHelper::CONSUMER)
+TypeId
+VmScheduler::GetSocketTypeId(const std::string & name)
+{
+	// the VMs of a run share a protocol, it is looked up once
+	if(name != m_socketTidName)
 	{
-		vmh.SetAttribute("SocketType", TypeIdValue(TypeId::LookupByName(v.cProtocolTid)));
-		vmh.SetAttribute("Mtu", UintegerValue(v.mtu));
-		vmh.SetAttribute("VmTransmissionRate", DataRateValue(v.transRate));
+		m_socketTid = TypeId::LookupByName(name);
+		m_socketTidName = name;
 	}
+	return m_socketTid;
+}
 
-	return vmh;
+void
+VmScheduler::InstallVm(Ptr<VirtualMachine> vm, Ptr<ComputationalNode> n)
+{
+	vm->SetCompNode(n);
+	vm->AdoptReservation();
+	vm->SetReleaseCallback(MakeCallback(&VmScheduler::VmReleased, this));
+	vm->SetStartTime(Simulator::Now());
+	m_vmManager->Attach(vm, n);
 }
 
 
 void
 VmScheduler::ScheduleVm(VmProperties & vm)
 {
-	Simulator::Schedule(vm.arrivalTime,
+	Time delay = m_schedulingStart + vm.arrivalTime - Simulator::Now();
+	if(delay.IsNegative())
+	{
+		delay = Seconds(0);
+	}
+	Simulator::Schedule(delay,
 			&VmScheduler::DispatchVmOnNode, this, vm);
 }
 
@@ -295,11 +541,6 @@ VmScheduler::DispatchVmOnNode(VmProperties & vm)
 {
 	NS_LOG_INFO("Dispatching... ");
 
-	if(m_portAssigned.size() == 0)
-	{
-		m_portAssigned.push_back(3000);
-	}
-
 	if(vm.requrieData)
 	{
 		if(vm.dataAmount > vm.secondary)
@@ -309,69 +550,53 @@ VmScheduler::DispatchVmOnNode(VmProperties & vm)
 		}
 	}
 
-	Ptr<UniformRandomVariable> uv = CreateObject<UniformRandomVariable>();
-	uint32_t listeningPort = 0;
-	bool portAssigned = true;
-	while(portAssigned)
-	{
-		listeningPort = uv->GetValue(2048, 65535);
-		NS_LOG_INFO("Looking up" << listeningPort);
-		portAssigned = IsPortAssigned(listeningPort);
-	}
-
 	Ptr<ComputationalNode> n;
 	ComputationalNodeContainer n4vmSplit;
 	bool foundFirstFit = false;
 
-	for(ComputationalNodeContainer::Iterator i = m_dataCenterNodes.Begin();
-			i != (m_dataCenterNodes.End() - m_config.GetNumOfStorageServer()); i++)
+	/*
+	 * The capacity index returns nodes in the same order
+	 * as walking the list, skipping ranges that can not fit.
+	 * The resources are reserved on the node before the VM
+	 * is created, so a single VM is installed on the node it
+	 * runs on.
+	 */
+	int32_t ni = m_capacityIndex->FindFirstFit(vm.processing, vm.primary, vm.secondary, vm.transRate);
+	while(ni >= 0 &&
+			!m_dataCenterNodes.Get(ni)->ReserveResources(vm.processing, vm.primary, vm.secondary))
+	{
+		ni = m_capacityIndex->FindFirstFit(vm.processing, vm.primary, vm.secondary, vm.transRate, ni + 1);
+	}
+
+	if(ni >= 0)
 	{
-		n = *i;
+		n = m_dataCenterNodes.Get(ni);
 
-		if(n->CheckAvailability(vm.processing, vm.primary, vm.secondary, vm.transRate))
+		Ptr<VirtualMachine> dispVm;
+		if(vm.requrieData && vm.dataSource == STORAGE_SERVER)
 		{
-			VirtualMachineHelper dispVm(VirtualMachineHelper::COMPUTATIONAL_LOCAL_DATA);
-			if(vm.requrieData)
+			uint32_t addIndex = 0;
+			if(DatacenterConfig::RANDOM == m_config.GetVmDistributionType())
 			{
-				if(vm.dataSource == STORAGE_SERVER)
-				{
-					uint32_t addIndex = 0;
-					if(DatacenterConfig::RANDOM == m_config.GetVmDistributionType())
-					{
-						Ptr<UniformRandomVariable> uv = CreateObject<UniformRandomVariable>();
-						addIndex = uv->GetValue(0, m_config.GetNumOfStorageServer());
+				addIndex = m_dispatchRv->GetValue(0, m_config.GetNumOfStorageServer());
 
-					}
-					NS_LOG_INFO("The add index: " << addIndex);
-					dispVm = InitializeVm(vm, VirtualMachineHelper::CONSUMER);
-
-					dispVm.SetAttribute("ConsumerType", EnumValue(ConsumerVm::CONSUMER_CLIENT));
-
-					dispVm.SetAttribute("RemoteAddress", AddressValue(Address(m_storageServersIfases.GetAddress(addIndex))));
-					dispVm.SetAttribute("RemotePort", UintegerValue(3000));
-
-					dispVm.SetAttribute("ListeningAddress", AddressValue(Address(Ipv4Address::GetAny())));
-					dispVm.SetAttribute("ListeningPort", UintegerValue(listeningPort));
-				}
-				else
-				{
-					dispVm = InitializeVm(vm, VirtualMachineHelper::COMPUTATIONAL_LOCAL_DATA);
-				}
 			}
-			else
-			{
-				dispVm = InitializeVm(vm, VirtualMachineHelper::COMPUTATIONAL_LOCAL_DATA);
-			}
-			VmContainer vmInstalled = dispVm.Install(n);
-			vmInstalled.Start(Simulator::Now());
+			NS_LOG_INFO("The add index: " << addIndex);
+			Ptr<ConsumerVm> consumer = DynamicCast<ConsumerVm>(CreateVm(vm, VirtualMachineHelper::CONSUMER));
 
-			if(vmInstalled.Get(0)->IsResourcesReserved())
-			{
-				foundFirstFit = true;
-				AddToExecutedVmList(vm, n->GetId());
-				break;
-			}
+			consumer->SetConsumerType(ConsumerVm::CONSUMER_CLIENT);
+			consumer->SetRemote(m_storageServersIfases.GetAddress(addIndex), 3000);
+			consumer->SetListener(Ipv4Address::GetAny(), AllocatePort(n));
+			dispVm = consumer;
+		}
+		else
+		{
+			dispVm = CreateVm(vm, VirtualMachineHelper::COMPUTATIONAL_LOCAL_DATA);
 		}
+		InstallVm(dispVm, n);
+
+		foundFirstFit = true;
+		AddToExecutedVmList(vm, n->GetId());
 	}
 
 
@@ -470,59 +695,49 @@ VmScheduler::FindNodeIndicies(std::vector<VmProperties> & vmSplitted,
 		ComputationalNodeContainer & selectedNodes, Ipv4InterfaceContainer & selectedNodeIface)
 {
 	uint32_t nodeLimit = m_dataCenterNodes.GetN() - m_config.GetNumOfStorageServer();
-	for(uint32_t i = 0; i < vmSplitted.size(); i++)
+	if(m_selectedNodes.size() != nodeLimit)
 	{
-		VmProperties svp = vmSplitted[i];
-		Ptr<ComputationalNode> n;
+		m_selectedNodes.assign(nodeLimit, false);
+	}
 
-		for(uint32_t j = 0; j < nodeLimit; j++)
+	std::vector<int32_t> placed;
+	for(uint32_t i = 0; i < vmSplitted.size(); i++)
+	{
+		VmProperties & svp = vmSplitted[i];
+
+		/*
+		 * First fit from the capacity index, skipping the nodes
+		 * holding other parts of the VM and the nodes that refuse
+		 * the reservation
+		 */
+		int32_t ni = m_capacityIndex->FindFirstFit(svp.processing, svp.primary, svp.secondary, svp.transRate);
+		while(ni >= 0 && (m_selectedNodes[ni] ||
+				!m_dataCenterNodes.Get(ni)->ReserveResources(svp.processing, svp.primary, svp.secondary)))
 		{
-			n = m_dataCenterNodes.Get(j);
-			bool alreadySelected = false;
-
-			/*
-			 * Check if there is a node selected
-			 * if there is then loop through and find
-			 * if the current node counter is selected
-			 * for other part of VM.
-			 */
-			if(selectedNodes.GetN() > 0 )
-			{
-				for(uint32_t f = 0; f < selectedNodes.GetN(); f++)
-				{
-					if(n == selectedNodes.Get(f))
-					{
-						alreadySelected = true;
-						break;
-					}
-				}
-			}
-			/*
-			 * If the index is already selected
-			 * increment the counter and continue
-			 */
-			if(alreadySelected)
-			{
-				continue;
-			}
-
-			/*
-			 * Check the availability of resources
-			 */
+			ni = m_capacityIndex->FindFirstFit(svp.processing, svp.primary, svp.secondary, svp.transRate, ni + 1);
+		}
+		if(ni < 0)
+		{
+			break;
+		}
+		m_selectedNodes[ni] = true;
+		placed.push_back(ni);
+	}
 
-			if(n->CheckAvailability(svp.processing,	svp.primary, svp.secondary, svp.transRate))
-			{
-				if(selectedNodes.GetN() != vmSplitted.size())
-				{
-					selectedNodes.Add(n);
-					selectedNodeIface.Add(m_dcNodesInterfaces.Get(j));
-					break;
-				}
-				else
-				{
-					break;
-				}
-			}
+	bool gang = placed.size() == vmSplitted.size();
+	for(uint32_t i = 0; i < placed.size(); i++)
+	{
+		Ptr<ComputationalNode> n = m_dataCenterNodes.Get(placed[i]);
+		m_selectedNodes[placed[i]] = false;
+		if(gang)
+		{
+			selectedNodes.Add(n);
+			selectedNodeIface.Add(m_dcNodesInterfaces.Get(placed[i]));
+		}
+		else
+		{
+			// the VM can not be placed as a whole, undo the parts placed
+			n->ReleaseResources(vmSplitted[i].processing, vmSplitted[i].primary, vmSplitted[i].secondary);
 		}
 	}
 }
@@ -536,93 +751,62 @@ VmScheduler::StartVm(std::vector<VmProperties> & splittedVmVec,
 	/*
 	 * Calculate unique ports for VM's listening and transmission
 	 */
-	Ptr<UniformRandomVariable> uv = CreateObject<UniformRandomVariable>();
 	std::vector<uint32_t> ports;
 	for(uint32_t i = 0; i < splittedVmVec.size(); i++)
 	{
-		uint32_t p = 0;
-		bool portAssigned = true;
-		while(portAssigned)
-		{
-			p = uv->GetValue(2048, 65535);
-			portAssigned = IsPortAssigned(p);
-		}
-		m_portAssigned.push_back(p);
-		ports.push_back(p);
+		// only the parts exchanging data listen on a port
+		ports.push_back(splittedVmVec[i].requrieData ? AllocatePort(selectedNodes.Get(i)) : 0);
 	}
 
-	VmContainer splitVmContainer;
-
 	for(uint32_t i = 0; i < splittedVmVec.size(); i++)
 	{
-		VmProperties svmp = splittedVmVec[i];
-		VirtualMachineHelper vmh (VirtualMachineHelper::COMPUTATIONAL_LOCAL_DATA);
+		VmProperties & svmp = splittedVmVec[i];
+		Ptr<VirtualMachine> vm;
 		if(svmp.requrieData)
 		{
 			// requires data
 			NS_LOG_INFO("requires data");
+			bool last = (i == splittedVmVec.size() - 1);
 			if(svmp.dataSource == STORAGE_SERVER)
 			{
 				NS_LOG_INFO("data from storage");
 				uint32_t addIndex = 0;
 				if(DatacenterConfig::RANDOM == m_config.GetVmDistributionType())
 				{
-					addIndex = uv->GetValue(0, m_config.GetNumOfStorageServer());
+					addIndex = m_dispatchRv->GetValue(0, m_config.GetNumOfStorageServer());
 				}
 				// data is required from storage server
-				if(i >= 0 && i < (splittedVmVec.size() - 1))
+				if(!last)
 				{
 					NS_LOG_INFO("VM type ConsumerProducer");
-					vmh = InitializeVm(svmp, VirtualMachineHelper::CONSUMER_PRODUCER);
+					Ptr<ConsumerProducerVm> cp = DynamicCast<ConsumerProducerVm>(CreateVm(svmp, VirtualMachineHelper::CONSUMER_PRODUCER));
 					// index for consumer producer
 					if(i == 0)
 					{
 						NS_LOG_INFO("Consumer to request data from server");
 						// consumer producer to get data from server
-						vmh.SetAttribute("ConsumerType", EnumValue(ConsumerProducerVm::CONSUMER_CLIENT));
-
-						vmh.SetAttribute("RemoteAddress", AddressValue(Address(m_storageServersIfases.GetAddress(addIndex))));
-						vmh.SetAttribute("RemotePort", UintegerValue(3000));
-
-						vmh.SetAttribute("ListeningAddress", AddressValue(Address(Ipv4Address::GetAny())));
-						vmh.SetAttribute("ListeningPort", UintegerValue(ports[i]));
-
-						vmh.SetAttribute("ProducerForRemoteAddress", AddressValue(Address(selectedNodeIface.GetAddress(i+1))));
-						vmh.SetAttribute("ProducerForRemotePort", UintegerValue(ports[i+1]));
-
+						cp->SetConsumerType(ConsumerProducerVm::CONSUMER_CLIENT);
+						cp->SetRemote(m_storageServersIfases.GetAddress(addIndex), 3000);
 					}
 					else
 					{
 						NS_LOG_INFO("Consumer to request data from producer");
 						// consumer producer to wait for data from consumer producer
-						vmh.SetAttribute("ConsumerType", EnumValue(ConsumerProducerVm::CONSUMER_CONSUMER));
-
-						// set producer address and its listener port for producer socket
-						vmh.SetAttribute("RemoteAddress", AddressValue(Address(selectedNodeIface.GetAddress(i-1))));
-						vmh.SetAttribute("RemotePort", UintegerValue(ports[i-1]));
-
-						vmh.SetAttribute("ListeningAddress", AddressValue(Address(Ipv4Address::GetAny())));
-						vmh.SetAttribute("ListeningPort", UintegerValue(ports[i]));
-
-						vmh.SetAttribute("ProducerForRemoteAddress", AddressValue(Address(selectedNodeIface.GetAddress(i+1))));
-						vmh.SetAttribute("ProducerForRemotePort", UintegerValue(ports[i+1]));
-
+						cp->SetConsumerType(ConsumerProducerVm::CONSUMER_CONSUMER);
+						cp->SetRemote(selectedNodeIface.GetAddress(i-1), ports[i-1]);
 					}
+					cp->SetListener(Ipv4Address::GetAny(), ports[i]);
+					cp->SetProducerRemoteDest(selectedNodeIface.GetAddress(i+1), ports[i+1]);
+					vm = cp;
 				}
 				else
 				{
-					// consumer only
-					vmh = InitializeVm(svmp, VirtualMachineHelper::CONSUMER);
-					// consumer producer to wait for data from consumer producer
-					vmh.SetAttribute("ConsumerType", EnumValue(ConsumerVm::CONSUMER_CONSUMER));
-
-					// set producer address and its listener port for producer socket
-					vmh.SetAttribute("RemoteAddress", AddressValue(Address(selectedNodeIface.GetAddress(i-1))));
-					vmh.SetAttribute("RemotePort", UintegerValue(ports[i-1]));
-
-					vmh.SetAttribute("ListeningAddress", AddressValue(Address(Ipv4Address::GetAny())));
-					vmh.SetAttribute("ListeningPort", UintegerValue(ports[i]));
-
+					// consumer only, waits for data from consumer producer
+					Ptr<ConsumerVm> c = DynamicCast<ConsumerVm>(CreateVm(svmp, VirtualMachineHelper::CONSUMER));
+					c->SetConsumerType(ConsumerVm::CONSUMER_CONSUMER);
+					c->SetRemote(selectedNodeIface.GetAddress(i-1), ports[i-1]);
+					c->SetListener(Ipv4Address::GetAny(), ports[i]);
+					vm = c;
 				}
 
 			}
@@ -633,73 +817,43 @@ VmScheduler::StartVm(std::vector<VmProperties> & splittedVmVec,
 				{
 					// producer
 					NS_LOG_INFO("Producer");
-					vmh = InitializeVm(svmp, VirtualMachineHelper::PRODUCER);
-
-					vmh.SetAttribute("RemoteAddress", AddressValue(Address(selectedNodeIface.GetAddress(i+1))));
-					vmh.SetAttribute("RemotePort", UintegerValue(ports[i+1]));
-
-					vmh.SetAttribute("ListeningAddress", AddressValue(Ipv4Address::GetAny()));
-					vmh.SetAttribute("ListeningPort", UintegerValue(ports[i]));
-
+					Ptr<NetworkVm> p = DynamicCast<NetworkVm>(CreateVm(svmp, VirtualMachineHelper::PRODUCER));
+					p->SetRemote(selectedNodeIface.GetAddress(i+1), ports[i+1]);
+					p->SetListener(Ipv4Address::GetAny(), ports[i]);
+					vm = p;
 				}
-				else if(i > 0 && i < (splittedVmVec.size() - 1))
+				else if(!last)
 				{
 					NS_LOG_INFO("COnsumer producer ");
 					//consumer producer
-					vmh = InitializeVm(svmp, VirtualMachineHelper::CONSUMER_PRODUCER);
-
-					vmh.SetAttribute("ConsumerType", EnumValue(ConsumerProducerVm::CONSUMER_CONSUMER));
-
-					// set producer address and its listener port for producer socket
-					vmh.SetAttribute("RemoteAddress", AddressValue(selectedNodeIface.GetAddress(i-1)));
-					vmh.SetAttribute("RemotePort", UintegerValue(ports[i-1]));
-
-					vmh.SetAttribute("ListeningAddress", AddressValue(Ipv4Address::GetAny()));
-					vmh.SetAttribute("ListeningPort", UintegerValue(ports[i]));
-
-					vmh.SetAttribute("ProducerForRemoteAddress", AddressValue(Address(selectedNodeIface.GetAddress(i+1))));
-					vmh.SetAttribute("ProducerForRemotePort", UintegerValue(ports[i+1]));
+					Ptr<ConsumerProducerVm> cp = DynamicCast<ConsumerProducerVm>(CreateVm(svmp, VirtualMachineHelper::CONSUMER_PRODUCER));
+					cp->SetConsumerType(ConsumerProducerVm::CONSUMER_CONSUMER);
+					cp->SetRemote(selectedNodeIface.GetAddress(i-1), ports[i-1]);
+					cp->SetListener(Ipv4Address::GetAny(), ports[i]);
+					cp->SetProducerRemoteDest(selectedNodeIface.GetAddress(i+1), ports[i+1]);
+					vm = cp;
 				}
 				else
 				{
 					// consumer
 					NS_LOG_INFO("Consumer only");
-					vmh = InitializeVm(svmp, VirtualMachineHelper::CONSUMER);
-					// consumer producer to wait for data from consumer producer
-					vmh.SetAttribute("ConsumerType", EnumValue(ConsumerVm::CONSUMER_CONSUMER));
-
-					// set producer address and its listener port for producer socket
-					vmh.SetAttribute("RemoteAddress", AddressValue(Address(selectedNodeIface.GetAddress(i-1))));
-					vmh.SetAttribute("RemotePort", UintegerValue(ports[i-1]));
-
-					vmh.SetAttribute("ListeningAddress", AddressValue(Address(Ipv4Address::GetAny())));
-					vmh.SetAttribute("ListeningPort", UintegerValue(ports[i]));
+					Ptr<ConsumerVm> c = DynamicCast<ConsumerVm>(CreateVm(svmp, VirtualMachineHelper::CONSUMER));
+					c->SetConsumerType(ConsumerVm::CONSUMER_CONSUMER);
+					c->SetRemote(selectedNodeIface.GetAddress(i-1), ports[i-1]);
+					c->SetListener(Ipv4Address::GetAny(), ports[i]);
+					vm = c;
 				}
 			}
-
-			// now assign the vm to node
-
-			Ptr<ComputationalNode> n = selectedNodes.Get(i);
-			VmContainer vmc = vmh.Install(n);
-			if(vmc.Get(0)->IsResourcesReserved())
-			{
-				splitVmContainer.Add(vmc);
-				assigned.push_back(true);
-			}
 		}
 		else
 		{
-			vmh = InitializeVm(svmp, VirtualMachineHelper::COMPUTATIONAL_LOCAL_DATA);
-			Ptr<ComputationalNode> n = selectedNodes.Get(i);
-			VmContainer vmc = vmh.Install(n);
-			if(vmc.Get(0)->IsResourcesReserved())
-			{
-				splitVmContainer.Add(vmc);
-				assigned.push_back(true);
-			}
+			vm = CreateVm(svmp, VirtualMachineHelper::COMPUTATIONAL_LOCAL_DATA);
 		}
+
+		// now assign the vm to node, it takes over the reservation of the part
+		InstallVm(vm, selectedNodes.Get(i));
+		assigned.push_back(true);
 	}
-	splitVmContainer.Start(Simulator::Now());
 }
 
 void
@@ -772,28 +926,34 @@ VmScheduler::ConvertRatio()
 	}
 }
 
-bool
-VmScheduler::IsPortAssigned(uint32_t port)
+uint16_t
+VmScheduler::AllocatePort(Ptr<ComputationalNode> n)
 {
-	bool found = false;
-	for(std::vector<uint32_t>::iterator i = m_portAssigned.begin();
-			i != m_portAssigned.end(); i++)
+	uint32_t id = n->GetId();
+	if(id >= m_nodePorts.size())
 	{
-		NS_LOG_INFO("The ports" << *i);
-		if(*i == port)
-		{
-			found = true;
-			break;
-		}
+		// the storage servers listen on 3000, VMs request data from it
+		PortAllocator ports;
+		ports.Reserve(3000);
+		m_nodePorts.resize(id + 1, ports);
 	}
-	if(found)
+	uint16_t port = m_nodePorts[id].Allocate();
+	if(port == 0)
 	{
-		return true;
+		NS_FATAL_ERROR("No free listening port on node " << id);
 	}
-	else
+	return port;
+}
+
+void
+VmScheduler::VmReleased(Ptr<VirtualMachine> vm)
+{
+	Ptr<NetworkVm> nvm = DynamicCast<NetworkVm>(vm);
+	if(nvm != 0 && nvm->GetListeningPort() != 0)
 	{
-		return false;
+		m_nodePorts[vm->GetCompNode()->GetId()].Release(nvm->GetListeningPort());
 	}
+	m_vmManager->Retire(vm);
 }
 
 Storage
@@ -805,8 +965,7 @@ VmScheduler::GetStorageValue(Storage min, Storage max)
 	}
 	else
 	{
-		Ptr<UniformRandomVariable> uv = CreateObject<UniformRandomVariable>();
-		uint64_t newVal = uv->GetValue(min.GetStorage(), max.GetStorage());
+		uint64_t newVal = m_generationRv->GetValue(min.GetStorage(), max.GetStorage());
 		return Storage(newVal);
 	}
 }
@@ -819,8 +978,7 @@ VmScheduler::GetProcessingValue (ProcessingPower min, ProcessingPower max)
 	}
 	else
 	{
-		Ptr<UniformRandomVariable> uv = CreateObject<UniformRandomVariable>();
-		uint64_t newVal = uv->GetValue(min.GetProcessingPower(), max.GetProcessingPower());
+		uint64_t newVal = m_generationRv->GetValue(min.GetProcessingPower(), max.GetProcessingPower());
 		int metric;
 		if(min.IsFlops() && max.IsFlops())
 		{
@@ -848,8 +1006,7 @@ VmScheduler::GetApplicationSize(ApplicationSize min, ApplicationSize max)
 	}
 	else
 	{
-		Ptr<UniformRandomVariable> uv = CreateObject<UniformRandomVariable>();
-		uint64_t newVal = uv->GetValue(min.GetApplicationSize(), max.GetApplicationSize());
+		uint64_t newVal = m_generationRv->GetValue(min.GetApplicationSize(), max.GetApplicationSize());
 		std::string metric;
 		if(min.IsFlop() && max.IsFlop())
 		{
@@ -876,8 +1033,7 @@ VmScheduler::GetNumValue(uint32_t min, uint32_t max)
 	}
 	else
 	{
-		Ptr<UniformRandomVariable> uv = CreateObject<UniformRandomVariable>();
-		return uv->GetValue(min, max);
+		return m_generationRv->GetValue(min, max);
 	}
 }
 Time
@@ -889,10 +1045,9 @@ VmScheduler::GetTimeValue(Time min, Time max)
 	}
 	else
 	{
-		Ptr<UniformRandomVariable> uv = CreateObject<UniformRandomVariable>();
 		uint64_t mins = min.GetSeconds();
 		uint64_t maxs = max.GetSeconds();
-		double val = uv->GetValue(mins, maxs);
+		double val = m_generationRv->GetValue(mins, maxs);
 		return Time::From(val, Time::S);
 	}
 }
@@ -905,8 +1060,7 @@ VmScheduler::GetDoubleValue(double min, double max)
 	}
 	else
 	{
-		Ptr<UniformRandomVariable> uv = CreateObject<UniformRandomVariable>();
-		return uv->GetValue(min, max);
+		return m_generationRv->GetValue(min, max);
 	}
 }
 
@@ -919,8 +1073,7 @@ VmScheduler::GetDataRateValue(DataRate min, DataRate max)
 	}
 	else
 	{
-		Ptr<UniformRandomVariable> uv = CreateObject<UniformRandomVariable>();
-		uint64_t rate = uv->GetValue(min.GetBitRate(), max.GetBitRate());
+		uint64_t rate = m_generationRv->GetValue(min.GetBitRate(), max.GetBitRate());
 		return DataRate(rate);
 	}
 }
@@ -953,6 +1106,15 @@ VmScheduler::GetNotExecutedVmList()
 	return m_notExecutedVm;
 }
 
+void
+VmScheduler::DoDispose()
+{
+	NS_LOG_FUNCTION(this);
+	m_vmManager->Dispose();
+	m_vmManager = 0;
+	Object::DoDispose();
+}
+
 VmScheduler::~VmScheduler()
 {
 }
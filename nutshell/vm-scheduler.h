@@ -26,6 +26,7 @@
 
 #include <vector>
 #include <map>
+#include <algorithm>
 
 #include "ns3/object.h"
 #include "ns3/callback.h"
@@ -33,6 +34,8 @@
 #include "ns3/ipv4-interface-container.h"
 #include "ns3/node-container.h"
 #include "ns3/data-rate.h"
+#include "ns3/nstime.h"
+#include "ns3/random-variable-stream.h"
 
 
 #include "processing-power-util.h"
@@ -42,6 +45,11 @@
 
 #include "virtual-machine-helper.h"
 #include "computational-node-container.h"
+#include "node-capacity-index.h"
+#include "port-allocator.h"
+#include "vm-lifecycle-manager.h"
+#include "vm-workload-reader.h"
+#include "flow-network.h"
 
 namespace ns3 {
 
@@ -91,6 +99,16 @@ public:
 	void SetConfiguration(DatacenterConfig config);
 	void SetNodes(ComputationalNodeContainer c);
 	void SetInterfaces(Ipv4InterfaceContainer iface);
+	/**
+	 * \brief Set the share of VMs dispatched by this scheduler
+	 *
+	 * In a partitioned simulation every logical process generates the same
+	 * VMs and dispatches the arrivals whose sequence number modulo count is index.
+	 *
+	 * \param index The partition of this scheduler
+	 * \param count The number of partitions
+	 */
+	void SetPartition(uint32_t index, uint32_t count);
 	/**
 	 * \brief Begins the scheduling process
 	 */
@@ -105,6 +123,10 @@ public:
 	std::vector<VmProperties> GetNotExecutedVmList();
 
 protected:
+	/**
+	 * \brief Disposes the VMs still running
+	 */
+	virtual void DoDispose(void);
 
 	DatacenterConfig 			m_config;
 	std::vector<VmProperties> 	m_vmList;
@@ -117,27 +139,132 @@ protected:
 	std::vector<uint32_t>		m_ratio;
 	uint32_t					m_ratioSum;
 
-	std::vector<uint32_t> m_portAssigned;
+	std::vector<PortAllocator>	m_nodePorts; //!< Listening ports of each node, indexed by node ID
+	TypeId m_socketTid; //!< Socket factory TypeId of the last looked up protocol
+	std::string m_socketTidName; //!< The name of m_socketTid
+
+	Ptr<NodeCapacityIndex>		m_capacityIndex; //!< First fit index over the computational nodes
+	Ptr<VmLifecycleManager>		m_vmManager; //!< Holds the running VMs, disposes them once stopped
+	std::vector<bool>			m_selectedNodes; //!< Nodes holding a part of the split being placed
+
+	uint32_t					m_vmListIndex; //!< The next VM to schedule from a created list
+	uint32_t					m_vmGenerated; //!< The number of VMs generated on arrival
+	uint32_t					m_serverDataSrcLeft; //!< The number of VMs still to fetch data from server
+	Time						m_lastArrival; //!< The arrival time of last generated VM
+	Time						m_schedulingStart; //!< The time when scheduling began
+	VmProperties				m_nextVm; //!< The next VM, ahead of arrivals being dispatched
+	bool						m_hasNextVm; //!< true if m_nextVm holds a VM
+	uint32_t					m_partition; //!< The partition of VMs dispatched
+	uint32_t					m_partitions; //!< The number of partitions
+	uint32_t					m_arrivalCount; //!< The number of VMs arrived so far
+	std::vector<VmProperties>	m_arrivals; //!< VMs arriving at the scheduled time
+	Ptr<UniformRandomVariable>	m_arrivalRv; //!< The random variable for arrivals
+	Ptr<UniformRandomVariable>	m_generationRv; //!< The random variable for VM properties
+	Ptr<UniformRandomVariable>	m_dispatchRv; //!< The random variable for storage servers of dispatched VMs
+	Ptr<VmWorkloadReader>		m_workload; //!< The workload trace reader, if VMs are replayed
+	Ptr<FlowNetwork>			m_flowNetwork; //!< The flow network, if data is transferred as flows
+
+	static const int64_t ARRIVAL_STREAM = 1; //!< The stream number of m_arrivalRv
+	static const int64_t GENERATION_STREAM = 2; //!< The stream number of m_generationRv
+	static const int64_t DISPATCH_STREAM = 3; //!< The stream number of m_dispatchRv
+
+	/**
+	 * \brief Creates the random variables for VM properties and dispatching, on their fixed streams
+	 */
+	void CreateRandomStreams();
 
 	/**
 	 * \brief Creates a list of Virtual Machines, according to the configuration
+	 *
+	 * The scheduler does not require the list, VMs are generated on
+	 * arrival by GetNextVm. A list created before scheduling begins is
+	 * sorted and dispatched instead of the generated VMs.
 	 */
 	virtual void CreateVmList();
+	/**
+	 * \brief Creates a single Virtual Machine, according to the configuration
+	 *
+	 * All properties except the arrival time are set.
+	 *
+	 * \param vm The configuration of VM to fill
+	 */
+	virtual void CreateVm(VmProperties & vm);
+	/**
+	 * \brief Gets the next Virtual Machine in the order of arrival
+	 *
+	 * \param vm The configuration of next VM
+	 * \return false if there are no more VMs to schedule
+	 */
+	virtual bool GetNextVm(VmProperties & vm);
+	/**
+	 * \brief Draws the next arrival time in increasing order
+	 *
+	 * The arrival times are the sorted uniform samples between the
+	 * configured minimum and maximum, drawn one at a time.
+	 *
+	 * \return The arrival time of next VM
+	 */
+	Time GetNextArrivalTime();
+	/**
+	 * \brief Sets the data source of a VM while VMs are streamed
+	 *
+	 * Selects exactly the configured number of VMs, with equal
+	 * probability, to fetch data from the storage servers.
+	 *
+	 * \param vm The configuration of VM
+	 */
+	void SelectDataSource(VmProperties & vm);
+	/**
+	 * \brief Collects the VMs with next arrival time and schedules them
+	 */
+	void ScheduleNextArrival();
+	/**
+	 * \brief Dispatches the VMs arrived at current time
+	 */
+	void DispatchArrivals();
 	/**
 	 * \brief Creates storage servers from within the architecture
 	 */
 	virtual void CreateStorageServers();
+	/**
+	 * \brief Builds the capacity index over nodes available for VMs
+	 */
+	void BuildCapacityIndex();
+	/**
+	 * \brief Sorts the list of Virtual Machines
+	 *
+	 * The list is stable sorted using CompareVm, schedulers changing the
+	 * order of VMs override CompareVm rather than this method.
+	 */
 	virtual void SortVmList();
+	/**
+	 * \brief Defines the order of Virtual Machines in the list
+	 *
+	 * The comparison must be a strict weak ordering, VMs equal
+	 * in order keep their order of creation.
+	 *
+	 * \param a The configuration of first VM
+	 * \param b The configuration of second VM
+	 * \return true if a is to be scheduled before b
+	 */
+	virtual bool CompareVm(const VmProperties & a, const VmProperties & b) const;
 
 	/**
 	 * \brief Schedules a Virtual Machine
 	 *
+	 * Called for every VM arriving to this scheduler, the default
+	 * dispatches the VM at its arrival time, relative to the beginning
+	 * of scheduling.
+	 *
 	 * \param vm The configuration of VM to create
 	 */
 	virtual void ScheduleVm(VmProperties & vm);
 	/**
 	 * \brief Dispatches a VM to computational node
 	 *
+	 * The resources are reserved on the first node that fits, then the
+	 * VM is created on that node and takes over the reservation.
+	 *
 	 * \param vm The configuration of VM to dispatch
 	 */
 	virtual void DispatchVmOnNode(VmProperties & vm);
@@ -156,6 +283,17 @@ protected:
 	virtual void SplitVm(VmProperties & vm, std::vector<VmProperties> & spvec);
 	/**
 	 * \brief Finds nodes for the splitted VMs
+	 *
+	 * Each part goes to the first node of capacity index that fits it and
+	 * holds no other part. The parts are placed all or nothing: the
+	 * resources of each part are reserved on its node as it is placed,
+	 * and released again if any later part finds no node, in which case
+	 * no node is selected. The VMs started on the nodes take over the
+	 * reservations.
+	 *
+	 * \param vmSplitted The parts of VM
+	 * \param selectedNodes The nodes selected, one per part, or none
+	 * \param selectedNodeIface The IPs of selected nodes
 	 */
 	virtual void FindNodeIndicies(std::vector<VmProperties> & vmSplitted,
 			ComputationalNodeContainer & selectedNodes, Ipv4InterfaceContainer & selectedNodeIface);
@@ -171,12 +309,47 @@ protected:
 			ComputationalNodeContainer & selectedNodes, Ipv4InterfaceContainer & selectedNodeIface,
 			std::vector<bool> & assigned);
 
-	VirtualMachineHelper InitializeVm(VmProperties v, VirtualMachineHelper::VmType_e type);
+	/**
+	 * \brief Creates a VM of given type and sets its properties directly
+	 * \param v The properties of VM
+	 * \param type The type of VM to create
+	 * \return The VM, not installed on any node yet
+	 */
+	Ptr<VirtualMachine> CreateVm(const VmProperties & v, VirtualMachineHelper::VmType_e type);
+	/**
+	 * \brief Looks up the socket factory of a protocol, caching the last one
+	 * \param name The name of socket factory TypeId
+	 * \return The TypeId of socket factory
+	 */
+	TypeId GetSocketTypeId(const std::string & name);
+	/**
+	 * \brief Installs the VM on the node, it takes over the node resources
+	 * reserved for it and starts right away
+	 *
+	 * The VM is attached to the node through the lifecycle manager, instead
+	 * of the application list of node, and is disposed once it stops.
+	 * \param vm The VM to install
+	 * \param n The node, resources must be reserved already
+	 */
+	void InstallVm(Ptr<VirtualMachine> vm, Ptr<ComputationalNode> n);
 	void AddToExecutedVmList(VmProperties p, uint32_t nodeId);
 	void AddToSplitExecutedVmList(VmProperties actualVm, std::vector<VmProperties> splitVm, ComputationalNodeContainer nc);
 	void AddToNotExecutedVmList(VmProperties p);
 	void ConvertRatio();
-	bool IsPortAssigned(uint32_t port);
+	/**
+	 * \brief Allocates a listening port for a VM on a node
+	 *
+	 * \param n The node of VM
+	 * \return The port
+	 */
+	uint16_t AllocatePort(Ptr<ComputationalNode> n);
+	/**
+	 * \brief Reclaims the listening port of a VM that released its resources
+	 * and retires the VM
+	 *
+	 * \param vm The VM
+	 */
+	void VmReleased(Ptr<VirtualMachine> vm);
 
 	Storage GetStorageValue(Storage min, Storage max);
 	ProcessingPower GetProcessingValue (ProcessingPower min, ProcessingPower max);
@@ -191,6 +364,16 @@ protected:
 
 
 private:
+	/**
+	 * \brief Adapts CompareVm of a scheduler to the standard sort algorithms
+	 */
+	class VmComparator {
+	public:
+		VmComparator(const VmScheduler * scheduler);
+		bool operator() (const VmProperties & a, const VmProperties & b) const;
+	private:
+		const VmScheduler * m_scheduler;
+	};
 
 	std::vector<ExecutedVm_s> m_executedVm;
 	std::vector<SplitExecutedVm_s> m_splitExecutedVm;
@@ -0,0 +1,481 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *
+ * vm-workload-reader.cc
+ *
+ *  Created on: Mar 6, 2017
+ *      Author: ubaid
+ *       Email: u.ur.rahman@gmail.com
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "ns3/log.h"
+#include "ns3/nstime.h"
+#include "ns3/data-rate.h"
+
+#include "processing-power-util.h"
+#include "storage-util.h"
+#include "application-size-util.h"
+#include "vm-scheduler.h"
+
+#include "vm-workload-reader.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("VmWorkloadReader");
+
+NS_OBJECT_ENSURE_REGISTERED (VmWorkloadReader);
+
+static const char WORKLOAD_MAGIC[4] = {'N', 'S', 'W', 'L'};
+static const uint32_t WORKLOAD_VERSION = 1;
+
+const uint8_t VmWorkloadReader::FLAG_REQUIRE_DATA;
+const uint8_t VmWorkloadReader::FLAG_STORAGE_SERVER;
+const uint32_t VmWorkloadReader::CSV_COLUMNS;
+const size_t VmWorkloadReader::HEADER_SIZE;
+
+TypeId
+VmWorkloadReader::GetTypeId ()
+{
+	static TypeId tid = TypeId("ns3::VmWorkloadReader")
+		.SetParent (Object::GetTypeId())
+		.AddConstructor<VmWorkloadReader> ()
+		;
+	return tid;
+}
+
+VmWorkloadReader::VmWorkloadReader()
+	: m_fd (-1),
+	  m_data (0),
+	  m_size (0),
+	  m_binary (false),
+	  m_pos (0),
+	  m_rows (0),
+	  m_row (0)
+{
+	NS_LOG_FUNCTION(this);
+}
+
+VmWorkloadReader::~VmWorkloadReader()
+{
+	NS_LOG_FUNCTION(this);
+	Close();
+}
+
+void
+VmWorkloadReader::DoDispose()
+{
+	NS_LOG_FUNCTION(this);
+	Close();
+	Object::DoDispose();
+}
+
+void
+VmWorkloadReader::Open(std::string fileName)
+{
+	NS_LOG_FUNCTION(this << fileName);
+	Close();
+
+	m_fileName = fileName;
+	m_fd = open(fileName.c_str(), O_RDONLY);
+	if(m_fd < 0)
+	{
+		NS_FATAL_ERROR("Unable to open workload trace " << fileName);
+	}
+	struct stat st;
+	if(fstat(m_fd, &st) != 0)
+	{
+		NS_FATAL_ERROR("Unable to read size of workload trace " << fileName);
+	}
+	m_size = st.st_size;
+	if(m_size > 0)
+	{
+		void * map = mmap(0, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+		if(map == MAP_FAILED)
+		{
+			NS_FATAL_ERROR("Unable to map workload trace " << fileName);
+		}
+		// rows are read front to back, let the kernel read ahead
+		madvise(map, m_size, MADV_SEQUENTIAL);
+		m_data = static_cast<const char *>(map);
+	}
+
+	m_binary = (m_size >= HEADER_SIZE && memcmp(m_data, WORKLOAD_MAGIC, 4) == 0);
+	if(m_binary)
+	{
+		uint32_t version;
+		memcpy(&version, m_data + 4, sizeof(version));
+		memcpy(&m_rows, m_data + 8, sizeof(m_rows));
+		if(version != WORKLOAD_VERSION)
+		{
+			NS_FATAL_ERROR("Unsupported workload trace version " << version << " in " << fileName);
+		}
+		for(uint32_t c = 0; c < COL_COUNT; c++)
+		{
+			m_columns[c] = (c == 0) ? HEADER_SIZE : m_columns[c - 1] + m_rows * ColumnWidth(c - 1);
+		}
+		if(m_columns[COL_COUNT - 1] + m_rows * ColumnWidth(COL_COUNT - 1) > m_size)
+		{
+			NS_FATAL_ERROR("Workload trace " << fileName << " is truncated");
+		}
+	}
+	Rewind();
+}
+
+void
+VmWorkloadReader::Close()
+{
+	if(m_data != 0)
+	{
+		munmap(const_cast<char *>(m_data), m_size);
+		m_data = 0;
+	}
+	if(m_fd >= 0)
+	{
+		close(m_fd);
+		m_fd = -1;
+	}
+	m_size = 0;
+	m_rows = 0;
+	m_row = 0;
+	m_pos = 0;
+}
+
+void
+VmWorkloadReader::Rewind()
+{
+	m_pos = 0;
+	m_row = 0;
+}
+
+bool
+VmWorkloadReader::ReadNext(VmProperties & vm)
+{
+	if(m_data == 0)
+	{
+		return false;
+	}
+	bool res = m_binary ? ReadNextBinary(vm) : ReadNextCsv(vm);
+	if(res)
+	{
+		m_row++;
+	}
+	return res;
+}
+
+bool
+VmWorkloadReader::IsBinary() const
+{
+	return m_binary;
+}
+
+uint64_t
+VmWorkloadReader::GetRowsRead() const
+{
+	return m_row;
+}
+
+uint64_t
+VmWorkloadReader::ConvertToBinary(std::string csvFile, std::string binaryFile)
+{
+	Ptr<VmWorkloadReader> csv = CreateObject<VmWorkloadReader>();
+	csv->Open(csvFile);
+	if(csv->IsBinary())
+	{
+		NS_FATAL_ERROR("Workload trace " << csvFile << " is already binary");
+	}
+
+	// first pass counts the rows, to lay out the columns
+	VmProperties vm;
+	uint64_t rows = 0;
+	while(csv->ReadNext(vm))
+	{
+		rows++;
+	}
+
+	size_t columns[COL_COUNT];
+	for(uint32_t c = 0; c < COL_COUNT; c++)
+	{
+		columns[c] = (c == 0) ? HEADER_SIZE : columns[c - 1] + rows * ColumnWidth(c - 1);
+	}
+	size_t size = columns[COL_COUNT - 1] + rows * ColumnWidth(COL_COUNT - 1);
+
+	int fd = open(binaryFile.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if(fd < 0 || ftruncate(fd, size) != 0)
+	{
+		NS_FATAL_ERROR("Unable to create workload trace " << binaryFile);
+	}
+	void * map = mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if(map == MAP_FAILED)
+	{
+		NS_FATAL_ERROR("Unable to map workload trace " << binaryFile);
+	}
+	char * out = static_cast<char *>(map);
+
+	memcpy(out, WORKLOAD_MAGIC, 4);
+	memcpy(out + 4, &WORKLOAD_VERSION, sizeof(WORKLOAD_VERSION));
+	memcpy(out + 8, &rows, sizeof(rows));
+
+	// second pass writes each row into its column slots
+	csv->Rewind();
+	for(uint64_t r = 0; r < rows && csv->ReadNext(vm); r++)
+	{
+		int64_t arrival = vm.arrivalTime.GetNanoSeconds();
+		uint64_t processing = vm.processing.GetProcessingPower();
+		uint8_t pMetric = vm.processing.IsMips() ? 1 : 0;
+		uint64_t primary = vm.primary.GetStorage();
+		uint64_t secondary = vm.secondary.GetStorage();
+		uint64_t appSize = vm.appSize.GetApplicationSize();
+		uint8_t aMetric = vm.appSize.IsInstruction() ? 1 : 0;
+		uint8_t flags = 0;
+		if(vm.requrieData)
+		{
+			flags |= FLAG_REQUIRE_DATA;
+			if(vm.dataSource == STORAGE_SERVER)
+			{
+				flags |= FLAG_STORAGE_SERVER;
+			}
+		}
+		uint64_t dataAmount = vm.dataAmount.GetStorage();
+		uint64_t hddRwRate = vm.hddRwRate.GetStorage();
+		uint64_t memRwRate = vm.memRwRate.GetStorage();
+		uint32_t accesses = vm.numOfProcAccesses;
+		double memPdf = vm.memPDF;
+		int64_t memAccess = vm.memAccessTime.GetNanoSeconds();
+		int64_t hddAccess = vm.hddAccessTime.GetNanoSeconds();
+		uint64_t rate = vm.transRate.GetBitRate();
+
+		memcpy(out + columns[COL_ARRIVAL] + r * 8, &arrival, 8);
+		memcpy(out + columns[COL_PROCESSING] + r * 8, &processing, 8);
+		memcpy(out + columns[COL_PROCESSING_METRIC] + r, &pMetric, 1);
+		memcpy(out + columns[COL_PRIMARY] + r * 8, &primary, 8);
+		memcpy(out + columns[COL_SECONDARY] + r * 8, &secondary, 8);
+		memcpy(out + columns[COL_APP_SIZE] + r * 8, &appSize, 8);
+		memcpy(out + columns[COL_APP_METRIC] + r, &aMetric, 1);
+		memcpy(out + columns[COL_FLAGS] + r, &flags, 1);
+		memcpy(out + columns[COL_DATA_AMOUNT] + r * 8, &dataAmount, 8);
+		memcpy(out + columns[COL_HDD_RW_RATE] + r * 8, &hddRwRate, 8);
+		memcpy(out + columns[COL_MEM_RW_RATE] + r * 8, &memRwRate, 8);
+		memcpy(out + columns[COL_NUM_ACCESSES] + r * 4, &accesses, 4);
+		memcpy(out + columns[COL_MEM_PDF] + r * 8, &memPdf, 8);
+		memcpy(out + columns[COL_MEM_ACCESS_TIME] + r * 8, &memAccess, 8);
+		memcpy(out + columns[COL_HDD_ACCESS_TIME] + r * 8, &hddAccess, 8);
+		memcpy(out + columns[COL_TRANS_RATE] + r * 8, &rate, 8);
+	}
+
+	munmap(map, size);
+	close(fd);
+	csv->Dispose();
+	return rows;
+}
+
+/*
+ * ------------- private methods -------------
+ */
+
+size_t
+VmWorkloadReader::ColumnWidth(uint32_t column)
+{
+	switch(column)
+	{
+	case COL_PROCESSING_METRIC:
+	case COL_APP_METRIC:
+	case COL_FLAGS:
+		return 1;
+	case COL_NUM_ACCESSES:
+		return 4;
+	default:
+		return 8;
+	}
+}
+
+size_t
+VmWorkloadReader::ColumnOffset(uint32_t column, uint64_t row) const
+{
+	return m_columns[column] + row * ColumnWidth(column);
+}
+
+bool
+VmWorkloadReader::ReadNextBinary(VmProperties & vm)
+{
+	if(m_row >= m_rows)
+	{
+		return false;
+	}
+	int64_t arrival, memAccess, hddAccess;
+	uint64_t processing, primary, secondary, appSize, dataAmount, hddRwRate, memRwRate, rate;
+	uint8_t pMetric, aMetric, flags;
+	uint32_t accesses;
+	double memPdf;
+
+	memcpy(&arrival, m_data + ColumnOffset(COL_ARRIVAL, m_row), 8);
+	memcpy(&processing, m_data + ColumnOffset(COL_PROCESSING, m_row), 8);
+	memcpy(&pMetric, m_data + ColumnOffset(COL_PROCESSING_METRIC, m_row), 1);
+	memcpy(&primary, m_data + ColumnOffset(COL_PRIMARY, m_row), 8);
+	memcpy(&secondary, m_data + ColumnOffset(COL_SECONDARY, m_row), 8);
+	memcpy(&appSize, m_data + ColumnOffset(COL_APP_SIZE, m_row), 8);
+	memcpy(&aMetric, m_data + ColumnOffset(COL_APP_METRIC, m_row), 1);
+	memcpy(&flags, m_data + ColumnOffset(COL_FLAGS, m_row), 1);
+	memcpy(&dataAmount, m_data + ColumnOffset(COL_DATA_AMOUNT, m_row), 8);
+	memcpy(&hddRwRate, m_data + ColumnOffset(COL_HDD_RW_RATE, m_row), 8);
+	memcpy(&memRwRate, m_data + ColumnOffset(COL_MEM_RW_RATE, m_row), 8);
+	memcpy(&accesses, m_data + ColumnOffset(COL_NUM_ACCESSES, m_row), 4);
+	memcpy(&memPdf, m_data + ColumnOffset(COL_MEM_PDF, m_row), 8);
+	memcpy(&memAccess, m_data + ColumnOffset(COL_MEM_ACCESS_TIME, m_row), 8);
+	memcpy(&hddAccess, m_data + ColumnOffset(COL_HDD_ACCESS_TIME, m_row), 8);
+	memcpy(&rate, m_data + ColumnOffset(COL_TRANS_RATE, m_row), 8);
+
+	vm.arrivalTime = NanoSeconds(arrival);
+	vm.processing = ProcessingPower(processing, pMetric ? ProcessingPower::POWER_MIPS : ProcessingPower::POWER_FLOPS);
+	vm.primary = Storage(primary);
+	vm.secondary = Storage(secondary);
+	vm.appSize = ApplicationSize(appSize, aMetric ? true : false, aMetric ? false : true);
+	vm.requrieData = (flags & FLAG_REQUIRE_DATA) != 0;
+	vm.dataSource = (flags & FLAG_STORAGE_SERVER) ? STORAGE_SERVER : LOCAL_DISK;
+	vm.dataAmount = Storage(dataAmount);
+	vm.hddRwRate = Storage(hddRwRate);
+	vm.memRwRate = Storage(memRwRate);
+	vm.numOfProcAccesses = accesses;
+	vm.memPDF = memPdf;
+	vm.memAccessTime = NanoSeconds(memAccess);
+	vm.hddAccessTime = NanoSeconds(hddAccess);
+	vm.transRate = DataRate(rate);
+	return true;
+}
+
+bool
+VmWorkloadReader::ReadNextCsv(VmProperties & vm)
+{
+	while(m_pos < m_size)
+	{
+		const char * line = m_data + m_pos;
+		const char * end = static_cast<const char *>(memchr(line, '\n', m_size - m_pos));
+		if(end == 0)
+		{
+			end = m_data + m_size;
+		}
+		m_pos = (end - m_data) + 1;
+
+		// skip blank lines, comments and the header
+		const char * p = line;
+		while(p < end && isspace(*p))
+		{
+			p++;
+		}
+		if(p == end || *p == '#' || isalpha(*p))
+		{
+			continue;
+		}
+
+		Field_s fields[CSV_COLUMNS];
+		uint32_t n = 0;
+		const char * begin = line;
+		for(const char * c = line; c <= end && n < CSV_COLUMNS; c++)
+		{
+			if(c == end || *c == ',')
+			{
+				const char * b = begin;
+				const char * e = c;
+				while(b < e && isspace(*b))
+				{
+					b++;
+				}
+				while(e > b && isspace(*(e - 1)))
+				{
+					e--;
+				}
+				fields[n].begin = b;
+				fields[n].length = e - b;
+				n++;
+				begin = c + 1;
+			}
+		}
+		if(n < CSV_COLUMNS)
+		{
+			NS_FATAL_ERROR("Workload trace " << m_fileName << " row " << (m_row + 1)
+					<< " has " << n << " columns, " << CSV_COLUMNS << " expected");
+		}
+
+		vm.arrivalTime = Seconds(ParseDouble(fields[0]));
+		vm.processing = ProcessingPower(ToString(fields[1]));
+		vm.primary = Storage(ToString(fields[2]));
+		vm.secondary = Storage(ToString(fields[3]));
+		vm.appSize = ApplicationSize(ToString(fields[4]));
+		vm.requrieData = ParseUint(fields[5]) != 0;
+		vm.dataSource = (fields[6].length > 0 && tolower(fields[6].begin[0]) == 's') ? STORAGE_SERVER : LOCAL_DISK;
+		if(vm.requrieData)
+		{
+			vm.dataAmount = Storage(ToString(fields[7]));
+			vm.hddRwRate = Storage(ToString(fields[8]));
+			vm.memRwRate = Storage(ToString(fields[9]));
+			vm.numOfProcAccesses = ParseUint(fields[10]);
+			vm.memPDF = ParseDouble(fields[11]);
+			vm.memAccessTime = Seconds(ParseDouble(fields[12]));
+			vm.hddAccessTime = Seconds(ParseDouble(fields[13]));
+		}
+		else
+		{
+			vm.dataSource = LOCAL_DISK;
+			vm.dataAmount = Storage((uint64_t) 0);
+			vm.hddRwRate = Storage((uint64_t) 0);
+			vm.memRwRate = Storage((uint64_t) 0);
+			vm.numOfProcAccesses = 0;
+			vm.memPDF = 0;
+			vm.memAccessTime = Seconds(0);
+			vm.hddAccessTime = Seconds(0);
+		}
+		vm.transRate = DataRate(ToString(fields[14]));
+		return true;
+	}
+	return false;
+}
+
+double
+VmWorkloadReader::ParseDouble(const Field_s & f)
+{
+	char buf[64];
+	size_t len = f.length < sizeof(buf) - 1 ? f.length : sizeof(buf) - 1;
+	memcpy(buf, f.begin, len);
+	buf[len] = '\0';
+	return strtod(buf, 0);
+}
+
+uint64_t
+VmWorkloadReader::ParseUint(const Field_s & f)
+{
+	uint64_t v = 0;
+	for(size_t i = 0; i < f.length && isdigit(f.begin[i]); i++)
+	{
+		v = v * 10 + (f.begin[i] - '0');
+	}
+	return v;
+}
+
+std::string
+VmWorkloadReader::ToString(const Field_s & f)
+{
+	return std::string(f.begin, f.length);
+}
+
+} /* namespace ns3 */
@@ -0,0 +1,188 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ *
+ * vm-workload-reader.h
+ *
+ *  Created on: Mar 6, 2017
+ *      Author: ubaid
+ *       Email: u.ur.rahman@gmail.com
+ */
+
+#ifndef NUTSHELL_VM_WORKLOAD_READER_H
+#define NUTSHELL_VM_WORKLOAD_READER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+#include "ns3/object.h"
+
+namespace ns3 {
+
+struct VmProperties;
+
+/**
+ * \brief Reads Virtual Machines from a workload trace
+ *
+ * The trace file is memory mapped and VMs are read one at a time, in
+ * the order of the file, so a trace of any length is replayed without
+ * loading it into memory. The rows must be sorted by arrival time.
+ *
+ * Two formats are supported, selected by the content of file:
+ *
+ * CSV, one VM per line, lines starting with '#' and a header line are
+ * skipped. The columns are:
+ *
+ *   arrival (s), processing, primary storage, secondary storage,
+ *   application size, require data (0/1), data source (server/local),
+ *   data amount, HDD r/w rate, memory r/w rate, number of accesses,
+ *   memory percentage for data, memory access time (s), HDD access time (s),
+ *   transmission rate
+ *
+ * Resources use the same strings as the configuration e.g. "200TFLOPS",
+ * "10GB", "5000TFLOP" and "100Mbps". The data columns may be left empty
+ * for VMs which do not require data.
+ *
+ * Binary, a columnar form of the same trace, in host byte order:
+ *
+ *   header: magic "NSWL", version (uint32), number of rows (uint64)
+ *   followed by one array of values for each column in the order of Column_e
+ *
+ * ConvertToBinary writes the binary form of a CSV trace.
+ */
+class VmWorkloadReader : public Object {
+public:
+	/**
+	* \brief Get the type ID.
+	* \return the object TypeId
+	*/
+	static TypeId GetTypeId (void);
+	VmWorkloadReader();
+	virtual ~VmWorkloadReader();
+
+	/**
+	 * \brief Columns of the binary workload format
+	 */
+	enum Column_e {
+		COL_ARRIVAL, //!< int64, nanoseconds
+		COL_PROCESSING, //!< uint64
+		COL_PROCESSING_METRIC, //!< uint8, 0 FLOPS, 1 MIPS
+		COL_PRIMARY, //!< uint64, bytes
+		COL_SECONDARY, //!< uint64, bytes
+		COL_APP_SIZE, //!< uint64
+		COL_APP_METRIC, //!< uint8, 0 FLOP, 1 instruction count
+		COL_FLAGS, //!< uint8, FLAG_REQUIRE_DATA | FLAG_STORAGE_SERVER
+		COL_DATA_AMOUNT, //!< uint64, bytes
+		COL_HDD_RW_RATE, //!< uint64, bytes
+		COL_MEM_RW_RATE, //!< uint64, bytes
+		COL_NUM_ACCESSES, //!< uint32
+		COL_MEM_PDF, //!< double
+		COL_MEM_ACCESS_TIME, //!< int64, nanoseconds
+		COL_HDD_ACCESS_TIME, //!< int64, nanoseconds
+		COL_TRANS_RATE, //!< uint64, bits per second
+		COL_COUNT
+	};
+
+	static const uint8_t FLAG_REQUIRE_DATA = 0x01; //!< VM requires data
+	static const uint8_t FLAG_STORAGE_SERVER = 0x02; //!< VM fetches data from storage server
+
+	/**
+	 * \brief Opens a workload trace
+	 * \param fileName The path of trace file
+	 */
+	void Open(std::string fileName);
+	/**
+	 * \brief Closes the trace file
+	 */
+	void Close();
+	/**
+	 * \brief Starts reading from the first VM again
+	 */
+	void Rewind();
+	/**
+	 * \brief Reads the next VM of trace
+	 *
+	 * The MTU and protocol of VM are not part of trace and are left unchanged.
+	 *
+	 * \param vm The configuration of VM to fill
+	 * \return false if the end of trace is reached
+	 */
+	bool ReadNext(VmProperties & vm);
+	/**
+	 * \brief Checks if the open trace is in binary format
+	 * \return true for binary, false for CSV
+	 */
+	bool IsBinary() const;
+	/**
+	 * \brief Get the number of VMs read so far
+	 * \return The number of VMs
+	 */
+	uint64_t GetRowsRead() const;
+
+	/**
+	 * \brief Converts a CSV trace to the binary workload format
+	 * \param csvFile The path of CSV trace
+	 * \param binaryFile The path of binary trace to create
+	 * \return The number of VMs written
+	 */
+	static uint64_t ConvertToBinary(std::string csvFile, std::string binaryFile);
+
+protected:
+	virtual void DoDispose(void);
+
+private:
+	/**
+	 * \brief A field of CSV line, not null terminated
+	 */
+	struct Field_s {
+		const char * begin;
+		size_t length;
+	};
+
+	static const uint32_t CSV_COLUMNS = 15; //!< The number of columns in CSV trace
+	static const size_t HEADER_SIZE = 16; //!< The size of binary header
+
+	/**
+	 * \brief Get the size of a binary column value
+	 */
+	static size_t ColumnWidth(uint32_t column);
+	/**
+	 * \brief Get the offset of value of a row in a binary column
+	 */
+	size_t ColumnOffset(uint32_t column, uint64_t row) const;
+
+	bool ReadNextCsv(VmProperties & vm);
+	bool ReadNextBinary(VmProperties & vm);
+
+	static double ParseDouble(const Field_s & f);
+	static uint64_t ParseUint(const Field_s & f);
+	static std::string ToString(const Field_s & f);
+
+	std::string m_fileName; //!< The path of trace file
+	int m_fd; //!< The descriptor of trace file
+	const char * m_data; //!< The mapped trace
+	size_t m_size; //!< The size of mapped trace
+	bool m_binary; //!< true if the trace is binary
+	size_t m_pos; //!< The read position of CSV trace
+	uint64_t m_rows; //!< The number of rows of binary trace
+	uint64_t m_row; //!< The number of rows read
+	size_t m_columns[COL_COUNT]; //!< The start of each binary column
+};
+
+} /* namespace ns3 */
+
+#endif /* NUTSHELL_VM_WORKLOAD_READER_H */